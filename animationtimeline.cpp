@@ -0,0 +1,265 @@
+#include "animationtimeline.h"
+#include "stylemanager.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <algorithm>
+#include <cmath>
+
+double AnimationTimeline::speedFactor = 1.0;
+
+AnimationTimeline::AnimationTimeline(QObject *parent)
+    : QObject(parent)
+    , timer(new QTimer(this))
+{
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &AnimationTimeline::advance);
+}
+
+int AnimationTimeline::scaled(int ms)
+{
+    if (isInstant()) return 0;
+    return static_cast<int>(std::lround(ms / speedFactor));
+}
+
+void AnimationTimeline::play(std::vector<AnimationFrame> list)
+{
+    // The previous operation must land before the next one starts
+    if (isRunning()) finish();
+
+    frames = std::move(list);
+    current = -1;
+    reached = -1;
+    floor = 0;
+    paused = false;  // Also clears a pause clicked while idle
+    if (frames.empty()) {
+        emit frameChanged(current, 0);
+        return;
+    }
+
+    if (isInstant()) {
+        finish();
+        return;
+    }
+    advance();
+}
+
+void AnimationTimeline::extend(std::vector<AnimationFrame> more)
+{
+    if (!isRunning()) {
+        play(std::move(more));
+        return;
+    }
+    for (AnimationFrame &frame : more) frames.push_back(std::move(frame));
+    emit frameChanged(current, frameCount());
+}
+
+void AnimationTimeline::finish()
+{
+    timer->stop();
+    if (frames.empty()) return;
+
+    // Narration and engine changes all run; only the last frame is shown.
+    // Reaching a frame may extend the list, so go until nothing is added.
+    while (reached < frameCount() - 1) reachUpTo(frameCount() - 1);
+    const int last = frameCount() - 1;
+    current = last;
+    if (frames[last].show) frames[last].show();
+    complete();
+}
+
+void AnimationTimeline::pause()
+{
+    paused = true;
+    timer->stop();
+    emit frameChanged(current, frameCount());
+}
+
+void AnimationTimeline::resume()
+{
+    paused = false;
+    if (isRunning()) scheduleNext();
+    emit frameChanged(current, frameCount());
+}
+
+void AnimationTimeline::stepForward()
+{
+    if (!isRunning()) return;
+    timer->stop();
+    advance();
+}
+
+void AnimationTimeline::stepBack()
+{
+    seek(current - 1);
+}
+
+void AnimationTimeline::seek(int index)
+{
+    if (!isRunning()) return;
+    index = std::max(floor, std::min(index, frameCount() - 1));
+
+    timer->stop();
+    reachUpTo(index);
+    current = index;
+    if (frames[current].show) frames[current].show();
+    emit frameChanged(current, frameCount());
+    scheduleNext();
+}
+
+void AnimationTimeline::advance()
+{
+    if (current + 1 >= frameCount()) {
+        complete();
+        return;
+    }
+
+    ++current;
+    reachUpTo(current);
+    if (frames[current].show) frames[current].show();
+    emit frameChanged(current, frameCount());
+    scheduleNext();
+}
+
+void AnimationTimeline::reachUpTo(int index)
+{
+    while (reached < index) {
+        ++reached;
+        if (frames[reached].changesEngine) floor = reached;
+        // A copy: reach() may extend the list and move the frames
+        const std::function<void()> reach = frames[reached].reach;
+        if (reach) reach();
+    }
+}
+
+void AnimationTimeline::scheduleNext()
+{
+    if (paused || !isRunning()) return;
+    timer->start(scaled(frames[current].durationMs));
+}
+
+void AnimationTimeline::complete()
+{
+    timer->stop();
+    frames.clear();
+    current = -1;
+    reached = -1;
+    floor = 0;
+    paused = false;  // A pause or scrub holds one operation, not the next
+    emit frameChanged(current, 0);
+    emit finished();
+}
+
+TimelineControls::TimelineControls(AnimationTimeline *timeline, QWidget *parent)
+    : QGroupBox(parent)
+    , timeline(timeline)
+{
+    StyleManager::instance().applyTraversalGroupStyle(this);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(20, 15, 20, 15);
+    layout->setSpacing(8);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->setSpacing(8);
+
+    speedBox = new QComboBox();
+    speedBox->addItem("⚡ Instant", 0.0);
+    for (double factor : {0.5, 1.0, 2.0, 5.0, 10.0, 50.0}) {
+        speedBox->addItem(QString("%1×").arg(factor), factor);
+    }
+    speedBox->setFixedHeight(30);
+    speedBox->setStyleSheet(R"(
+        QComboBox {
+            border: 2px solid #e9ecef;
+            border-radius: 6px;
+            padding: 2px 8px;
+            background: white;
+            color: #495057;
+        }
+    )");
+    buttonLayout->addWidget(speedBox);
+
+    backButton = new QPushButton("⏮");
+    pauseButton = new QPushButton("⏸ Pause");
+    forwardButton = new QPushButton("⏭");
+    skipButton = new QPushButton("⏩ Skip");
+
+    for (QPushButton *button : {backButton, pauseButton, forwardButton, skipButton}) {
+        button->setFixedHeight(30);
+        buttonLayout->addWidget(button);
+    }
+    StyleManager::instance().applyTraversalButtonStyle(backButton, "#4a90e2");
+    StyleManager::instance().applyTraversalButtonStyle(pauseButton, "#28a745");
+    StyleManager::instance().applyTraversalButtonStyle(forwardButton, "#4a90e2");
+    StyleManager::instance().applyTraversalButtonStyle(skipButton, "#4a90e2");
+
+    layout->addLayout(buttonLayout);
+
+    QHBoxLayout *scrubLayout = new QHBoxLayout();
+    scrubSlider = new QSlider(Qt::Horizontal);
+    frameLabel = new QLabel();
+    frameLabel->setStyleSheet("color: #495057;");
+    scrubLayout->addWidget(scrubSlider, 1);
+    scrubLayout->addWidget(frameLabel);
+    layout->addLayout(scrubLayout);
+
+    connect(speedBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TimelineControls::onSpeedChanged);
+    connect(backButton, &QPushButton::clicked, timeline, &AnimationTimeline::stepBack);
+    connect(pauseButton, &QPushButton::clicked, this, &TimelineControls::onPauseClicked);
+    connect(forwardButton, &QPushButton::clicked, timeline, &AnimationTimeline::stepForward);
+    connect(skipButton, &QPushButton::clicked, timeline, &AnimationTimeline::finish);
+    connect(scrubSlider, &QSlider::sliderMoved, this, &TimelineControls::onScrubbed);
+    connect(timeline, &AnimationTimeline::frameChanged, this, &TimelineControls::updateState);
+
+    updateState();
+}
+
+void TimelineControls::showEvent(QShowEvent *event)
+{
+    // The speed is shared by all labs - pick up a change made in another lab
+    const QSignalBlocker blocker(speedBox);
+    const int index = speedBox->findData(AnimationTimeline::speed());
+    speedBox->setCurrentIndex(index >= 0 ? index : speedBox->findData(1.0));
+    updateState();
+    QGroupBox::showEvent(event);
+}
+
+void TimelineControls::onSpeedChanged(int index)
+{
+    AnimationTimeline::setSpeed(speedBox->itemData(index).toDouble());
+    // Switching to instant lands the operation on screen right away
+    if (AnimationTimeline::isInstant()) timeline->finish();
+}
+
+void TimelineControls::onPauseClicked()
+{
+    if (timeline->isPaused()) timeline->resume();
+    else timeline->pause();
+}
+
+void TimelineControls::onScrubbed(int value)
+{
+    // Scrubbing holds the frame it lands on until resumed
+    if (!timeline->isPaused()) timeline->pause();
+    timeline->seek(value);
+}
+
+void TimelineControls::updateState()
+{
+    const bool running = timeline->isRunning();
+    const int current = timeline->currentFrame();
+
+    pauseButton->setText(timeline->isPaused() ? "▶ Resume" : "⏸ Pause");
+    backButton->setEnabled(running && current > timeline->firstSeekable());
+    forwardButton->setEnabled(running);
+    skipButton->setEnabled(running);
+    scrubSlider->setEnabled(running);
+
+    const QSignalBlocker blocker(scrubSlider);
+    scrubSlider->setRange(0, std::max(0, timeline->frameCount() - 1));
+    scrubSlider->setValue(std::max(0, current));
+    frameLabel->setText(running ? QString("Step %1/%2").arg(current + 1).arg(timeline->frameCount())
+                                : QString("Idle"));
+}
@@ -0,0 +1,110 @@
+#ifndef ANIMATIONTIMELINE_H
+#define ANIMATIONTIMELINE_H
+
+#include <QObject>
+#include <QGroupBox>
+#include <QTimer>
+#include <QPushButton>
+#include <QComboBox>
+#include <QSlider>
+#include <QLabel>
+#include <functional>
+#include <vector>
+
+// One step of an animated operation. When the timeline reaches a frame it
+// runs reach() once, then show(); scrubbing back to it runs show() alone,
+// so show() must put the whole frame on screen (status, highlights) and
+// reach() holds what may happen only once (narration, engine changes).
+struct AnimationFrame {
+    int durationMs = 0;           // Time on screen at 1x before the next frame
+    std::function<void()> reach;
+    std::function<void()> show;
+    bool changesEngine = false;   // Scrubbing can't go back past this frame
+};
+
+// Plays the frame list of one operation at the shared speed - replacing
+// chains of QTimer::singleShot lambdas, which could not be paused, sped
+// up, skipped or cancelled. The timer belongs to the timeline, so frames
+// never outlive the lab that queued them.
+class AnimationTimeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AnimationTimeline(QObject *parent = nullptr);
+
+    // Speed multiplier shared by every lab and by animated replay.
+    // 0 is instant mode: play() runs the whole list before returning.
+    static double speed() { return speedFactor; }
+    static void setSpeed(double factor) { speedFactor = factor < 0 ? 0 : factor; }
+    static bool isInstant() { return speedFactor == 0; }
+    static int scaled(int ms);  // ms at the current speed, 0 when instant
+
+    // Replaces the current list; frames still pending there run first
+    void play(std::vector<AnimationFrame> frames);
+    // Appends to the list being played (or plays it when idle) - for steps
+    // only known once an earlier frame has run, such as a tree's rotations
+    void extend(std::vector<AnimationFrame> frames);
+    void finish();  // Run every pending frame now
+
+    void pause();
+    void resume();
+    void stepForward();
+    void stepBack();
+    void seek(int index);  // Clamped to [firstSeekable(), frameCount() - 1]
+
+    bool isRunning() const { return !frames.empty(); }
+    bool isPaused() const { return paused; }
+    int frameCount() const { return static_cast<int>(frames.size()); }
+    int currentFrame() const { return current; }
+    int firstSeekable() const { return floor; }
+
+signals:
+    void frameChanged(int index, int count);
+    void finished();
+
+private:
+    void advance();
+    void reachUpTo(int index);
+    void scheduleNext();
+    void complete();
+
+    static double speedFactor;
+
+    QTimer *timer;
+    std::vector<AnimationFrame> frames;
+    int current = -1;   // Frame on screen
+    int reached = -1;   // Last frame whose reach() has run
+    int floor = 0;      // Last frame that changed the engine
+    bool paused = false;
+};
+
+// Speed, pause/step/skip and a scrub slider for one lab's timeline
+class TimelineControls : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    explicit TimelineControls(AnimationTimeline *timeline, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void onSpeedChanged(int index);
+    void onPauseClicked();
+    void onScrubbed(int value);
+    void updateState();
+
+private:
+    AnimationTimeline *timeline;
+    QComboBox *speedBox;
+    QPushButton *backButton;
+    QPushButton *pauseButton;
+    QPushButton *forwardButton;
+    QPushButton *skipButton;
+    QSlider *scrubSlider;
+    QLabel *frameLabel;
+};
+
+#endif // ANIMATIONTIMELINE_H
@@ -0,0 +1,752 @@
+// AdvDS-bench: microbenchmarks for the headless data-structure engines.
+//
+//   AdvDS-bench [--sizes 1000,10000,...] [--dists sequential,random,reverse]
+//               [--structures bst,avl,treap,rb,hash,graph] [--repeat N] [--seed S]
+//               [--format csv|json] [--out FILE] [--bst-degenerate-max N]
+//               [--graph-max N]
+//
+// Each row reports one (structure, operation, distribution, size) cell:
+// ns/op and ops/sec are the best of --repeat runs, rss_kb is the resident
+// set size with the structure fully built. Tree rows also report the tree
+// height; Red-Black rows carry the 2*log2(n+1) bound and AVL rows the
+// 1.44*log2(n+2) one, and the run exits with status 1 if any tree exceeds
+// its bound or a Red-Black tree fails its invariant check during churn.
+// mallocs counts the node arena's heap allocations in one run; delete,
+// rebuild, rebalance and churn should be 0. BST rebalance rows time a
+// Day-Stout-Warren pass over the tree as inserted and must reach the
+// complete tree's height, floor(log2 n) + 1.
+
+#include "bstengine.h"
+#include "rbtreeengine.h"
+#include "persistentrbtree.h"
+#include "graphengine.h"
+#include "hashmap.h"
+#include "threadpool.h"
+#include "treelayout.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<long long> sizes{1000, 10000, 100000, 1000000, 10000000};
+    std::vector<std::string> distributions{"sequential", "random", "reverse"};
+    std::vector<std::string> structures{"bst", "avl", "treap", "rb", "hash", "graph"};
+    int repeat = 3;
+    unsigned seed = 42;
+    bool json = false;
+    std::string outPath;
+    // Sorted input turns the plain BST into a linked list (O(n^2) build)
+    long long bstDegenerateMax = 20000;
+    // Adjacency sets cost ~100 bytes per edge; 10^7 vertices needs several GB
+    long long graphMax = 1000000;
+};
+
+struct Result {
+    std::string structure;
+    std::string operation;
+    std::string distribution;
+    long long size = 0;
+    int threads = 1;
+    long long ops = 0;
+    double bestNs = 0.0;
+    long rssKb = 0;
+    int height = 0;       // Trees only
+    int heightLimit = 0;  // Red-Black only: floor(2 * log2(n + 1))
+    long long mallocs = 0;  // Trees only: node-arena heap allocations in one run
+};
+
+long residentSetKb()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<long>(counters.WorkingSetSize / 1024);
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return static_cast<long>(info.resident_size / 1024);
+    }
+    return 0;
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+#endif
+}
+
+std::vector<int> makeKeys(const std::string &distribution, long long n, std::mt19937 &rng)
+{
+    std::vector<int> keys(static_cast<size_t>(n));
+    std::iota(keys.begin(), keys.end(), 0);
+    if (distribution == "random") {
+        std::shuffle(keys.begin(), keys.end(), rng);
+    } else if (distribution == "reverse") {
+        std::reverse(keys.begin(), keys.end());
+    }
+    return keys;
+}
+
+std::vector<int> shuffled(std::vector<int> keys, std::mt19937 &rng)
+{
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+template<typename F>
+double timeNs(F &&body)
+{
+    const auto start = Clock::now();
+    body();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+// Keeps results alive so the optimiser cannot drop lookups
+volatile long long sink = 0;
+
+// Keys per window in the range-scan rows
+const int SCAN_WIDTH = 64;
+
+// Node diameter plus gap in the tree labs, in pixels, for the layout rows
+const int LAYOUT_SEPARATION = 60;
+
+// Lazy cursor walks, one row each: no recursion and no node list, so they
+// run at any size. walk-level holds a two-level frontier; it should track
+// the bfs row, sorted-input BSTs included.
+const struct {
+    TraversalOrder order;
+    const char *operation;
+} TREE_WALKS[] = {
+    {TraversalOrder::PreOrder, "walk-pre"},
+    {TraversalOrder::InOrder, "walk-in"},
+    {TraversalOrder::PostOrder, "walk-post"},
+    {TraversalOrder::LevelOrder, "walk-level"},
+};
+const int TREE_WALK_COUNT = 4;
+
+template<typename Node>
+long long walkedNodes(TreeCursor<Node> walk)
+{
+    long long count = 0;
+    while (walk.next()) ++count;
+    return count;
+}
+
+class Bench
+{
+public:
+    explicit Bench(const Options &options) : options(options), rng(options.seed) {}
+
+    void run()
+    {
+        for (const std::string &structure : options.structures) {
+            for (long long n : options.sizes) {
+                if (structure == "graph") {
+                    benchGraph(n);  // Key distribution doesn't apply
+                    continue;
+                }
+                if (structure == "hash" && n == options.sizes.back()) {
+                    benchRehashScaling(n);
+                }
+                if (structure == "rb") {
+                    benchRbBuild(n);
+                    benchRbChurn(n);
+                    benchRbSetOperations(n);
+                }
+                for (const std::string &distribution : options.distributions) {
+                    if (structure == "bst") benchBst(distribution, n, BalanceMode::None, structure);
+                    else if (structure == "avl") benchBst(distribution, n, BalanceMode::AVL, structure);
+                    else if (structure == "treap") benchBst(distribution, n, BalanceMode::Treap, structure);
+                    else if (structure == "rb") benchRb(distribution, n);
+                    else if (structure == "hash") benchHash(distribution, n);
+                }
+            }
+        }
+    }
+
+    const std::vector<Result> &results() const { return rows; }
+    int invariantViolations() const { return violations; }
+
+private:
+    void record(const std::string &structure, const std::string &operation, const std::string &distribution,
+                long long size, long long ops, const std::vector<double> &runsNs, long rssKb, int threads = 1)
+    {
+        Result result;
+        result.structure = structure;
+        result.operation = operation;
+        result.distribution = distribution;
+        result.size = size;
+        result.threads = threads;
+        result.ops = ops;
+        result.bestNs = *std::min_element(runsNs.begin(), runsNs.end());
+        result.rssKb = rssKb;
+        rows.push_back(result);
+        std::cerr << structure << ' ' << operation << ' ' << distribution << " n=" << size
+                  << ": " << result.bestNs / std::max(1LL, ops) << " ns/op" << std::endl;
+    }
+
+    void recordMallocs(std::size_t blockAllocations)
+    {
+        rows.back().mallocs = static_cast<long long>(blockAllocations);
+    }
+
+    enum class HeightBound { None, RedBlack, AVL, Complete };
+
+    // Attach a tree height to the last row and check the balanced trees' bound
+    void recordHeight(int height, long long nodes, HeightBound bound)
+    {
+        Result &row = rows.back();
+        row.height = height;
+        if (bound == HeightBound::None) return;
+        const double n = static_cast<double>(nodes);
+        const char *formula = "2*log2(n+1)";
+        if (bound == HeightBound::RedBlack) {
+            row.heightLimit = static_cast<int>(std::floor(2.0 * std::log2(n + 1.0)));
+        } else if (bound == HeightBound::Complete) {
+            row.heightLimit = static_cast<int>(std::floor(std::log2(n))) + 1;
+            formula = "floor(log2(n))+1";
+        } else {
+            row.heightLimit = static_cast<int>(std::floor(1.4405 * std::log2(n + 2.0) - 0.3277));
+            formula = "1.44*log2(n+2)-0.33";
+        }
+        if (height > row.heightLimit) {
+            ++violations;
+            std::cerr << row.structure << ' ' << row.operation << ' ' << row.distribution << " n=" << row.size
+                      << ": height " << height << " exceeds " << formula << " = " << row.heightLimit << std::endl;
+        }
+    }
+
+    // Plain, AVL or treap BST; only the plain tree degenerates on sorted keys
+    void benchBst(const std::string &distribution, long long n, BalanceMode mode, const std::string &name)
+    {
+        if (mode == BalanceMode::None && distribution != "random" && n > options.bstDegenerateMax) {
+            std::cerr << "bst " << distribution << " n=" << n
+                      << ": skipped (degenerate tree, raise --bst-degenerate-max)" << std::endl;
+            return;
+        }
+
+        const std::vector<int> keys = makeKeys(distribution, n, rng);
+        const std::vector<int> probes = shuffled(keys, rng);
+        std::vector<double> insertNs, searchNs, bfsNs, dfsNs, layoutNs, deleteNs, rebuildNs, rebalanceNs, clearNs;
+        std::vector<double> walkNs[TREE_WALK_COUNT];
+        long rss = 0;
+        int height = 0, rebalancedHeight = 0;
+        std::size_t insertMallocs = 0, deleteMallocs = 0, rebuildMallocs = 0, rebalanceMallocs = 0;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            BSTEngine tree;
+            tree.setBalanceMode(mode);
+            const NodeArenaStats &stats = tree.allocationStats();
+            insertNs.push_back(timeNs([&] { for (int key : keys) tree.insert(key); }));
+            insertMallocs = stats.blockAllocations;
+            rss = std::max(rss, residentSetKb());
+            height = tree.height();
+            searchNs.push_back(timeNs([&] { for (int key : probes) sink += tree.search(key) != nullptr; }));
+            bfsNs.push_back(timeNs([&] { sink += tree.breadthFirstOrder().size(); }));
+            dfsNs.push_back(timeNs([&] { sink += tree.depthFirstOrder().size(); }));
+            for (int w = 0; w < TREE_WALK_COUNT; ++w) {
+                walkNs[w].push_back(timeNs([&] { sink += walkedNodes(tree.cursor(TREE_WALKS[w].order)); }));
+            }
+            layoutNs.push_back(timeNs([&] {
+                sink += TidyTreeLayout::layout(tree.root(), static_cast<TreeNode*>(nullptr), LAYOUT_SEPARATION).size();
+            }));
+            std::size_t before = stats.blockAllocations;
+            deleteNs.push_back(timeNs([&] { for (int key : probes) tree.remove(key); }));
+            deleteMallocs = stats.blockAllocations - before;
+            // Every slot is now on the free list: a rebuild must not touch the heap
+            before = stats.blockAllocations;
+            rebuildNs.push_back(timeNs([&] { for (int key : keys) tree.insert(key); }));
+            rebuildMallocs = stats.blockAllocations - before;
+            if (mode == BalanceMode::None) {
+                // Day-Stout-Warren on the tree as built: rotations only
+                before = stats.blockAllocations;
+                rebalanceNs.push_back(timeNs([&] { tree.rebalanceInPlace(); }));
+                rebalanceMallocs = stats.blockAllocations - before;
+                rebalancedHeight = tree.height();
+            }
+            clearNs.push_back(timeNs([&] { tree.clear(); }));
+        }
+
+        record(name, "insert", distribution, n, n, insertNs, rss);
+        recordHeight(height, n, mode == BalanceMode::AVL ? HeightBound::AVL : HeightBound::None);
+        recordMallocs(insertMallocs);
+        record(name, "search", distribution, n, n, searchNs, rss);
+        record(name, "bfs", distribution, n, n, bfsNs, rss);
+        record(name, "dfs", distribution, n, n, dfsNs, rss);
+        for (int w = 0; w < TREE_WALK_COUNT; ++w) {
+            record(name, TREE_WALKS[w].operation, distribution, n, n, walkNs[w], rss);
+        }
+        record(name, "layout", distribution, n, n, layoutNs, rss);
+        record(name, "delete", distribution, n, n, deleteNs, rss);
+        recordMallocs(deleteMallocs);
+        record(name, "rebuild", distribution, n, n, rebuildNs, rss);
+        recordMallocs(rebuildMallocs);
+        if (!rebalanceNs.empty()) {
+            record(name, "rebalance", distribution, n, n, rebalanceNs, rss);
+            recordHeight(rebalancedHeight, n, HeightBound::Complete);
+            recordMallocs(rebalanceMallocs);
+        }
+        record(name, "clear", distribution, n, 1, clearNs, rss);
+    }
+
+    void benchRb(const std::string &distribution, long long n)
+    {
+        const std::vector<int> keys = makeKeys(distribution, n, rng);
+        const std::vector<int> probes = shuffled(keys, rng);
+        std::vector<double> insertNs, searchNs, selectNs, rankNs, scanNs, bfsNs, dfsNs, layoutNs, deleteNs, rebuildNs, clearNs;
+        std::vector<double> walkNs[TREE_WALK_COUNT];
+        std::vector<double> persistInsertNs, persistDeleteNs;
+        long rss = 0;
+        int height = 0;
+        long long scanned = 0;
+        std::size_t insertMallocs = 0, deleteMallocs = 0, rebuildMallocs = 0;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            RBTreeEngine tree;
+            const NodeArenaStats &stats = tree.allocationStats();
+            insertNs.push_back(timeNs([&] { for (int key : keys) tree.insert(key); }));
+            insertMallocs = stats.blockAllocations;
+            rss = std::max(rss, residentSetKb());
+            height = tree.height();
+            searchNs.push_back(timeNs([&] { for (int key : probes) sink += tree.contains(key); }));
+            // Keys are 0..n-1, so probe k doubles as a position for select
+            selectNs.push_back(timeNs([&] { for (int key : probes) sink += tree.select(key)->value; }));
+            rankNs.push_back(timeNs([&] { for (int key : probes) sink += tree.rank(key); }));
+            // One window of SCAN_WIDTH keys per SCAN_WIDTH keys stored; ops = keys visited
+            scanNs.push_back(timeNs([&] {
+                scanned = 0;
+                for (std::size_t i = 0; i < probes.size(); i += SCAN_WIDTH) {
+                    scanned += tree.rangeQuery(probes[i], probes[i] + SCAN_WIDTH - 1,
+                                               [](const RBNode *node) { sink += node->value; });
+                }
+            }));
+            bfsNs.push_back(timeNs([&] { sink += tree.breadthFirstOrder().size(); }));
+            dfsNs.push_back(timeNs([&] { sink += tree.depthFirstOrder().size(); }));
+            for (int w = 0; w < TREE_WALK_COUNT; ++w) {
+                walkNs[w].push_back(timeNs([&] { sink += walkedNodes(tree.cursor(TREE_WALKS[w].order)); }));
+            }
+            layoutNs.push_back(timeNs([&] {
+                sink += TidyTreeLayout::layout(tree.root(), tree.nil(), LAYOUT_SEPARATION).size();
+            }));
+            std::size_t before = stats.blockAllocations;
+            deleteNs.push_back(timeNs([&] { for (int key : probes) tree.remove(key); }));
+            deleteMallocs = stats.blockAllocations - before;
+            // Every slot is now on the free list: a rebuild must not touch the heap
+            before = stats.blockAllocations;
+            rebuildNs.push_back(timeNs([&] { for (int key : keys) tree.insert(key); }));
+            rebuildMallocs = stats.blockAllocations - before;
+            clearNs.push_back(timeNs([&] { tree.clear(); }));
+
+            // Path-copying versions: every step keeps the previous version whole
+            PersistentRBTree version;
+            persistInsertNs.push_back(timeNs([&] { for (int key : keys) version = version.insert(key); }));
+            persistDeleteNs.push_back(timeNs([&] { for (int key : probes) version = version.remove(key); }));
+        }
+
+        record("rb", "insert", distribution, n, n, insertNs, rss);
+        recordHeight(height, n, HeightBound::RedBlack);
+        recordMallocs(insertMallocs);
+        record("rb", "search", distribution, n, n, searchNs, rss);
+        record("rb", "select", distribution, n, n, selectNs, rss);
+        record("rb", "rank", distribution, n, n, rankNs, rss);
+        record("rb", "scan", distribution, n, scanned, scanNs, rss);
+        record("rb", "bfs", distribution, n, n, bfsNs, rss);
+        record("rb", "dfs", distribution, n, n, dfsNs, rss);
+        for (int w = 0; w < TREE_WALK_COUNT; ++w) {
+            record("rb", TREE_WALKS[w].operation, distribution, n, n, walkNs[w], rss);
+        }
+        record("rb", "layout", distribution, n, n, layoutNs, rss);
+        record("rb", "delete", distribution, n, n, deleteNs, rss);
+        recordMallocs(deleteMallocs);
+        record("rb", "rebuild", distribution, n, n, rebuildNs, rss);
+        recordMallocs(rebuildMallocs);
+        record("rb", "clear", distribution, n, 1, clearNs, rss);
+        record("rb", "persist-insert", distribution, n, n, persistInsertNs, rss);
+        record("rb", "persist-delete", distribution, n, n, persistDeleteNs, rss);
+    }
+
+    // O(n) bulk load from sorted keys, against the insert rows above
+    void benchRbBuild(long long n)
+    {
+        const std::vector<int> keys = makeKeys("sequential", n, rng);
+        std::vector<double> buildNs;
+        long rss = 0;
+        int height = 0;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            RBTreeEngine tree;
+            buildNs.push_back(timeNs([&] { tree.buildFromSorted(keys); }));
+            rss = std::max(rss, residentSetKb());
+            height = tree.height();
+        }
+
+        record("rb", "build", "sequential", n, n, buildNs, rss);
+        recordHeight(height, n, HeightBound::RedBlack);
+    }
+
+    // Two n-key trees - multiples of 2 and of 3, so a third of b is shared.
+    // union-insert is the one-by-one baseline; the join-based operations run
+    // once on the calling thread alone and once forked across the pool.
+    void benchRbSetOperations(long long n)
+    {
+        if (n < 1) return;
+        std::vector<int> evens(static_cast<size_t>(n)), triples(static_cast<size_t>(n));
+        for (long long i = 0; i < n; ++i) {
+            evens[static_cast<size_t>(i)] = static_cast<int>(2 * i);
+            triples[static_cast<size_t>(i)] = static_cast<int>(3 * i);
+        }
+        const int poolThreads = static_cast<int>(ThreadPool::instance().threadCount()) + 1;
+
+        auto runs = [&](int threshold, void (RBTreeEngine::*operation)(RBTreeEngine &), int &height) {
+            std::vector<double> runsNs;
+            for (int r = 0; r < options.repeat; ++r) {
+                RBTreeEngine a, b;
+                a.buildFromSorted(evens);
+                b.buildFromSorted(triples);
+                a.setParallelMergeThreshold(threshold);
+                runsNs.push_back(timeNs([&] { (a.*operation)(b); }));
+                height = a.height();
+                sink += a.size();
+            }
+            return runsNs;
+        };
+
+        std::vector<double> insertNs;
+        long rss = 0;
+        int height = 0;
+        for (int r = 0; r < options.repeat; ++r) {
+            RBTreeEngine a;
+            a.buildFromSorted(evens);
+            insertNs.push_back(timeNs([&] { for (int key : triples) a.insert(key); }));
+            rss = std::max(rss, residentSetKb());
+            height = a.height();
+        }
+        record("rb", "union-insert", "sequential", n, n, insertNs, rss);
+        recordHeight(height, n + n - (n + 2) / 3, HeightBound::RedBlack);
+
+        const struct {
+            const char *name;
+            void (RBTreeEngine::*operation)(RBTreeEngine &);
+            long long resultSize;
+        } operations[] = {
+            {"union", &RBTreeEngine::unionWith, n + n - (n + 2) / 3},
+            {"intersect", &RBTreeEngine::intersectWith, (n + 2) / 3},
+            {"difference", &RBTreeEngine::differenceWith, n - (n + 2) / 3},
+        };
+        for (const auto &entry : operations) {
+            record("rb", entry.name, "sequential", n, n, runs(INT_MAX, entry.operation, height), rss, 1);
+            recordHeight(height, entry.resultSize, HeightBound::RedBlack);
+            record("rb", entry.name, "sequential", n, n, runs(1 << 14, entry.operation, height), rss, poolThreads);
+            recordHeight(height, entry.resultSize, HeightBound::RedBlack);
+        }
+    }
+
+    // Mixed insert/delete at a steady size n: each step deletes a random live
+    // key and inserts a fresh one. The tallest tree seen must stay within
+    // 2*log2(n+1), and a full invariant check between batches must pass.
+    // churn-checked repeats the run with a last-path check after every
+    // operation, so its gap to churn is the cost of checking as you go.
+    void benchRbChurn(long long n)
+    {
+        if (n < 1) return;
+        const long long steps = n;
+        const long long checkEvery = std::max(1LL, steps / 8);
+        std::vector<double> churnNs, checkedNs, fullCheckNs;
+        long rss = 0;
+        int maxHeight = 0;
+        std::size_t churnMallocs = 0;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            // Even keys are live, odd keys are inserted during churn
+            std::vector<int> live = shuffled(makeKeys("random", n, rng), rng);
+            for (int &key : live) key *= 2;
+            RBTreeEngine tree;
+            for (int key : live) tree.insert(key);
+            rss = std::max(rss, residentSetKb());
+            maxHeight = std::max(maxHeight, tree.height());
+
+            std::uniform_int_distribution<long long> pick(0, n - 1);
+            int nextKey = 1;
+            double ns = 0.0;
+            const std::size_t before = tree.allocationStats().blockAllocations;
+            for (long long done = 0; done < steps; done += checkEvery) {
+                const long long batch = std::min(checkEvery, steps - done);
+                ns += timeNs([&] {
+                    for (long long i = 0; i < batch; ++i) {
+                        int &slot = live[static_cast<size_t>(pick(rng))];
+                        tree.remove(slot);
+                        slot = nextKey;
+                        tree.insert(nextKey);
+                        nextKey += 2;
+                    }
+                });
+                maxHeight = std::max(maxHeight, tree.height());
+                const RBCheckReport check = tree.checkInvariants();
+                fullCheckNs.push_back(static_cast<double>(check.nanoseconds));
+                countViolation("churn", n, check);
+            }
+            churnNs.push_back(ns);
+            // Each delete frees the slot the next insert takes
+            churnMallocs = tree.allocationStats().blockAllocations - before;
+
+            ns = 0.0;
+            int failed = 0;
+            ns += timeNs([&] {
+                for (long long i = 0; i < steps; ++i) {
+                    int &slot = live[static_cast<size_t>(pick(rng))];
+                    tree.remove(slot);
+                    if (!tree.checkInvariants(RBTreeEngine::CheckScope::LastPath).valid) ++failed;
+                    slot = nextKey;
+                    tree.insert(nextKey);
+                    if (!tree.checkInvariants(RBTreeEngine::CheckScope::LastPath).valid) ++failed;
+                    nextKey += 2;
+                }
+            });
+            checkedNs.push_back(ns);
+            if (failed > 0) {
+                RBCheckReport check = tree.checkInvariants();
+                if (check.valid) check.violation = "last-path check failed " + std::to_string(failed) + " times";
+                check.valid = false;
+                countViolation("churn-checked", n, check);
+            }
+        }
+
+        record("rb", "churn", "random", n, 2 * steps, churnNs, rss);
+        recordHeight(maxHeight, n, HeightBound::RedBlack);
+        recordMallocs(churnMallocs);
+        record("rb", "churn-checked", "random", n, 2 * steps, checkedNs, rss);
+        record("rb", "check-full", "random", n, n, fullCheckNs, rss);
+    }
+
+    void countViolation(const std::string &operation, long long n, const RBCheckReport &check)
+    {
+        if (check.valid) return;
+        ++violations;
+        std::cerr << "rb " << operation << " n=" << n << ": invariant broken: " << check.violation << std::endl;
+    }
+
+    void benchHash(const std::string &distribution, long long n)
+    {
+        const std::vector<int> keys = makeKeys(distribution, n, rng);
+        const std::vector<int> probes = shuffled(keys, rng);
+        std::vector<double> insertNs, searchNs, deleteNs;
+        long rss = 0;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            HashMap map;
+            map.setTracingEnabled(false);
+            map.setKeyType(HashMap::INTEGER);
+            map.setValueType(HashMap::INTEGER);
+            // No reserve(): insert includes the doublings, parallel once large
+
+            insertNs.push_back(timeNs([&] { for (int key : keys) map.put(key, key); }));
+            rss = std::max(rss, residentSetKb());
+            searchNs.push_back(timeNs([&] { for (int key : probes) sink += map.contains(key); }));
+            deleteNs.push_back(timeNs([&] { for (int key : probes) map.erase(key); }));
+        }
+
+        record("hash", "insert", distribution, n, n, insertNs, rss);
+        record("hash", "search", distribution, n, n, searchNs, rss);
+        record("hash", "delete", distribution, n, n, deleteNs, rss);
+    }
+
+    // Rehash the same table with 1, 2, 4 ... threads
+    void benchRehashScaling(long long n)
+    {
+        HashMap map;
+        map.setTracingEnabled(false);
+        map.setKeyType(HashMap::INTEGER);
+        map.setValueType(HashMap::INTEGER);
+        map.reserve(static_cast<int>(n));
+        for (int key : makeKeys("random", n, rng)) map.put(key, key);
+        const long rss = residentSetKb();
+
+        map.setParallelRehashThreshold(0);
+        const int maxThreads = static_cast<int>(ThreadPool::instance().threadCount()) + 1;
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+        threadCounts.push_back(maxThreads);
+
+        for (int threads : threadCounts) {
+            map.setRehashThreadCount(threads);
+            std::vector<double> runsNs;
+            for (int r = 0; r < options.repeat; ++r) {
+                map.rehash(map.bucketCount());
+                runsNs.push_back(map.lastRehashStats().elapsedMs * 1.0e6);
+            }
+            record("hash", "rehash", "random", n, n, runsNs, rss, map.lastRehashStats().threads);
+        }
+    }
+
+    // Random graph with about 4 edges per vertex
+    void benchGraph(long long n)
+    {
+        if (n < 2) return;
+        if (n > options.graphMax) {
+            std::cerr << "graph n=" << n << ": skipped (raise --graph-max)" << std::endl;
+            return;
+        }
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(n) - 1);
+        std::vector<double> buildNs, bfsNs, dfsNs;
+        long rss = 0;
+        long long edges = 0;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            GraphEngine graph;
+            std::mt19937 edgeRng(options.seed + static_cast<unsigned>(r));
+            buildNs.push_back(timeNs([&] {
+                for (long long v = 0; v < n; ++v) graph.addVertex(static_cast<int>(v));
+                // Spanning path keeps the graph connected so traversals visit every vertex
+                for (long long v = 1; v < n; ++v) graph.addEdge(static_cast<int>(v - 1), static_cast<int>(v));
+                for (long long e = 0; e < 3 * n; ++e) graph.addEdge(pick(edgeRng), pick(edgeRng));
+            }));
+            edges = graph.edgeCount();
+            rss = std::max(rss, residentSetKb());
+            bfsNs.push_back(timeNs([&] { sink += graph.breadthFirstOrder(0).size(); }));
+            dfsNs.push_back(timeNs([&] { sink += graph.depthFirstOrder(0).size(); }));
+        }
+
+        record("graph", "build", "random", n, n + edges, buildNs, rss);
+        record("graph", "bfs", "random", n, n, bfsNs, rss);
+        record("graph", "dfs", "random", n, n, dfsNs, rss);
+    }
+
+    const Options &options;
+    std::mt19937 rng;
+    std::vector<Result> rows;
+    int violations = 0;
+};
+
+std::vector<std::string> splitList(const std::string &text)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            options.sizes.clear();
+            for (const std::string &size : splitList(argv[++i])) options.sizes.push_back(std::atoll(size.c_str()));
+        } else if (arg == "--dists" && hasValue) {
+            options.distributions = splitList(argv[++i]);
+        } else if (arg == "--structures" && hasValue) {
+            options.structures = splitList(argv[++i]);
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--format" && hasValue) {
+            options.json = std::strcmp(argv[++i], "json") == 0;
+        } else if (arg == "--out" && hasValue) {
+            options.outPath = argv[++i];
+        } else if (arg == "--bst-degenerate-max" && hasValue) {
+            options.bstDegenerateMax = std::atoll(argv[++i]);
+        } else if (arg == "--graph-max" && hasValue) {
+            options.graphMax = std::atoll(argv[++i]);
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !options.sizes.empty();
+}
+
+void writeCsv(std::ostream &out, const std::vector<Result> &rows)
+{
+    out << "structure,operation,distribution,size,threads,ops,total_ms,ns_per_op,ops_per_sec,rss_kb,height,height_limit,mallocs\n";
+    for (const Result &row : rows) {
+        const double nsPerOp = row.bestNs / std::max(1LL, row.ops);
+        out << row.structure << ',' << row.operation << ',' << row.distribution << ','
+            << row.size << ',' << row.threads << ',' << row.ops << ','
+            << row.bestNs / 1.0e6 << ',' << nsPerOp << ','
+            << (nsPerOp > 0 ? 1.0e9 / nsPerOp : 0.0) << ',' << row.rssKb << ','
+            << row.height << ',' << row.heightLimit << ',' << row.mallocs << '\n';
+    }
+}
+
+void writeJson(std::ostream &out, const std::vector<Result> &rows)
+{
+    out << "[\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Result &row = rows[i];
+        const double nsPerOp = row.bestNs / std::max(1LL, row.ops);
+        out << "  {\"structure\": \"" << row.structure << "\", \"operation\": \"" << row.operation
+            << "\", \"distribution\": \"" << row.distribution << "\", \"size\": " << row.size
+            << ", \"threads\": " << row.threads << ", \"ops\": " << row.ops
+            << ", \"total_ms\": " << row.bestNs / 1.0e6 << ", \"ns_per_op\": " << nsPerOp
+            << ", \"ops_per_sec\": " << (nsPerOp > 0 ? 1.0e9 / nsPerOp : 0.0)
+            << ", \"rss_kb\": " << row.rssKb << ", \"height\": " << row.height
+            << ", \"height_limit\": " << row.heightLimit << ", \"mallocs\": " << row.mallocs << '}' << (i + 1 < rows.size() ? "," : "") << '\n';
+    }
+    out << "]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: AdvDS-bench [--sizes 1000,10000] [--dists sequential,random,reverse]\n"
+                     "                   [--structures bst,avl,treap,rb,hash,graph] [--repeat N] [--seed S]\n"
+                     "                   [--format csv|json] [--out FILE] [--bst-degenerate-max N]\n"
+                     "                   [--graph-max N]\n";
+        return 2;
+    }
+
+    Bench bench(options);
+    bench.run();
+
+    std::ofstream file;
+    if (!options.outPath.empty()) {
+        file.open(options.outPath);
+        if (!file) {
+            std::cerr << "Cannot write " << options.outPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = options.outPath.empty() ? std::cout : file;
+    if (options.json) writeJson(out, bench.results());
+    else writeCsv(out, bench.results());
+    return bench.invariantViolations() > 0 ? 1 : 0;
+}
@@ -0,0 +1,427 @@
+#include "bstengine.h"
+
+#include <algorithm>
+
+namespace {
+
+// Links sorted[lo..hi] into a perfectly balanced subtree under parent.
+// Recursion depth is log2 n.
+TreeNode* linkBalanced(std::vector<TreeNode*> &sorted, int lo, int hi, TreeNode *parent)
+{
+    if (lo > hi) return nullptr;
+    const int mid = lo + (hi - lo) / 2;
+    TreeNode *node = sorted[mid];
+    node->parentNode = parent;
+    node->left = linkBalanced(sorted, lo, mid - 1, node);
+    node->right = linkBalanced(sorted, mid + 1, hi, node);
+    const int left = node->left ? node->left->height : 0;
+    const int right = node->right ? node->right->height : 0;
+    node->height = static_cast<std::uint8_t>(1 + std::max(left, right));
+    return node;
+}
+
+} // namespace
+
+bool BSTEngine::insert(int value, TreeNode **inserted, bool rebalance)
+{
+    TreeNode *current = rootNode;
+    TreeNode *parent = nullptr;
+
+    while (current) {
+        parent = current;
+        if (value < current->value) {
+            current = current->left;
+        } else if (value > current->value) {
+            current = current->right;
+        } else {
+            return false;  // Duplicate
+        }
+    }
+
+    TreeNode *newNode = nodes.create(value);
+    newNode->parentNode = parent;
+    if (!parent) {
+        rootNode = newNode;
+    } else if (value < parent->value) {
+        parent->left = newNode;
+    } else {
+        parent->right = newNode;
+    }
+    ++nodeCount;
+    if (inserted) *inserted = newNode;
+    emitEvent({EngineEvent::NodeInserted, value});
+
+    if (balance == BalanceMode::AVL) {
+        fix = Fix::HeightsUp;
+        fixNode = parent;
+    } else if (balance == BalanceMode::Treap) {
+        fix = Fix::PriorityUp;
+        fixNode = newNode;
+    }
+    findNextRotation();
+    if (rebalance) finishRebalance();
+    return true;
+}
+
+TreeNode* BSTEngine::search(int value) const
+{
+    TreeNode *current = rootNode;
+
+    while (current) {
+        if (value == current->value) {
+            return current;
+        } else if (value < current->value) {
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    return nullptr;
+}
+
+std::vector<TreeNode*> BSTEngine::searchPath(int value) const
+{
+    std::vector<TreeNode*> path;
+    TreeNode *current = rootNode;
+
+    while (current) {
+        path.push_back(current);
+        if (value == current->value) break;
+        current = value < current->value ? current->left : current->right;
+    }
+
+    return path;
+}
+
+bool BSTEngine::remove(int value, bool rebalance)
+{
+    TreeNode *node = search(value);
+    if (!node) return false;
+
+    if (balance == BalanceMode::Treap && node->left && node->right) {
+        // Moving a successor's key up would break the priority order, so
+        // the node itself is rotated down until it can be unlinked
+        fix = Fix::PriorityDown;
+        fixNode = node;
+        if (rebalance) finishRebalance();
+        return true;
+    }
+
+    // Two children: the successor's value moves up and the successor,
+    // which has no left child, is unlinked in its place
+    if (node->left && node->right) {
+        TreeNode *successor = findMin(node->right);
+        node->value = successor->value;
+        node = successor;
+    }
+
+    TreeNode *parent = node->parentNode;
+    unlink(node);
+    emitEvent({EngineEvent::NodeRemoved, value});
+
+    if (balance == BalanceMode::AVL) {
+        fix = Fix::HeightsUp;
+        fixNode = parent;
+        findNextRotation();
+    }
+    if (rebalance) finishRebalance();
+    return true;
+}
+
+void BSTEngine::clear()
+{
+    nodes.releaseAll();  // O(1) - no walk over the tree
+    rootNode = nullptr;
+    nodeCount = 0;
+    fixNode = nullptr;
+    emitEvent(EngineEvent::Cleared);
+}
+
+void BSTEngine::replaceChild(TreeNode *parent, TreeNode *oldChild, TreeNode *newChild)
+{
+    if (!parent) {
+        rootNode = newChild;
+    } else if (parent->left == oldChild) {
+        parent->left = newChild;
+    } else {
+        parent->right = newChild;
+    }
+    if (newChild) newChild->parentNode = parent;
+}
+
+void BSTEngine::unlink(TreeNode *node)
+{
+    replaceChild(node->parentNode, node, node->left ? node->left : node->right);
+    nodes.destroy(node);
+    --nodeCount;
+}
+
+void BSTEngine::rotateLeft(TreeNode *node)
+{
+    TreeNode *pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left) pivot->left->parentNode = node;
+    replaceChild(node->parentNode, node, pivot);
+    pivot->left = node;
+    node->parentNode = pivot;
+    if (balance == BalanceMode::AVL) {
+        updateHeight(node);
+        updateHeight(pivot);
+    }
+    emitEvent({EngineEvent::Rotated, node->value, pivot->value});
+}
+
+void BSTEngine::rotateRight(TreeNode *node)
+{
+    TreeNode *pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right) pivot->right->parentNode = node;
+    replaceChild(node->parentNode, node, pivot);
+    pivot->right = node;
+    node->parentNode = pivot;
+    if (balance == BalanceMode::AVL) {
+        updateHeight(node);
+        updateHeight(pivot);
+    }
+    emitEvent({EngineEvent::Rotated, node->value, pivot->value});
+}
+
+void BSTEngine::findNextRotation()
+{
+    if (!fixNode) return;
+
+    switch (fix) {
+    case Fix::HeightsUp:
+        while (fixNode) {
+            const bool changed = updateHeight(fixNode);
+            const int lean = balanceOf(fixNode);
+            if (lean > 1 || lean < -1) return;  // Rotate here next
+            if (!changed) break;                // Nothing above can change
+            fixNode = fixNode->parentNode;
+        }
+        break;
+    case Fix::PriorityUp:
+        if (fixNode->parentNode && priorityOf(fixNode->value) > priorityOf(fixNode->parentNode->value)) return;
+        break;
+    case Fix::PriorityDown:
+        return;  // Pending until rebalanceStep() unlinks it
+    case Fix::Vine: {
+        while (fixNode && !fixNode->left) fixNode = fixNode->right;
+        if (fixNode) return;
+        // The vine is done. A first pass folds the nodes beyond the
+        // largest complete tree (2^k - 1 nodes) that fits
+        int complete = 1;
+        while (complete * 2 + 1 <= nodeCount) complete = complete * 2 + 1;
+        fix = Fix::Compress;
+        passLeft = nodeCount - complete;
+        passSize = complete;
+        fixNode = rootNode;
+        [[fallthrough]];
+    }
+    case Fix::Compress:
+        // Each later pass halves the spine again
+        while (passLeft == 0 && passSize > 1) {
+            passSize /= 2;
+            passLeft = passSize;
+        }
+        if (passLeft > 0) return;
+        break;
+    }
+    fixNode = nullptr;
+}
+
+void BSTEngine::rebalanceStep()
+{
+    TreeNode *node = fixNode;
+    if (!node) return;
+
+    switch (fix) {
+    case Fix::HeightsUp: {
+        // A zig-zag is straightened by a rotation at the child first; the
+        // node stays unbalanced, so the next step rotates it
+        TreeNode *rotated = node;
+        if (balanceOf(node) > 1) {
+            if (balanceOf(node->left) < 0) {
+                rotated = node->left;
+                rotateLeft(rotated);
+            } else {
+                rotateRight(node);
+            }
+        } else if (balanceOf(node->right) > 0) {
+            rotated = node->right;
+            rotateRight(rotated);
+        } else {
+            rotateLeft(node);
+        }
+        // Resume above the subtree the rotation rebuilt
+        fixNode = rotated->parentNode->parentNode;
+        break;
+    }
+    case Fix::PriorityUp:
+        if (node == node->parentNode->left) rotateRight(node->parentNode);
+        else rotateLeft(node->parentNode);
+        break;
+    case Fix::PriorityDown:
+        if (node->left && node->right) {
+            // The child of higher priority moves up
+            if (priorityOf(node->left->value) > priorityOf(node->right->value)) rotateRight(node);
+            else rotateLeft(node);
+        } else {
+            const int value = node->value;
+            fixNode = nullptr;
+            unlink(node);
+            emitEvent({EngineEvent::NodeRemoved, value});
+        }
+        return;
+    case Fix::Vine: {
+        // The left child moves up; its own left child comes next
+        TreeNode *pivot = node->left;
+        rotateRight(node);
+        fixNode = pivot;
+        break;
+    }
+    case Fix::Compress: {
+        // The right child moves up; the spine continues below it
+        TreeNode *pivot = node->right;
+        rotateLeft(node);
+        --passLeft;
+        // A finished pass leaves the next one to start from the root
+        fixNode = passLeft > 0 ? pivot->right : rootNode;
+        break;
+    }
+    }
+    findNextRotation();
+}
+
+void BSTEngine::finishRebalance()
+{
+    while (fixNode) rebalanceStep();
+}
+
+void BSTEngine::rebalanceInPlace(bool rebalance)
+{
+    finishRebalance();
+    if (balance != BalanceMode::None || !rootNode) return;
+
+    fix = Fix::Vine;
+    fixNode = rootNode;
+    findNextRotation();
+    if (rebalance) finishRebalance();
+}
+
+void BSTEngine::setBalanceMode(BalanceMode mode)
+{
+    if (mode == balance) return;
+    finishRebalance();
+    balance = mode;
+    if (mode == BalanceMode::None || !rootNode) return;
+
+    // The nodes stay; only their links are rebuilt
+    std::vector<TreeNode*> sorted;
+    sorted.reserve(nodeCount);
+    TreeCursor<TreeNode> walk = cursor(TraversalOrder::InOrder);
+    while (TreeNode *node = walk.next()) sorted.push_back(node);
+
+    if (mode == BalanceMode::AVL) relinkBalanced(sorted);
+    else relinkTreap(sorted);
+    emitEvent({EngineEvent::BulkLoaded, nodeCount});
+}
+
+void BSTEngine::relinkBalanced(std::vector<TreeNode*> &sorted)
+{
+    rootNode = linkBalanced(sorted, 0, static_cast<int>(sorted.size()) - 1, nullptr);
+}
+
+void BSTEngine::relinkTreap(std::vector<TreeNode*> &sorted)
+{
+    // Cartesian tree in one pass: each key pops the right spine entries of
+    // lower priority, which become its left subtree
+    std::vector<TreeNode*> spine;
+    for (TreeNode *node : sorted) {
+        TreeNode *below = nullptr;
+        while (!spine.empty() && priorityOf(spine.back()->value) < priorityOf(node->value)) {
+            below = spine.back();
+            spine.pop_back();
+        }
+        node->left = below;
+        node->right = nullptr;
+        if (below) below->parentNode = node;
+        node->parentNode = spine.empty() ? nullptr : spine.back();
+        if (!spine.empty()) spine.back()->right = node;
+        spine.push_back(node);
+    }
+    rootNode = spine.front();
+}
+
+bool BSTEngine::updateHeight(TreeNode *node)
+{
+    const int height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+    const bool changed = height != node->height;
+    node->height = static_cast<std::uint8_t>(height);
+    return changed;
+}
+
+std::uint32_t BSTEngine::priorityOf(int value)
+{
+    // MurmurHash3's finaliser: a bijection, so no two keys tie, and the
+    // shape does not depend on the order keys arrive in
+    std::uint32_t hash = static_cast<std::uint32_t>(value);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+int BSTEngine::height() const
+{
+    return balance == BalanceMode::AVL ? heightOf(rootNode) : getTreeHeight(rootNode);
+}
+
+TreeNode* BSTEngine::findMin(TreeNode* node)
+{
+    while (node && node->left) {
+        node = node->left;
+    }
+    return node;
+}
+
+int BSTEngine::getTreeHeight(TreeNode *node)
+{
+    // Deepest level reached by a preorder walk; the depth follows the
+    // climbs, so a degenerate tree costs no recursion
+    int height = 0;
+    int depth = 0;
+    TreeCursor<TreeNode> walk(node, nullptr, TraversalOrder::PreOrder);
+    TreeNode *previous = nullptr;
+    while (TreeNode *current = walk.next()) {
+        if (previous) {
+            // Preorder goes to a child of previous or of one of its ancestors
+            for (TreeNode *up = previous; up != current->parentNode; up = up->parentNode) --depth;
+        }
+        ++depth;
+        height = std::max(height, depth);
+        previous = current;
+    }
+    return height;
+}
+
+std::vector<TreeNode*> BSTEngine::breadthFirstOrder() const
+{
+    std::vector<TreeNode*> order;
+    order.reserve(nodeCount);
+    BSTPolicy policy;
+    PolicyTraversal::breadthFirst(policy, rootNode, [&](TreeNode *node) { order.push_back(node); });
+    return order;
+}
+
+std::vector<TreeNode*> BSTEngine::depthFirstOrder() const
+{
+    std::vector<TreeNode*> order;
+    order.reserve(nodeCount);
+    BSTPolicy policy;
+    PolicyTraversal::depthFirst(policy, rootNode, [&](TreeNode *node) { order.push_back(node); });
+    return order;
+}
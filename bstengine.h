@@ -0,0 +1,118 @@
+#ifndef BSTENGINE_H
+#define BSTENGINE_H
+
+#include "engineobserver.h"
+#include "nodearena.h"
+#include "treetraversal.h"
+#include "traversalpolicy.h"
+
+#include <cstdint>
+#include <vector>
+
+// Tree Node structure - drawing state lives in the lab (nodevisual.h)
+struct TreeNode {
+    int value;
+    std::uint8_t height;   // AVL mode: levels in this subtree, 1 for a leaf
+    TreeNode *left;
+    TreeNode *right;
+    TreeNode *parentNode;  // nullptr at the root; lets traversals climb
+
+    TreeNode(int val) : value(val), height(1), left(nullptr), right(nullptr), parentNode(nullptr) {}
+
+    TreeNode* parent() const { return parentNode; }
+};
+
+using BSTPolicy = BinaryTreePolicy<TreeNode>;  // For PolicyTraversal
+
+// How the tree keeps its height down. None is the textbook BST, which
+// sorted input turns into a list. AVL keeps every node's subtrees within
+// one level of each other (height <= 1.44 log2 n). Treap keeps the tree a
+// heap on a priority hashed from each key, which makes its shape that of
+// a random BST (expected height ~3 log2 n) whatever the insertion order.
+enum class BalanceMode { None, AVL, Treap };
+
+// Headless Binary Search Tree - the algorithms behind the BST lab,
+// without widgets or timers, so operations can run at full speed.
+class BSTEngine : public ObservableEngine
+{
+public:
+    BSTEngine() = default;
+
+    // With rebalance false, insert and remove leave the tree's rebalancing
+    // pending: rebalanceStep() then does one rotation per call, so the lab
+    // can show each one. Other calls must wait until none is pending.
+    bool insert(int value, TreeNode **inserted = nullptr, bool rebalance = true);
+    TreeNode* search(int value) const;
+    // Nodes compared on the way down: ends at value, or at the node it
+    // would hang from when absent. Animations play one frame per entry.
+    std::vector<TreeNode*> searchPath(int value) const;
+    bool remove(int value, bool rebalance = true);
+    void clear();
+
+    bool isRebalancePending() const { return fixNode != nullptr; }
+    void rebalanceStep();  // One rotation (or a treap's final unlink)
+
+    // Day-Stout-Warren: right rotations flatten a plain BST into a vine
+    // (a sorted right spine), left rotations in halving passes compress it
+    // into a complete tree. O(n) time, O(1) space, no allocation; steps
+    // one rotation at a time like insert when rebalance is false. AVL and
+    // treap trees keep their own shape, so only BalanceMode::None runs it.
+    void rebalanceInPlace(bool rebalance = true);
+
+    // Switching to AVL or Treap relinks the current nodes into a valid
+    // tree of that kind in O(n), reported as BulkLoaded; None keeps the shape
+    void setBalanceMode(BalanceMode mode);
+    BalanceMode balanceMode() const { return balance; }
+
+    TreeNode* root() const { return rootNode; }
+    int size() const { return nodeCount; }
+    int height() const;
+    const NodeArenaStats &allocationStats() const { return nodes.stats(); }
+
+    // Traversals - cursor() walks lazily, allocating only for a level
+    // order frontier; the *Order functions collect a whole walk for
+    // callers that want a list
+    TreeCursor<TreeNode> cursor(TraversalOrder order) const { return {rootNode, nullptr, order}; }
+    std::vector<TreeNode*> breadthFirstOrder() const;
+    std::vector<TreeNode*> depthFirstOrder() const;  // Preorder
+
+private:
+    // Rebalancing still owed after an insert or remove
+    enum class Fix {
+        HeightsUp,    // AVL: refresh heights from fixNode up, rotate where unbalanced
+        PriorityUp,   // Treap: rotate fixNode above parents of lower priority
+        PriorityDown, // Treap: rotate fixNode below its children, then unlink it
+        Vine,         // DSW: rotate left children above fixNode down the right spine
+        Compress      // DSW: rotate every other spine node left, passLeft more this pass
+    };
+
+    void replaceChild(TreeNode *parent, TreeNode *oldChild, TreeNode *newChild);
+    void unlink(TreeNode *node);  // node has at most one child
+    void rotateLeft(TreeNode *node);
+    void rotateRight(TreeNode *node);
+    void findNextRotation();
+    void finishRebalance();
+    void relinkBalanced(std::vector<TreeNode*> &sorted);
+    void relinkTreap(std::vector<TreeNode*> &sorted);
+
+    static int heightOf(const TreeNode *node) { return node ? node->height : 0; }
+    static int balanceOf(const TreeNode *node) { return heightOf(node->left) - heightOf(node->right); }
+    static bool updateHeight(TreeNode *node);  // True if it changed
+    static std::uint32_t priorityOf(int value);
+    static TreeNode* findMin(TreeNode* node);
+    static int getTreeHeight(TreeNode *node);
+
+    NodeArena<TreeNode> nodes;  // Owns every node
+    TreeNode *rootNode = nullptr;
+    int nodeCount = 0;
+    BalanceMode balance = BalanceMode::None;
+    TreeNode *fixNode = nullptr;  // Where pending rebalancing resumes
+    Fix fix = Fix::HeightsUp;
+    int passLeft = 0;  // DSW compression: rotations left in this pass
+    int passSize = 0;  // DSW compression: nodes the next pass halves
+
+    BSTEngine(const BSTEngine&) = delete;
+    BSTEngine& operator=(const BSTEngine&) = delete;
+};
+
+#endif // BSTENGINE_H
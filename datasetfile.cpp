@@ -0,0 +1,65 @@
+#include "datasetfile.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+
+bool loadKeyDataset(const QString &path, KeyDataset &dataset, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    // QByteArray data is always null-terminated, which strtoll relies on
+    const QByteArray contents = file.readAll();
+    const char *cursor = contents.constData();
+    const char *end = cursor + contents.size();
+
+    std::vector<int> keys;
+    keys.reserve(static_cast<std::size_t>(contents.size() / 8));
+    int lineNumber = 1;
+
+    while (cursor < end) {
+        const char c = *cursor;
+        if (c == '\n') {
+            ++lineNumber;
+            ++cursor;
+        } else if (c == '#') {
+            while (cursor < end && *cursor != '\n') ++cursor;
+        } else if (c == ',' || std::isspace(static_cast<unsigned char>(c))) {
+            ++cursor;
+        } else {
+            char *tokenEnd = nullptr;
+            errno = 0;
+            const long long value = std::strtoll(cursor, &tokenEnd, 10);
+            const bool delimited = tokenEnd < end && (*tokenEnd == ',' || *tokenEnd == '#'
+                                                      || std::isspace(static_cast<unsigned char>(*tokenEnd)));
+            if (tokenEnd == cursor || errno == ERANGE || value < INT_MIN || value > INT_MAX
+                || (tokenEnd != end && !delimited)) {
+                if (error) *error = QString("Line %1: not an integer key").arg(lineNumber);
+                return false;
+            }
+            keys.push_back(static_cast<int>(value));
+            cursor = tokenEnd;
+        }
+    }
+
+    dataset.wasSorted = std::adjacent_find(keys.begin(), keys.end(),
+                                           [](int a, int b) { return a >= b; }) == keys.end();
+    dataset.duplicates = 0;
+    if (!dataset.wasSorted) {
+        std::sort(keys.begin(), keys.end());
+        const auto last = std::unique(keys.begin(), keys.end());
+        dataset.duplicates = static_cast<int>(keys.end() - last);
+        keys.erase(last, keys.end());
+    }
+    dataset.keys = std::move(keys);
+    return true;
+}
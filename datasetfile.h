@@ -0,0 +1,20 @@
+#ifndef DATASETFILE_H
+#define DATASETFILE_H
+
+#include <QString>
+
+#include <vector>
+
+// A key set for bulk loading a tree. On disk: integers separated by
+// whitespace or commas; '#' comments out the rest of a line.
+struct KeyDataset {
+    std::vector<int> keys;  // Strictly increasing once loaded
+    bool wasSorted = true;  // The file was already strictly increasing
+    int duplicates = 0;     // Repeated keys dropped while loading
+};
+
+// Reads and normalises a key file. Unsorted input is sorted (O(n log n));
+// sorted input - the common case - is checked in one pass.
+bool loadKeyDataset(const QString &path, KeyDataset &dataset, QString *error = nullptr);
+
+#endif // DATASETFILE_H
@@ -0,0 +1,72 @@
+#ifndef ENGINEOBSERVER_H
+#define ENGINEOBSERVER_H
+
+#include <algorithm>
+#include <vector>
+
+// One fine-grained change reported by an engine. Views apply it directly
+// instead of re-reading the whole structure.
+struct EngineEvent {
+    enum Type {
+        NodeInserted,   // first = value
+        NodeRemoved,    // first = value
+        Rotated,        // first = value of the pivot, second = value of its replacement
+        Recolored,      // first = value, second = new Color
+        VertexAdded,    // first = id
+        VertexRemoved,  // first = id (its edges go with it, no EdgeRemoved is sent)
+        EdgeAdded,      // first, second = endpoints
+        EdgeRemoved,    // first, second = endpoints
+        BucketChanged,  // first = bucket index
+        Rehashed,       // first = old bucket count, second = new bucket count
+        Cleared,        // everything is gone
+        BulkLoaded      // first = size; the shape was rebuilt in one go (after Cleared if the keys changed)
+    };
+
+    Type type;
+    int first = -1;
+    int second = -1;
+
+    EngineEvent(Type type, int first = -1, int second = -1)
+        : type(type), first(first), second(second) {}
+};
+
+// Implemented by views that mirror a headless engine (a lab widget, a test
+// harness...). Engines never know what is listening.
+class EngineObserver
+{
+public:
+    virtual ~EngineObserver() = default;
+
+    virtual void onEngineEvent(const EngineEvent &event) = 0;
+};
+
+// Observer list shared by BSTEngine, RBTreeEngine, GraphEngine and HashMap.
+// Observers are not owned and must detach before they are destroyed.
+class ObservableEngine
+{
+public:
+    void addObserver(EngineObserver *observer)
+    {
+        if (std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+            observers.push_back(observer);
+        }
+    }
+
+    void removeObserver(EngineObserver *observer)
+    {
+        observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+    }
+
+protected:
+    void emitEvent(const EngineEvent &event) const
+    {
+        for (EngineObserver *observer : observers) {
+            observer->onEngineEvent(event);
+        }
+    }
+
+private:
+    std::vector<EngineObserver*> observers;
+};
+
+#endif // ENGINEOBSERVER_H
@@ -0,0 +1,102 @@
+#include "graphengine.h"
+
+#include <algorithm>
+
+bool GraphEngine::addVertex(int id)
+{
+    if (hasVertex(id)) return false;
+    adjacency.emplace(id, std::unordered_set<int>());
+    vertexOrder.push_back(id);
+    if (id >= nextId) nextId = id + 1;
+    emitEvent({EngineEvent::VertexAdded, id});
+    return true;
+}
+
+int GraphEngine::addVertex()
+{
+    const int id = nextVertexId();
+    addVertex(id);
+    return id;
+}
+
+int GraphEngine::nextVertexId() const
+{
+    int id = nextId;
+    while (hasVertex(id)) ++id;
+    return id;
+}
+
+bool GraphEngine::removeVertex(int id)
+{
+    auto it = adjacency.find(id);
+    if (it == adjacency.end()) return false;
+
+    // remove edges
+    for (int v : it->second) {
+        adjacency[v].erase(id);
+        --edges;
+    }
+    adjacency.erase(it);
+    vertexOrder.erase(std::find(vertexOrder.begin(), vertexOrder.end(), id));
+    emitEvent({EngineEvent::VertexRemoved, id});
+    return true;
+}
+
+bool GraphEngine::addEdge(int u, int v)
+{
+    if (u == v || !hasVertex(u) || !hasVertex(v)) return false;
+    if (!adjacency[u].insert(v).second) return false;
+    adjacency[v].insert(u);
+    ++edges;
+    emitEvent({EngineEvent::EdgeAdded, u, v});
+    return true;
+}
+
+bool GraphEngine::removeEdge(int u, int v)
+{
+    if (!hasVertex(u) || !hasVertex(v)) return false;
+    if (adjacency[u].erase(v) == 0) return false;
+    adjacency[v].erase(u);
+    --edges;
+    emitEvent({EngineEvent::EdgeRemoved, u, v});
+    return true;
+}
+
+void GraphEngine::clear()
+{
+    vertexOrder.clear();
+    adjacency.clear();
+    nextId = 0;
+    edges = 0;
+    emitEvent(EngineEvent::Cleared);
+}
+
+bool GraphEngine::hasEdge(int u, int v) const
+{
+    auto it = adjacency.find(u);
+    return it != adjacency.end() && it->second.count(v) != 0;
+}
+
+const std::unordered_set<int>& GraphEngine::neighbors(int id) const
+{
+    static const std::unordered_set<int> none;
+    auto it = adjacency.find(id);
+    return it == adjacency.end() ? none : it->second;
+}
+
+std::vector<int> GraphEngine::breadthFirstOrder(int start) const
+{
+    std::vector<int> order;
+    GraphPolicy policy(*this, GraphPolicy::NeighborOrder::Stored);
+    PolicyTraversal::breadthFirst(policy, start, [&](int u) { order.push_back(u); });
+    return order;
+}
+
+std::vector<int> GraphEngine::depthFirstOrder(int start) const
+{
+    // Smaller ids first, for a stable ordering
+    std::vector<int> order;
+    GraphPolicy policy(*this, GraphPolicy::NeighborOrder::Ascending);
+    PolicyTraversal::depthFirst(policy, start, [&](int u) { order.push_back(u); });
+    return order;
+}
@@ -0,0 +1,78 @@
+#ifndef GRAPHENGINE_H
+#define GRAPHENGINE_H
+
+#include "engineobserver.h"
+#include "traversalpolicy.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Headless undirected, unweighted graph - the adjacency logic behind the
+// Graph lab, without widgets or timers, so operations can run at full speed.
+class GraphEngine : public ObservableEngine
+{
+public:
+    bool addVertex(int id);
+    int addVertex();  // Auto-generated id
+    int nextVertexId() const;  // The id addVertex() would pick
+    bool removeVertex(int id);
+    bool addEdge(int u, int v);
+    bool removeEdge(int u, int v);
+    void clear();
+
+    bool hasVertex(int id) const { return adjacency.count(id) != 0; }
+    bool hasEdge(int u, int v) const;
+    const std::vector<int>& vertices() const { return vertexOrder; }  // Insertion order
+    const std::unordered_set<int>& neighbors(int id) const;
+    int vertexCount() const { return static_cast<int>(vertexOrder.size()); }
+    int edgeCount() const { return edges; }
+
+    // Traversals from a start vertex (DFS visits smaller ids first)
+    std::vector<int> breadthFirstOrder(int start) const;
+    std::vector<int> depthFirstOrder(int start) const;
+
+private:
+    std::vector<int> vertexOrder;
+    std::unordered_map<int, std::unordered_set<int>> adjacency;
+    int nextId = 0;
+    int edges = 0;
+};
+
+// Graph vertices by id. Neighbours come in the adjacency set's order, or
+// by ascending id when the order has to be stable (the DFS).
+class GraphPolicy
+{
+public:
+    using Node = int;
+    enum class NeighborOrder { Stored, Ascending };
+
+    GraphPolicy(const GraphEngine &graph, NeighborOrder order) : graph(graph), order(order) {}
+
+    bool isAbsent(Node id) const { return !graph.hasVertex(id); }
+    static int key(Node id) { return id; }
+
+    template <typename Action>
+    void forEachChild(Node id, Action &&action)
+    {
+        const std::unordered_set<int> &neighbors = graph.neighbors(id);
+        if (order == NeighborOrder::Stored) {
+            for (int v : neighbors) action(v);
+            return;
+        }
+        sorted.assign(neighbors.begin(), neighbors.end());
+        std::sort(sorted.begin(), sorted.end());
+        for (int v : sorted) action(v);
+    }
+
+    bool isVisited(Node id) const { return visited.count(id) != 0; }
+    bool markVisited(Node id) { return visited.insert(id).second; }
+
+private:
+    const GraphEngine &graph;
+    NeighborOrder order;
+    std::unordered_set<int> visited;
+    std::vector<int> sorted;  // Scratch for Ascending, reused per vertex
+};
+
+#endif // GRAPHENGINE_H
@@ -1,5 +1,7 @@
 #include "graphvisualization.h"
 #include "uiutils.h"
+#include "staticlayer.h"
+#include "animationtimeline.h"
 
 // Dedicated canvas widget for drawing the graph
 class GraphVisualization::GraphCanvas : public QWidget
@@ -16,10 +18,35 @@ public:
         )");
     }
 
+    // The vertex set changed: every position may move
+    void invalidateStaticLayer() { staticLayer.invalidate(); }
+    // Only the edges and vertices inside rect changed
+    void invalidateStaticLayer(const QRect &rect) { staticLayer.invalidate(rect); }
+
 protected:
     void paintEvent(QPaintEvent *event) override {
         Q_UNUSED(event);
         QPainter painter(this);
+        staticLayer.draw(painter, this, [&](QPainter &layer) { paintStaticLayer(layer); });
+
+        // Traversal highlights change every frame; draw just those on top.
+        // Only vertices the traversal has reached so far can carry one.
+        painter.setRenderHint(QPainter::Antialiasing);
+        const int reached = qMin(graphViz->traversalIndex, static_cast<int>(graphViz->traversalOrder.size()));
+        for (int i = 0; i < reached; ++i) {
+            const GraphNode *n = graphViz->findNode(graphViz->traversalOrder[i]);
+            if (!n) continue;  // Deleted since the traversal ran
+            const bool highlighted = graphViz->isHighlighted(*n);
+            const bool visited = graphViz->isVisited(*n);
+            if (highlighted || visited) drawNode(painter, *n, highlighted, visited);
+        }
+    }
+
+private:
+    GraphVisualization *graphViz;
+    StaticLayer staticLayer;  // Background, edges and plain vertices
+
+    void paintStaticLayer(QPainter &painter) {
         painter.setRenderHint(QPainter::Antialiasing);
         
         // Clear background
@@ -34,8 +61,10 @@ protected:
             return;
         }
         
-        // Layout nodes within this widget's bounds
-        layoutNodesInCanvas();
+        // Layout nodes within this widget's bounds - only when the whole
+        // layer is redrawn, which a resize or a change of vertices forces;
+        // a clipped repaint of one edge's strip keeps the positions
+        if (!painter.hasClipping()) layoutNodesInCanvas();
         
         // Draw debug info
         painter.setPen(Qt::black);
@@ -55,9 +84,6 @@ protected:
         // Draw graph
         drawGraph(painter);
     }
-
-private:
-    GraphVisualization *graphViz;
     
     void layoutNodesInCanvas() {
         if (graphViz->nodes.isEmpty()) return;
@@ -84,38 +110,43 @@ private:
     void drawGraph(QPainter &painter) {
         if (graphViz->nodes.isEmpty()) return;
 
-        // Draw edges first
-        for (auto it = graphViz->adjacency.constBegin(); it != graphViz->adjacency.constEnd(); ++it) {
-            int u = it.key();
-            for (int v : it.value()) {
-                if (u < v) {
-                    const GraphNode *nu = nullptr, *nv = nullptr;
-                    for (const auto &n : graphViz->nodes) {
-                        if (n.id == u) nu = &n;
-                        if (n.id == v) nv = &n;
-                    }
-                    if (nu && nv) {
-                        painter.setPen(QPen(QColor(75, 0, 130), 3));
-                        painter.drawLine(nu->pos, nv->pos);
-                    }
+        // Draw edges first - one position lookup table instead of a scan per edge
+        QHash<int, QPointF> positions;
+        positions.reserve(graphViz->nodes.size());
+        for (const auto &n : graphViz->nodes) positions.insert(n.id, n.pos);
+
+        // A clipped repaint draws only what crosses the clip: a bounds test
+        // per edge and vertex, no rasterising of the rest of the graph
+        const QRectF clip = painter.hasClipping() ? painter.clipBoundingRect() : QRectF(rect());
+        const qreal reach = graphViz->NODE_RADIUS + 4;
+
+        painter.setPen(QPen(QColor(75, 0, 130), 3));
+        for (int u : graphViz->graph.vertices()) {
+            for (int v : graphViz->graph.neighbors(u)) {
+                if (u < v && positions.contains(u) && positions.contains(v)) {
+                    const QPointF from = positions.value(u);
+                    const QPointF to = positions.value(v);
+                    if (!QRectF(from, to).normalized().adjusted(-2, -2, 2, 2).intersects(clip)) continue;
+                    painter.drawLine(from, to);
                 }
             }
         }
 
-        // Draw nodes on top
+        // Draw nodes on top, plain; paintEvent() overlays the highlighted ones
         for (const auto &n : graphViz->nodes) {
-            drawNode(painter, n);
+            if (!QRectF(n.pos.x() - reach, n.pos.y() - reach, 2 * reach, 2 * reach).intersects(clip)) continue;
+            drawNode(painter, n, false, false);
         }
     }
     
-    void drawNode(QPainter &painter, const GraphNode &node) {
+    void drawNode(QPainter &painter, const GraphNode &node, bool highlighted, bool visited) {
         const int NODE_RADIUS = 24;
         
         // Set colors similar to tree nodes
-        if (node.highlighted) {
+        if (highlighted) {
             painter.setPen(QPen(QColor(255, 140, 0), 4));  // Orange border for highlighted
             painter.setBrush(QColor(255, 165, 0));         // Orange fill
-        } else if (node.visited) {
+        } else if (visited) {
             painter.setPen(QPen(QColor(34, 139, 34), 4));  // Green border for visited
             painter.setBrush(QColor(50, 205, 50));         // Green fill
         } else {
@@ -141,10 +172,10 @@ GraphVisualization::GraphVisualization(QWidget *parent)
     , traversalType(TraversalType::None)
     , traversalIndex(0)
     , animTimer(new QTimer(this))
-    , nextId(0)
 {
     setupUI();
     setMinimumSize(900, 750);
+    graph.addObserver(this);
 
     connect(animTimer, &QTimer::timeout, this, &GraphVisualization::onAnimationStep);
 }
@@ -156,9 +187,8 @@ GraphVisualization::~GraphVisualization()
         animTimer->stop();
     }
     
-    // Clear nodes and adjacency data
+    graph.removeObserver(this);
     nodes.clear();
-    adjacency.clear();
     traversalOrder.clear();
 }
 
@@ -413,6 +443,7 @@ void GraphVisualization::setupRightPanel()
 
     setupStepTrace();
     setupTraversalControls();
+    setupSessionControls();
 }
 
 void GraphVisualization::setupStepTrace()
@@ -570,6 +601,70 @@ void GraphVisualization::setupTraversalControls()
     connect(dfsButton, &QPushButton::clicked, this, &GraphVisualization::onStartDFS);
 }
 
+void GraphVisualization::setupSessionControls()
+{
+    sessionControls = new SessionControls(this);
+    rightLayout->addWidget(sessionControls, 0);
+}
+
+bool GraphVisualization::isReplayBusy() const
+{
+    return animTimer->isActive();
+}
+
+void GraphVisualization::onEngineEvent(const EngineEvent &event)
+{
+    if (!canvas) return;
+
+    if (event.type == EngineEvent::EdgeAdded || event.type == EngineEvent::EdgeRemoved) {
+        // Vertices stay where they are - redraw only the strip under the
+        // edge, in the cached layer as well as on screen
+        const GraphNode *from = findNode(event.first);
+        const GraphNode *to = findNode(event.second);
+        if (from && to) {
+            QPolygonF endpoints;
+            endpoints << from->pos << to->pos;
+            const int margin = NODE_RADIUS + 4;
+            const QRect strip = endpoints.boundingRect().adjusted(-margin, -margin, margin, margin).toAlignedRect();
+            canvas->invalidateStaticLayer(strip);
+            canvas->update(strip);
+            return;
+        }
+    }
+
+    // Adding or removing a vertex re-flows the circular layout
+    canvas->invalidateStaticLayer();
+    canvas->update();
+}
+
+bool GraphVisualization::replayOperation(const LoggedOperation &operation)
+{
+    // Go through the inputs exactly like a click would
+    const QString &op = operation.op;
+    const QStringList &args = operation.args;
+    if (op == "addVertex") {
+        vertexInput->setText(args.value(0));
+        onAddVertexClicked();
+    } else if (op == "deleteVertex" && args.size() >= 1) {
+        vertexInput->setText(args.at(0));
+        onDeleteVertexClicked();
+    } else if ((op == "addEdge" || op == "deleteEdge") && args.size() >= 2) {
+        edgeFromInput->setText(args.at(0));
+        edgeToInput->setText(args.at(1));
+        if (op == "addEdge") onAddEdgeClicked();
+        else onDeleteEdgeClicked();
+    } else if (op == "clear") {
+        onClearClicked();
+    } else if (op == "bfs") {
+        onStartBFS();
+    } else if (op == "dfs") {
+        onStartDFS();
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void GraphVisualization::addStepToHistory(const QString &step)
 {
     stepHistory.append(step);
@@ -584,9 +679,11 @@ void GraphVisualization::addOperationSeparator()
 
 void GraphVisualization::updateStepTrace()
 {
-    stepsList->clear();
-    
-    for (const QString &step : stepHistory) {
+    // Only append steps added since the last refresh; clearing the history clears the list
+    if (stepHistory.size() < stepsList->count()) stepsList->clear();
+
+    for (int i = stepsList->count(); i < stepHistory.size(); ++i) {
+        const QString &step = stepHistory[i];
         QListWidgetItem *item = new QListWidgetItem(step);
         
         if (step == "────────────────────") {
@@ -936,24 +1033,23 @@ void GraphVisualization::onAddVertexClicked()
         }
         addStepToHistory(QString("🔍 Checking if vertex %1 already exists...").arg(id));
         // Check if ID already exists
-        for (const auto &n : nodes) {
-            if (n.id == id) {
-                addStepToHistory(QString("❌ Vertex %1 already exists in the graph").arg(id));
-                QMessageBox::warning(this, "Duplicate ID", QString("Vertex %1 already exists.").arg(id));
-                return;
-            }
+        if (graph.hasVertex(id)) {
+            addStepToHistory(QString("❌ Vertex %1 already exists in the graph").arg(id));
+            QMessageBox::warning(this, "Duplicate ID", QString("Vertex %1 already exists.").arg(id));
+            return;
         }
         addStepToHistory(QString("✅ Vertex %1 is unique, proceeding with addition").arg(id));
     } else {
         // Auto-generate ID
-        id = nextId++;
+        id = graph.nextVertexId();
         addStepToHistory(QString("🆕 Auto-generating vertex ID: %1").arg(id));
     }
     
+    OperationRecorder::instance().record(LoggedOperation::Graph, "addVertex", {QString::number(id)});
     addStepToHistory(QString("➕ Creating new vertex %1 in adjacency list").arg(id));
+    nodeSlots.insert(id, nodes.size());
     nodes.append(GraphNode(id, QPointF(0, 0)));
-    adjacency.insert(id, QSet<int>());
-    if (id >= nextId) nextId = id + 1;
+    graph.addVertex(id);
     
     addStepToHistory("🔄 Recalculating graph layout...");
     refreshCombos();
@@ -987,18 +1083,11 @@ void GraphVisualization::onDeleteVertexClicked()
         return;
     }
     
+    OperationRecorder::instance().record(LoggedOperation::Graph, "deleteVertex", {QString::number(id)});
     addStepToHistory(QString("🔍 Searching for vertex %1 in the graph...").arg(id));
     
     // Check if vertex exists
-    bool found = false;
-    for (const auto &n : nodes) {
-        if (n.id == id) {
-            found = true;
-            break;
-        }
-    }
-    
-    if (!found) {
+    if (!graph.hasVertex(id)) {
         addStepToHistory(QString("❌ Vertex %1 not found in the graph").arg(id));
         QMessageBox::warning(this, "Vertex Not Found", QString("Vertex %1 does not exist.").arg(id));
         return;
@@ -1040,6 +1129,8 @@ void GraphVisualization::onAddEdgeClicked()
         return;
     }
     
+    OperationRecorder::instance().record(LoggedOperation::Graph, "addEdge", {QString::number(u), QString::number(v)});
+
     if (u == v) {
         addStepToHistory("❌ Self-loops are not allowed in this graph");
         QMessageBox::warning(this, "Invalid", "Self-loops are not allowed.");
@@ -1086,6 +1177,7 @@ void GraphVisualization::onDeleteEdgeClicked()
         return;
     }
     
+    OperationRecorder::instance().record(LoggedOperation::Graph, "deleteEdge", {QString::number(u), QString::number(v)});
     addStepToHistory(QString("🔍 Attempting to remove edge between vertex %1 and vertex %2").arg(u).arg(v));
     
     if (removeEdgeInternal(u, v)) {
@@ -1110,9 +1202,10 @@ void GraphVisualization::onRemoveEdgeClicked()
 
 void GraphVisualization::onClearClicked()
 {
+    OperationRecorder::instance().record(LoggedOperation::Graph, "clear");
     nodes.clear();
-    adjacency.clear();
-    nextId = 0;
+    nodeSlots.clear();
+    graph.clear();
     traversalType = TraversalType::None;
     frontier.clear();
     traversalOrder.clear();
@@ -1179,6 +1272,8 @@ void GraphVisualization::onStartBFS()
         return;
     }
     
+    OperationRecorder::instance().record(LoggedOperation::Graph, "bfs");
+
     // Use the first vertex as starting point
     int s = nodes.first().id;
     
@@ -1189,28 +1284,18 @@ void GraphVisualization::onStartBFS()
     frontier.clear();
     traversalIndex = 0;
 
-    // BFS precompute order
+    // BFS precompute order - the engines' shared search, narrated through its hooks
     addStepToHistory("🔄 Initializing BFS queue and visited set");
-    QSet<int> visited;
-    QList<int> queue;
-    queue.append(s);
-    visited.insert(s);
     addStepToHistory(QString("➕ Added vertex %1 to queue and marked as visited").arg(s));
-    
-    while (!queue.isEmpty()) {
-        int u = queue.front();
-        queue.pop_front();
-        traversalOrder.append(u);
-        addStepToHistory(QString("👀 Processing vertex %1 (dequeued from front)").arg(u));
-        
-        for (int v : adjacency.value(u)) {
-            if (!visited.contains(v)) {
-                visited.insert(v);
-                queue.append(v);
-                addStepToHistory(QString("🆕 Found unvisited neighbor %1, added to queue").arg(v));
-            }
-        }
-    }
+    GraphPolicy policy(graph, GraphPolicy::NeighborOrder::Stored);
+    PolicyTraversal::breadthFirst(policy, s,
+        [this](int u) {
+            traversalOrder.append(u);
+            addStepToHistory(QString("👀 Processing vertex %1 (dequeued from front)").arg(u));
+        },
+        [this](int v) {
+            addStepToHistory(QString("🆕 Found unvisited neighbor %1, added to queue").arg(v));
+        });
 
     // Display traversal result
     QString result = "🌊 BFS Order: ";
@@ -1229,7 +1314,7 @@ void GraphVisualization::onStartBFS()
     }
 
     setControlsEnabled(false);
-    animTimer->start(700);
+    animTimer->start(AnimationTimeline::scaled(700));
     statusLabel->setText("Running BFS...");
     addStepToHistory("✅ BFS traversal order computed, starting animation");
     addOperationSeparator();
@@ -1245,6 +1330,8 @@ void GraphVisualization::onStartDFS()
         return;
     }
     
+    OperationRecorder::instance().record(LoggedOperation::Graph, "dfs");
+
     // Use the first vertex as starting point
     int s = nodes.first().id;
     
@@ -1255,33 +1342,21 @@ void GraphVisualization::onStartDFS()
     frontier.clear();
     traversalIndex = 0;
 
-    // DFS precompute order
+    // DFS precompute order - smaller ids first, so the order is stable
     addStepToHistory("🔄 Initializing DFS stack and visited set");
-    QSet<int> visited;
-    QList<int> stack;
-    stack.append(s);
     addStepToHistory(QString("➕ Added vertex %1 to stack").arg(s));
-    
-    while (!stack.isEmpty()) {
-        int u = stack.takeLast();
-        if (visited.contains(u)) {
+    GraphPolicy policy(graph, GraphPolicy::NeighborOrder::Ascending);
+    PolicyTraversal::depthFirst(policy, s,
+        [this](int u) {
+            traversalOrder.append(u);
+            addStepToHistory(QString("👀 Processing vertex %1 (popped from stack)").arg(u));
+        },
+        [this](int v) {
+            addStepToHistory(QString("🆕 Found unvisited neighbor %1, pushed to stack").arg(v));
+        },
+        [this](int u) {
             addStepToHistory(QString("⚠️ Vertex %1 already visited, skipping").arg(u));
-            continue;
-        }
-        visited.insert(u);
-        traversalOrder.append(u);
-        addStepToHistory(QString("👀 Processing vertex %1 (popped from stack)").arg(u));
-        
-        // push neighbors in reverse for a stable ordering
-        QList<int> neigh = adjacency.value(u).values();
-        std::sort(neigh.begin(), neigh.end(), std::greater<int>());
-        for (int v : neigh) {
-            if (!visited.contains(v)) {
-                stack.append(v);
-                addStepToHistory(QString("🆕 Found unvisited neighbor %1, pushed to stack").arg(v));
-            }
-        }
-    }
+        });
 
     // Display traversal result
     QString result = "🏔️ DFS Order: ";
@@ -1300,7 +1375,7 @@ void GraphVisualization::onStartDFS()
     }
 
     setControlsEnabled(false);
-    animTimer->start(700);
+    animTimer->start(AnimationTimeline::scaled(700));
     statusLabel->setText("Running DFS...");
     addStepToHistory("✅ DFS traversal order computed, starting animation");
     addOperationSeparator();
@@ -1311,7 +1386,10 @@ void GraphVisualization::onAnimationStep()
     if (traversalIndex > 0 && traversalIndex <= traversalOrder.size()) {
         int prev = traversalOrder[traversalIndex - 1];
         // Mark previous as visited (persist green), remove highlight
-        for (auto &n : nodes) if (n.id == prev) { n.visited = true; n.highlighted = false; }
+        if (GraphNode *n = findNode(prev)) {
+            n->visitedStamp = highlightEpoch;
+            n->highlightStamp = 0;
+        }
     }
 
     if (traversalIndex >= traversalOrder.size()) {
@@ -1326,7 +1404,7 @@ void GraphVisualization::onAnimationStep()
     }
 
     int u = traversalOrder[traversalIndex];
-    for (auto &n : nodes) if (n.id == u) { n.highlighted = true; }
+    if (GraphNode *n = findNode(u)) n->highlightStamp = highlightEpoch;
     statusLabel->setText(QString("Visiting %1").arg(u));
     traversalIndex++;
     update();
@@ -1336,37 +1414,49 @@ void GraphVisualization::onAnimationStep()
 
 void GraphVisualization::resetHighlights()
 {
-    for (auto &n : nodes) { n.highlighted = false; n.visited = false; }
+    // Every stamp from the previous epoch now reads as cleared - O(1)
+    ++highlightEpoch;
+}
+
+GraphNode *GraphVisualization::findNode(int id)
+{
+    auto slot = nodeSlots.constFind(id);
+    return slot == nodeSlots.cend() ? nullptr : &nodes[*slot];
+}
+
+const GraphNode *GraphVisualization::findNode(int id) const
+{
+    auto slot = nodeSlots.constFind(id);
+    return slot == nodeSlots.cend() ? nullptr : &nodes[*slot];
+}
+
+void GraphVisualization::reindexNodes()
+{
+    nodeSlots.clear();
+    for (int i = 0; i < nodes.size(); ++i) nodeSlots.insert(nodes[i].id, i);
 }
 
 
 bool GraphVisualization::addEdgeInternal(int u, int v)
 {
-    if (!adjacency.contains(u) || !adjacency.contains(v)) return false;
-    if (adjacency[u].contains(v)) return false;
-    adjacency[u].insert(v);
-    adjacency[v].insert(u);
-    return true;
+    return graph.addEdge(u, v);
 }
 
 bool GraphVisualization::removeVertexInternal(int u)
 {
-    if (!adjacency.contains(u)) return false;
-    // remove edges
-    for (int v : adjacency[u]) adjacency[v].remove(u);
-    adjacency.remove(u);
-    // remove node
-    for (int i = 0; i < nodes.size(); ++i) {
-        if (nodes[i].id == u) { nodes.removeAt(i); break; }
+    if (!graph.hasVertex(u)) return false;
+    // remove node; the vertices after it move down one slot
+    auto slot = nodeSlots.constFind(u);
+    if (slot != nodeSlots.cend()) {
+        nodes.removeAt(*slot);
+        reindexNodes();
     }
-    return true;
+    return graph.removeVertex(u);
 }
 
 bool GraphVisualization::removeEdgeInternal(int u, int v)
 {
-    if (!adjacency.contains(u) || !adjacency.contains(v)) return false;
-    bool existed = adjacency[u].remove(v) | adjacency[v].remove(u);
-    return existed;
+    return graph.removeEdge(u, v);
 }
 
 // paintEvent removed - now using dedicated GraphCanvas widget
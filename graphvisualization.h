@@ -32,14 +32,18 @@
 #include "backbutton.h"
 #include "stylemanager.h"
 #include "widgetmanager.h"
+#include "sessioncontrols.h"
+#include "graphengine.h"
 
 struct GraphNode {
     int id;
     QPointF pos;
-    bool highlighted;
-    bool visited;
-    GraphNode() : id(-1), pos(0, 0), highlighted(false), visited(false) {}
-    GraphNode(int nid, const QPointF &p) : id(nid), pos(p), highlighted(false), visited(false) {}
+    // Epochs the vertex was last highlighted / visited in; it shows as such
+    // only while they match GraphVisualization's current highlight epoch
+    quint64 highlightStamp;
+    quint64 visitedStamp;
+    GraphNode() : id(-1), pos(0, 0), highlightStamp(0), visitedStamp(0) {}
+    GraphNode(int nid, const QPointF &p) : id(nid), pos(p), highlightStamp(0), visitedStamp(0) {}
 };
 
 struct GraphHistoryEntry {
@@ -50,7 +54,7 @@ struct GraphHistoryEntry {
     QString timestamp;
 };
 
-class GraphVisualization : public QWidget
+class GraphVisualization : public QWidget, public ReplayTarget, public EngineObserver
 {
     Q_OBJECT
 
@@ -58,6 +62,14 @@ public:
     explicit GraphVisualization(QWidget *parent = nullptr);
     ~GraphVisualization();
 
+    // ReplayTarget
+    LoggedOperation::Lab replayLab() const override { return LoggedOperation::Graph; }
+    bool isReplayBusy() const override;
+    bool replayOperation(const LoggedOperation &operation) override;
+
+    // EngineObserver
+    void onEngineEvent(const EngineEvent &event) override;
+
 signals:
     void backToOperations();
 
@@ -85,11 +97,17 @@ private:
     void setupRightPanel();
     void setupStepTrace();
     void setupTraversalControls();
+    void setupSessionControls();
     void refreshCombos();
     void setControlsEnabled(bool enabled);
 
     // Graph logic
     void resetHighlights();
+    GraphNode *findNode(int id);
+    const GraphNode *findNode(int id) const;
+    void reindexNodes();
+    bool isHighlighted(const GraphNode &n) const { return n.highlightStamp == highlightEpoch; }
+    bool isVisited(const GraphNode &n) const { return n.visitedStamp == highlightEpoch; }
     bool addEdgeInternal(int u, int v);
     bool removeVertexInternal(int u);
     bool removeEdgeInternal(int u, int v);
@@ -149,10 +167,14 @@ private:
     QPushButton *dfsButton;
     QListWidget *traversalResultList;
 
+    // Right panel components - Session record / replay
+    SessionControls *sessionControls;
+
     // Data
-    QVector<GraphNode> nodes;
-    QHash<int, QSet<int>> adjacency; // undirected, unweighted
-    int nextId;
+    QVector<GraphNode> nodes;  // Positions and highlight state, one per engine vertex
+    QHash<int, int> nodeSlots; // Vertex id -> index in nodes
+    quint64 highlightEpoch = 1; // resetHighlights() bumps it instead of visiting every vertex
+    GraphEngine graph;         // undirected, unweighted
     QVector<GraphHistoryEntry> history;
     QVector<QString> stepHistory;
     QString currentOperation;
@@ -1,5 +1,7 @@
 #include "hashmap.h"
+#include "threadpool.h"
 
+#include <QElapsedTimer>
 #include <algorithm>
 #include <cmath>
 #include <functional>
@@ -24,6 +26,42 @@ QString HashMap::dataTypeToString(DataType type) {
     }
 }
 
+bool HashMap::dataTypeFromString(const QString &name, DataType &type) {
+    for (DataType candidate : {STRING, INTEGER, DOUBLE, FLOAT, CHAR}) {
+        if (dataTypeToString(candidate).compare(name, Qt::CaseInsensitive) == 0) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+QVariant HashMap::variantFromString(const QString &str, DataType type) {
+    bool ok;
+    switch (type) {
+    case STRING:
+        return QVariant(str);
+    case INTEGER: {
+        int intVal = str.toInt(&ok);
+        return ok ? QVariant(intVal) : QVariant();
+    }
+    case DOUBLE: {
+        double doubleVal = str.toDouble(&ok);
+        return ok ? QVariant(doubleVal) : QVariant();
+    }
+    case FLOAT: {
+        float floatVal = str.toFloat(&ok);
+        return ok ? QVariant(floatVal) : QVariant();
+    }
+    case CHAR: {
+        if (str.isEmpty()) return QVariant();
+        return QVariant(QChar(str.at(0)));
+    }
+    default:
+        return QVariant();
+    }
+}
+
 QString HashMap::variantToDisplayString(const QVariant &var) {
     if (var.typeId() == QMetaType::QString) {
         return var.toString();
@@ -40,48 +78,8 @@ QString HashMap::variantToDisplayString(const QVariant &var) {
 }
 
 int HashMap::indexFor(const QVariant &key, int bucketCount) const {
-    size_t hashValue = 0;
-
-    // Use std::hash-like behavior to mirror unordered_map hashing
-    switch (key.typeId()) {
-    case QMetaType::QString: {
-        const std::string s = key.toString().toStdString();
-        hashValue = std::hash<std::string>{}(s);
-        break;
-    }
-    case QMetaType::Int: {
-        const int v = key.toInt();
-        hashValue = std::hash<int>{}(v);
-        break;
-    }
-    case QMetaType::Double: {
-        // QVariant stores float as double by default; both map through std::hash<double>
-        const double v = key.toDouble();
-        hashValue = std::hash<double>{}(v);
-        break;
-    }
-    case QMetaType::QChar: {
-        const QChar qc = key.toChar();
-        const char c = qc.toLatin1();
-        hashValue = std::hash<char>{}(c);
-        break;
-    }
-    default: {
-        // Try float explicitly if convertible
-        if (key.canConvert<float>()) {
-            const float v = key.toFloat();
-            hashValue = std::hash<float>{}(v);
-        } else {
-            // Fallback to string representation
-            const std::string s = key.toString().toStdString();
-            hashValue = std::hash<std::string>{}(s);
-        }
-        break;
-    }
-    }
-
     // bucket_index = hash(key) % bucketCount
-    return static_cast<int>(hashValue % static_cast<size_t>(bucketCount));
+    return static_cast<int>(getHashValue(key) % static_cast<size_t>(bucketCount));
 }
 
 size_t HashMap::getHashValue(const QVariant &key) const {
@@ -145,14 +143,28 @@ bool HashMap::validateType(const QVariant &value, DataType expectedType) const {
 }
 
 void HashMap::addStep(const QString &text) {
+    if (!tracing_) return;
     stepHistory_.append(text);
 }
 
+void HashMap::traceHashComputation(const QVariant &key, const QString &keyStr, size_t computedHash,
+                                   int bucketCountNow, int index) {
+    // Show hash calculation with computed hash value
+    if (key.typeId() == QMetaType::Int || key.typeId() == QMetaType::Double) {
+        addStep(QString("📊 Compute hash(%1) = %2").arg(keyStr).arg(computedHash));
+        addStep(QString("📐 Calculate: %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
+    } else {
+        addStep(QString("📊 Compute hash for: \"%1\" = %2").arg(keyStr).arg(computedHash));
+        addStep(QString("📐 Index = %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
+    }
+}
+
 void HashMap::addStepToHistory(const QString &step) {
     stepHistory_.append(step);
 }
 
 void HashMap::clearSteps() {
+    if (!tracing_) return;
     // Don't clear history, just mark a separator
     stepHistory_.append("────────────────────");
 }
@@ -175,8 +187,9 @@ float HashMap::loadFactor() const {
 }
 
 void HashMap::maybeGrow() {
-    // Only rehash once - if we've already rehashed, don't do it again
-    if (hasRehashed_) {
+    // The traced lab table rehashes once so its buckets stay readable;
+    // untraced or large tables keep doubling, reaching the parallel rehash
+    if (hasRehashed_ && tracing_ && numElements_ < parallelRehashThreshold_) {
         return;
     }
     
@@ -184,16 +197,17 @@ void HashMap::maybeGrow() {
     / static_cast<float>(buckets_.empty() ? 1 : buckets_.size());
     if (projected > maxLoadFactor_) {
         const int newCount = std::max(2, bucketCount() * 2);
-        addStep(QStringLiteral("Load factor %.2f exceeds %.2f → rehash to %1 buckets")
-                    .arg(newCount)
+        addStep(QStringLiteral("Load factor %1 exceeds %2 → rehash to %3 buckets")
                     .arg(loadFactor(), 0, 'f', 2)
-                    .arg(maxLoadFactor_, 0, 'f', 2));
+                    .arg(maxLoadFactor_, 0, 'f', 2)
+                    .arg(newCount));
         rehash(newCount);
         hasRehashed_ = true;  // Mark that we've rehashed
     }
 }
 
-bool HashMap::emplaceOrAssign(const QVariant &key, const QVariant &value, bool assignIfExists) {
+bool HashMap::emplaceOrAssign(const QVariant &key, const QVariant &value, bool assignIfExists, int &index) {
+    index = -1;
     // Validate types
     if (!validateType(key, keyType_) || !validateType(value, valueType_)) {
         addStep(QStringLiteral("Type validation failed"));
@@ -202,63 +216,67 @@ bool HashMap::emplaceOrAssign(const QVariant &key, const QVariant &value, bool a
 
     const int bucketCountNow = bucketCount();
 
-    QString keyStr = variantToDisplayString(key);
-    QString valueStr = variantToDisplayString(value);
-
-    // Use our custom indexFor method which shows the simple hash
-    const int index = indexFor(key, bucketCountNow);
+    // Hash once; the value is cached on the node for later rehashes
     const size_t computedHash = getHashValue(key);
+    index = static_cast<int>(computedHash % static_cast<size_t>(bucketCountNow));
 
-    // Show hash calculation with computed hash value
-    if (key.typeId() == QMetaType::Int || key.typeId() == QMetaType::Double) {
-        addStep(QString("📊 Compute hash(%1) = %2").arg(keyStr).arg(computedHash));
-        addStep(QString("📐 Calculate: %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
-    } else {
-        addStep(QString("📊 Compute hash for: \"%1\" = %2").arg(keyStr).arg(computedHash));
-        addStep(QString("📐 Index = %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
+    const QString keyStr = tracing_ ? variantToDisplayString(key) : QString();
+    if (tracing_) {
+        traceHashComputation(key, keyStr, computedHash, bucketCountNow, index);
+        addStep(QStringLiteral("Visit bucket %1").arg(index));
     }
-    addStep(QStringLiteral("Visit bucket %1").arg(index));
 
     auto &chain = buckets_[static_cast<size_t>(index)];
     for (auto &node : chain) {
-        QString nodeKeyStr = variantToDisplayString(node.key);
-        addStep(QStringLiteral("Compare keys: %1 == %2 ? %3")
-                    .arg(nodeKeyStr, keyStr, node.key == key ? QStringLiteral("Yes") : QStringLiteral("No")));
-        if (node.key == key) {
+        const bool match = node.hash == computedHash && node.key == key;
+        if (tracing_) {
+            addStep(QStringLiteral("Compare keys: %1 == %2 ? %3")
+                        .arg(variantToDisplayString(node.key), keyStr, match ? QStringLiteral("Yes") : QStringLiteral("No")));
+        }
+        if (match) {
             if (assignIfExists) {
-                QString oldValueStr = variantToDisplayString(node.value);
-                addStep(QStringLiteral("Key exists → update value: %1 → %2").arg(oldValueStr, valueStr));
+                if (tracing_) {
+                    addStep(QStringLiteral("Key exists → update value: %1 → %2")
+                                .arg(variantToDisplayString(node.value), variantToDisplayString(value)));
+                }
                 node.value = value;
             } else {
                 addStep(QStringLiteral("Key exists → no insert (duplicate)"));
+                index = -1;  // Bucket untouched
             }
             return false; // not a new insertion
         }
         addStep(QStringLiteral("Traverse next in chain"));
     }
 
-    addStep(QStringLiteral("Append new node to bucket %1").arg(index));
-    chain.push_front(Node{key, value});
+    if (tracing_) addStep(QStringLiteral("Append new node to bucket %1").arg(index));
+    chain.push_front(Node{key, value, computedHash});
     ++numElements_;
-    addStep(QStringLiteral("New size = %1, load factor = %2")
-                .arg(numElements_)
-                .arg(loadFactor(), 0, 'f', 2));
+    if (tracing_) {
+        addStep(QStringLiteral("New size = %1, load factor = %2")
+                    .arg(numElements_)
+                    .arg(loadFactor(), 0, 'f', 2));
+    }
     return true;
 }
 
 bool HashMap::insert(const QVariant &key, const QVariant &value) {
     addStep(QStringLiteral("➕ INSERT OPERATION"));
     maybeGrow();
-    bool result = emplaceOrAssign(key, value, /*assignIfExists=*/false);
+    int index;
+    bool result = emplaceOrAssign(key, value, /*assignIfExists=*/false, index);
     clearSteps();
+    if (result) emitEvent({EngineEvent::BucketChanged, index});
     return result;
 }
 
 void HashMap::put(const QVariant &key, const QVariant &value) {
     addStep(QStringLiteral("➕ PUT OPERATION"));
     maybeGrow();
-    (void)emplaceOrAssign(key, value, /*assignIfExists=*/true);
+    int index;
+    (void)emplaceOrAssign(key, value, /*assignIfExists=*/true, index);
     clearSteps();
+    if (index >= 0) emitEvent({EngineEvent::BucketChanged, index});
 }
 
 std::optional<QVariant> HashMap::get(const QVariant &key) {
@@ -271,30 +289,24 @@ std::optional<QVariant> HashMap::get(const QVariant &key) {
 
     const int bucketCountNow = bucketCount();
 
-    QString keyStr = variantToDisplayString(key);
-
-    // Use our custom indexFor method
-    const int index = indexFor(key, bucketCountNow);
     const size_t computedHash = getHashValue(key);
+    const int index = static_cast<int>(computedHash % static_cast<size_t>(bucketCountNow));
 
-    // Show hash calculation with computed hash value
-    if (key.typeId() == QMetaType::Int || key.typeId() == QMetaType::Double) {
-        addStep(QString("📊 Compute hash(%1) = %2").arg(keyStr).arg(computedHash));
-        addStep(QString("📐 Calculate: %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
-    } else {
-        addStep(QString("📊 Compute hash for: \"%1\" = %2").arg(keyStr).arg(computedHash));
-        addStep(QString("📐 Index = %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
+    const QString keyStr = tracing_ ? variantToDisplayString(key) : QString();
+    if (tracing_) {
+        traceHashComputation(key, keyStr, computedHash, bucketCountNow, index);
+        addStep(QString("🎯 Visit bucket %1").arg(index));
     }
-    addStep(QString("🎯 Visit bucket %1").arg(index));
 
     const auto &chain = buckets_[static_cast<size_t>(index)];
     for (const auto &node : chain) {
-        QString nodeKeyStr = variantToDisplayString(node.key);
-        addStep(QStringLiteral("Compare keys: %1 == %2 ? %3")
-                    .arg(nodeKeyStr, keyStr, node.key == key ? QStringLiteral("Yes") : QStringLiteral("No")));
-        if (node.key == key) {
-            QString valueStr = variantToDisplayString(node.value);
-            addStep(QStringLiteral("Found → return value %1").arg(valueStr));
+        const bool match = node.hash == computedHash && node.key == key;
+        if (tracing_) {
+            addStep(QStringLiteral("Compare keys: %1 == %2 ? %3")
+                        .arg(variantToDisplayString(node.key), keyStr, match ? QStringLiteral("Yes") : QStringLiteral("No")));
+        }
+        if (match) {
+            if (tracing_) addStep(QStringLiteral("Found → return value %1").arg(variantToDisplayString(node.value)));
             clearSteps();
             return node.value;
         }
@@ -315,35 +327,33 @@ bool HashMap::erase(const QVariant &key) {
 
     const int bucketCountNow = bucketCount();
 
-    QString keyStr = variantToDisplayString(key);
-
-    // Use our custom indexFor method
-    const int index = indexFor(key, bucketCountNow);
     const size_t computedHash = getHashValue(key);
+    const int index = static_cast<int>(computedHash % static_cast<size_t>(bucketCountNow));
 
-    // Show hash calculation for delete operation with computed hash value
-    if (key.typeId() == QMetaType::Int || key.typeId() == QMetaType::Double) {
-        addStep(QString("📊 Compute hash(%1) = %2").arg(keyStr).arg(computedHash));
-        addStep(QString("📐 Calculate: %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
-    } else {
-        addStep(QString("📊 Compute hash for: \"%1\" = %2").arg(keyStr).arg(computedHash));
-        addStep(QString("📐 Index = %2 % %1 = %3").arg(bucketCountNow).arg(computedHash).arg(index));
+    const QString keyStr = tracing_ ? variantToDisplayString(key) : QString();
+    if (tracing_) {
+        traceHashComputation(key, keyStr, computedHash, bucketCountNow, index);
+        addStep(QStringLiteral("Visit bucket %1").arg(index));
     }
-    addStep(QStringLiteral("Visit bucket %1").arg(index));
 
     auto &chain = buckets_[static_cast<size_t>(index)];
     auto before = chain.before_begin();
     for (auto it = chain.begin(); it != chain.end(); ++it) {
-        QString nodeKeyStr = variantToDisplayString(it->key);
-        addStep(QStringLiteral("Compare keys: %1 == %2 ? %3")
-                    .arg(nodeKeyStr, keyStr, it->key == key ? QStringLiteral("Yes") : QStringLiteral("No")));
-        if (it->key == key) {
+        const bool match = it->hash == computedHash && it->key == key;
+        if (tracing_) {
+            addStep(QStringLiteral("Compare keys: %1 == %2 ? %3")
+                        .arg(variantToDisplayString(it->key), keyStr, match ? QStringLiteral("Yes") : QStringLiteral("No")));
+        }
+        if (match) {
             chain.erase_after(before);
             --numElements_;
-            addStep(QStringLiteral("Erased node. New size = %1, load factor = %2")
-                        .arg(numElements_)
-                        .arg(loadFactor(), 0, 'f', 2));
+            if (tracing_) {
+                addStep(QStringLiteral("Erased node. New size = %1, load factor = %2")
+                            .arg(numElements_)
+                            .arg(loadFactor(), 0, 'f', 2));
+            }
             clearSteps();
+            emitEvent({EngineEvent::BucketChanged, index});
             return true;
         }
         ++before;
@@ -367,26 +377,96 @@ void HashMap::clear() {
     numElements_ = 0;
     hasRehashed_ = false;  // Reset rehash flag when clearing
     addStep(QStringLiteral("Cleared all buckets"));
+    emitEvent(EngineEvent::Cleared);
 }
 
 void HashMap::rehash(int newBucketCount) {
     if (newBucketCount < 1) newBucketCount = 1;
+    const int oldBucketCount = bucketCount();
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::forward_list<Node>> newBuckets(static_cast<size_t>(newBucketCount));
+
+    int threads = rehashThreads_ > 0 ? rehashThreads_
+                                     : static_cast<int>(ThreadPool::instance().threadCount()) + 1;
+    threads = std::max(1, std::min(threads, static_cast<int>(buckets_.size())));
+
+    if (numElements_ >= parallelRehashThreshold_) {
+        // Large tables: per-move tracing would dwarf the rehash itself, so log a summary.
+        // One thread takes the same splicing path, so timings differ only in thread count.
+        rehashParallel(newBuckets, threads);
+        buckets_.swap(newBuckets);
+        lastRehash_ = RehashStats{threads, numElements_, timer.nsecsElapsed() / 1.0e6};
+        addStep(QStringLiteral("⚡ Rehash to %1 buckets: %2 entries on %3 thread(s) in %4 ms")
+                    .arg(newBucketCount)
+                    .arg(numElements_)
+                    .arg(threads)
+                    .arg(lastRehash_.elapsedMs, 0, 'f', 2));
+        emitEvent({EngineEvent::Rehashed, oldBucketCount, newBucketCount});
+        return;
+    }
+
     QVector<QString> rehashSteps;
     rehashSteps.push_back(QStringLiteral("Rehashing to %1 buckets").arg(newBucketCount));
 
-    std::vector<std::forward_list<Node>> newBuckets(static_cast<size_t>(newBucketCount));
+    // Nodes are spliced across, never copied or reallocated
     for (auto &chain : buckets_) {
-        for (auto &node : chain) {
-            const int newIndex = indexFor(node.key, newBucketCount);
-            rehashSteps.append(QStringLiteral("Move (%1,%2) → bucket %3")
-                                   .arg(variantToDisplayString(node.key), variantToDisplayString(node.value))
-                                   .arg(newIndex));
-            newBuckets[static_cast<size_t>(newIndex)].push_front(Node{std::move(node.key), std::move(node.value)});
+        while (!chain.empty()) {
+            const Node &node = chain.front();
+            const int newIndex = static_cast<int>(node.hash % static_cast<size_t>(newBucketCount));
+            if (tracing_) {
+                rehashSteps.append(QStringLiteral("Move (%1,%2) → bucket %3")
+                                       .arg(variantToDisplayString(node.key), variantToDisplayString(node.value))
+                                       .arg(newIndex));
+            }
+            auto &target = newBuckets[static_cast<size_t>(newIndex)];
+            target.splice_after(target.before_begin(), chain, chain.before_begin());
         }
     }
     buckets_.swap(newBuckets);
+    lastRehash_ = RehashStats{1, numElements_, timer.nsecsElapsed() / 1.0e6};
     // Append rehash steps to the live steps log.
-    for (const auto &s : rehashSteps) stepHistory_.append(s);
+    for (const auto &s : rehashSteps) addStep(s);
+    emitEvent({EngineEvent::Rehashed, oldBucketCount, newBucketCount});
+}
+
+void HashMap::rehashParallel(std::vector<std::forward_list<Node>> &newBuckets, int threads) {
+    // Two phases, no locks and no allocation per entry:
+    //  1. Worker t owns a slice of the old buckets and splices each node into
+    //     staging[t][p], where p is the worker that owns the destination bucket.
+    //  2. Worker p owns a slice of the new buckets and splices staging[*][p] in.
+    const size_t partitions = static_cast<size_t>(threads);
+    const size_t oldCount = buckets_.size();
+    const size_t newCount = newBuckets.size();
+
+    std::vector<std::vector<std::forward_list<Node>>> staging(
+        partitions, std::vector<std::forward_list<Node>>(partitions));
+
+    ThreadPool &pool = ThreadPool::instance();
+    pool.parallelFor(static_cast<unsigned>(partitions), [&](unsigned t) {
+        const size_t first = oldCount * t / partitions;
+        const size_t last = oldCount * (t + 1) / partitions;
+        auto &outgoing = staging[t];
+        for (size_t b = first; b < last; ++b) {
+            auto &chain = buckets_[b];
+            while (!chain.empty()) {
+                const size_t dest = chain.front().hash % newCount;
+                auto &target = outgoing[dest * partitions / newCount];
+                target.splice_after(target.before_begin(), chain, chain.before_begin());
+            }
+        }
+    });
+
+    pool.parallelFor(static_cast<unsigned>(partitions), [&](unsigned p) {
+        for (size_t t = 0; t < partitions; ++t) {
+            auto &incoming = staging[t][p];
+            while (!incoming.empty()) {
+                auto &chain = newBuckets[incoming.front().hash % newCount];
+                chain.splice_after(chain.before_begin(), incoming, incoming.before_begin());
+            }
+        }
+    });
 }
 
 void HashMap::reserve(int expectedElements) {
@@ -415,6 +495,15 @@ QVector<int> HashMap::bucketSizes() const {
     return sizes;
 }
 
+QVector<QPair<QVariant, QVariant>> HashMap::bucketContents(int index) const {
+    QVector<QPair<QVariant, QVariant>> bucketItems;
+    if (index < 0 || index >= bucketCount()) return bucketItems;
+    for (const auto &node : buckets_[static_cast<size_t>(index)]) {
+        bucketItems.push_back(QPair<QVariant, QVariant>(node.key, node.value));
+    }
+    return bucketItems;
+}
+
 QVector<QVector<QPair<QVariant, QVariant>>> HashMap::getBucketContents() const {
     QVector<QVector<QPair<QVariant, QVariant>>> contents;
     contents.reserve(static_cast<int>(buckets_.size()));
@@ -4,13 +4,14 @@
 #include <QVector>
 #include <QVariant>
 #include <QHashFunctions>
+#include "engineobserver.h"
 #include <forward_list>
 #include <optional>
 #include <vector>
 
 // Hash Map supporting multiple data types for keys and values.
 // Instrumented with a human-readable step trace for visualization.
-class HashMap {
+class HashMap : public ObservableEngine {
 public:
     enum DataType {
         STRING,
@@ -44,16 +45,32 @@ public:
     void rehash(int newBucketCount);
     void reserve(int expectedElements);
 
+    // Parallel rehash tuning (0 threads = use every core)
+    struct RehashStats {
+        int threads = 1;
+        int movedEntries = 0;
+        double elapsedMs = 0.0;
+    };
+    void setRehashThreadCount(int threads) { rehashThreads_ = threads; }
+    void setParallelRehashThreshold(int entries) { parallelRehashThreshold_ = entries; }
+    const RehashStats &lastRehashStats() const { return lastRehash_; }
+
     // Visualization helpers
+    // Tracing off skips all step formatting (headless replay and benchmarks)
+    void setTracingEnabled(bool enabled) { tracing_ = enabled; }
+    bool tracingEnabled() const { return tracing_; }
     const QVector<QString> &lastSteps() const;
     void clearSteps();
     void addStepToHistory(const QString &step);
     QVector<int> bucketSizes() const;
     QVector<QVector<QPair<QVariant, QVariant>>> getBucketContents() const;
+    QVector<QPair<QVariant, QVariant>> bucketContents(int index) const;  // One bucket, for targeted redraws
 
     // Type conversion helpers
     static QString dataTypeToString(DataType type);
     static QString variantToDisplayString(const QVariant &var);
+    static bool dataTypeFromString(const QString &name, DataType &type);
+    static QVariant variantFromString(const QString &str, DataType type);  // Invalid on parse failure
     // Hash function (public for visualization)
     int indexFor(const QVariant &key, int bucketCount) const;
     // Get computed hash value (for display)
@@ -63,6 +80,7 @@ private:
     struct Node {
         QVariant key;
         QVariant value;
+        size_t hash;  // Cached so rehashing never re-hashes keys
     };
 
     std::vector<std::forward_list<Node>> buckets_;
@@ -71,11 +89,19 @@ private:
     QVector<QString> stepHistory_;  // Persistent history
     DataType keyType_ = STRING;
     DataType valueType_ = STRING;
-    bool hasRehashed_ = false;  // Track if rehashing has occurred (only once)
+    bool hasRehashed_ = false;  // Traced small tables rehash only once (see maybeGrow)
+    int rehashThreads_ = 0;
+    int parallelRehashThreshold_ = 1 << 16;
+    RehashStats lastRehash_;
+    bool tracing_ = true;
 
     void addStep(const QString &text);
-    bool emplaceOrAssign(const QVariant &key, const QVariant &value, bool assignIfExists);
+    void traceHashComputation(const QVariant &key, const QString &keyStr, size_t computedHash,
+                              int bucketCountNow, int index);
+    // index receives the bucket that changed, or -1 when nothing changed
+    bool emplaceOrAssign(const QVariant &key, const QVariant &value, bool assignIfExists, int &index);
     void maybeGrow();
+    void rehashParallel(std::vector<std::forward_list<Node>> &newBuckets, int threads);
     bool validateType(const QVariant &value, DataType expectedType) const;
 };
 
@@ -22,6 +22,7 @@ HashMapVisualization::HashMapVisualization(QWidget *parent)
     // Connect timer for delayed updates
     animationTimer->setSingleShot(true);
     connect(animationTimer, &QTimer::timeout, this, &HashMapVisualization::updateVisualization);
+    hashMap->addObserver(this);
 
     setMinimumSize(1200, 800);
 }
@@ -344,6 +345,47 @@ void HashMapVisualization::setupRightPanel()
     // Split right panel: chat history with spacing, type selection bottom
     setupStepTraceTop();
     setupTypeSelection();
+    setupSessionControls();
+}
+
+void HashMapVisualization::setupSessionControls()
+{
+    sessionControls = new SessionControls(this);
+    rightLayout->addWidget(sessionControls);
+}
+
+bool HashMapVisualization::replayOperation(const LoggedOperation &operation)
+{
+    // Go through the inputs exactly like a click would
+    const QString &op = operation.op;
+    const QStringList &args = operation.args;
+    if (op == "setTypes" && args.size() >= 2) {
+        HashMap::DataType keyType, valueType;
+        if (!HashMap::dataTypeFromString(args.at(0), keyType)
+            || !HashMap::dataTypeFromString(args.at(1), valueType)) {
+            return false;
+        }
+        {
+            QSignalBlocker keyBlocker(keyTypeCombo);
+            QSignalBlocker valueBlocker(valueTypeCombo);
+            keyTypeCombo->setCurrentIndex(keyType);
+            valueTypeCombo->setCurrentIndex(valueType);
+        }
+        onTypeChanged();
+    } else if (op == "put" && args.size() >= 2) {
+        keyInput->setText(args.at(0));
+        valueInput->setText(args.at(1));
+        onInsertClicked();
+    } else if ((op == "get" || op == "delete") && args.size() >= 1) {
+        keyInput->setText(args.at(0));
+        if (op == "get") onSearchClicked();
+        else onDeleteClicked();
+    } else if (op == "clear") {
+        onClearClicked();
+    } else {
+        return false;
+    }
+    return true;
 }
 
 void HashMapVisualization::setupStepTraceTop()
@@ -641,120 +683,20 @@ void HashMapVisualization::drawBuckets()
 {
     // Clear existing visualization
     scene->clear();
-    bucketRects.clear();
-    bucketTexts.clear();
+    highlightRect = nullptr;  // Owned by the scene, gone with everything else
+    bucketGroups.clear();
     chainTexts.clear();
 
     int actualBucketCount = hashMap->bucketCount();
     // Limit display to 16 buckets for visualization
     const int bucketCount = qMin(actualBucketCount, 16);
-    const QVector<int> bucketSizes = hashMap->bucketSizes();
-    const QVector<QVector<QPair<QVariant, QVariant>>> bucketContents = hashMap->getBucketContents();
-
-    // Calculate layout for all buckets in a single row
     const int totalWidth = bucketCount * (BUCKET_WIDTH + BUCKET_SPACING) - BUCKET_SPACING;
-    const int startX = -totalWidth / 2;
 
-    bucketRects.resize(bucketCount);
-    bucketTexts.resize(bucketCount);
+    bucketGroups.fill(nullptr, bucketCount);
     chainTexts.resize(bucketCount);
 
     for (int i = 0; i < bucketCount; ++i) {
-        const int x = startX + i * (BUCKET_WIDTH + BUCKET_SPACING);
-        const int y = 0;
-
-        // Calculate dynamic bucket height based on content
-        int bucketHeight = BUCKET_HEIGHT;
-        if (i < bucketContents.size() && !bucketContents[i].isEmpty()) {
-            bucketHeight = BUCKET_HEIGHT + (bucketContents[i].size() * 30); // 30px per item
-        }
-
-        // Create bucket with dynamic height
-        QGraphicsPathItem *bucketPath = new QGraphicsPathItem();
-        QPainterPath path;
-        path.addRoundedRect(QRectF(x, y, BUCKET_WIDTH, bucketHeight), 12, 12);
-        bucketPath->setPath(path);
-
-        // Set gradient brush for bucket
-        QLinearGradient bucketGradient(x, y, x, y + bucketHeight);
-        if (bucketSizes[i] > 0) {
-            // Filled bucket - purple gradient
-            bucketGradient.setColorAt(0.0, QColor(123, 79, 255, 15));
-            bucketGradient.setColorAt(1.0, QColor(123, 79, 255, 25));
-        } else {
-            // Empty bucket - light gradient
-            bucketGradient.setColorAt(0.0, QColor(255, 255, 255, 200));
-            bucketGradient.setColorAt(1.0, QColor(250, 248, 255, 200));
-        }
-        bucketPath->setBrush(QBrush(bucketGradient));
-        bucketPath->setPen(QPen(QColor(123, 79, 255, 120), 2.5));
-        scene->addItem(bucketPath);
-
-        // Bucket index label
-        QGraphicsTextItem *indexText = scene->addText(QString::number(i));
-        indexText->setPos(x + BUCKET_WIDTH/2 - 8, y - 35);
-        indexText->setDefaultTextColor(QColor(45, 27, 105));
-        QFont indexFont("Segoe UI", 14);
-        indexFont.setBold(true);
-        indexText->setFont(indexFont);
-
-        // Show data directly inside the bucket
-        QVector<QGraphicsTextItem*> chainItems;
-        if (i < bucketContents.size()) {
-            const auto &items = bucketContents[i];
-            for (int j = 0; j < items.size(); ++j) {
-                const int itemY = y + 10 + j * 30; // Items stacked vertically inside bucket
-
-                // Chain item background inside bucket
-                QGraphicsPathItem *itemBgPath = new QGraphicsPathItem();
-                QPainterPath itemPath;
-                itemPath.addRoundedRect(QRectF(x + 4, itemY, BUCKET_WIDTH - 8, 25), 6, 6);
-                itemBgPath->setPath(itemPath);
-                itemBgPath->setBrush(QBrush(QColor(255, 255, 255, 180)));
-                itemBgPath->setPen(QPen(QColor(123, 79, 255, 100), 1.5));
-                itemBgPath->setZValue(1);
-                scene->addItem(itemBgPath);
-
-                // Chain item text with actual key-value pair
-                const QVariant &key = items[j].first;
-                const QVariant &value = items[j].second;
-                QString keyStr = HashMap::variantToDisplayString(key);
-                QString valueStr = HashMap::variantToDisplayString(value);
-                QString displayText = QString("%1→%2").arg(keyStr.left(4), valueStr.left(4));
-
-                QGraphicsTextItem *chainItem = scene->addText(displayText);
-                chainItem->setPos(x + 6, itemY + 2);
-                chainItem->setDefaultTextColor(QColor(45, 27, 105));
-                QFont chainFont("Segoe UI", 8);
-                chainFont.setBold(true);
-                chainItem->setFont(chainFont);
-                chainItem->setZValue(2);
-                chainItems.append(chainItem);
-
-                // Add chain link arrow for multiple items
-                if (j > 0) {
-                    QGraphicsTextItem *arrow = scene->addText("↓");
-                    arrow->setPos(x + BUCKET_WIDTH/2 - 5, itemY - 15);
-                    arrow->setDefaultTextColor(QColor(123, 79, 255, 150));
-                    QFont arrowFont("Segoe UI", 10);
-                    arrowFont.setBold(true);
-                    arrow->setFont(arrowFont);
-                    arrow->setZValue(2);
-                }
-            }
-        }
-        chainTexts[i] = chainItems;
-
-        // Empty bucket label
-        if (bucketSizes[i] == 0) {
-            QGraphicsTextItem *emptyText = scene->addText("empty");
-            emptyText->setPos(x + BUCKET_WIDTH/2 - 15, y + BUCKET_HEIGHT/2 - 10);
-            emptyText->setDefaultTextColor(QColor(150, 150, 150));
-            QFont emptyFont("Segoe UI", 9);
-            emptyFont.setItalic(true);
-            emptyText->setFont(emptyFont);
-            emptyText->setZValue(2);
-        }
+        drawBucket(i);
     }
 
     // Add title higher up
@@ -770,11 +712,157 @@ void HashMapVisualization::drawBuckets()
     scene->setSceneRect(scene->itemsBoundingRect().adjusted(-60, -100, 60, 80));
 }
 
+void HashMapVisualization::drawBucket(int i)
+{
+    // Replace only this bucket's items; the rest of the scene is untouched
+    if (bucketGroups[i]) {
+        delete bucketGroups[i];
+        bucketGroups[i] = nullptr;
+    }
+
+    // Calculate layout for all buckets in a single row
+    const int totalWidth = bucketGroups.size() * (BUCKET_WIDTH + BUCKET_SPACING) - BUCKET_SPACING;
+    const int startX = -totalWidth / 2;
+    const int x = startX + i * (BUCKET_WIDTH + BUCKET_SPACING);
+    const int y = 0;
+
+    const QVector<QPair<QVariant, QVariant>> items = hashMap->bucketContents(i);
+    QList<QGraphicsItem*> groupItems;
+
+    // Calculate dynamic bucket height based on content
+    int bucketHeight = BUCKET_HEIGHT;
+    if (!items.isEmpty()) {
+        bucketHeight = BUCKET_HEIGHT + (items.size() * 30); // 30px per item
+    }
+
+    // Create bucket with dynamic height
+    QGraphicsPathItem *bucketPath = new QGraphicsPathItem();
+    QPainterPath path;
+    path.addRoundedRect(QRectF(x, y, BUCKET_WIDTH, bucketHeight), 12, 12);
+    bucketPath->setPath(path);
+
+    // Set gradient brush for bucket
+    QLinearGradient bucketGradient(x, y, x, y + bucketHeight);
+    if (!items.isEmpty()) {
+        // Filled bucket - purple gradient
+        bucketGradient.setColorAt(0.0, QColor(123, 79, 255, 15));
+        bucketGradient.setColorAt(1.0, QColor(123, 79, 255, 25));
+    } else {
+        // Empty bucket - light gradient
+        bucketGradient.setColorAt(0.0, QColor(255, 255, 255, 200));
+        bucketGradient.setColorAt(1.0, QColor(250, 248, 255, 200));
+    }
+    bucketPath->setBrush(QBrush(bucketGradient));
+    bucketPath->setPen(QPen(QColor(123, 79, 255, 120), 2.5));
+    scene->addItem(bucketPath);
+    groupItems.append(bucketPath);
+
+    // Bucket index label
+    QGraphicsTextItem *indexText = scene->addText(QString::number(i));
+    indexText->setPos(x + BUCKET_WIDTH/2 - 8, y - 35);
+    indexText->setDefaultTextColor(QColor(45, 27, 105));
+    QFont indexFont("Segoe UI", 14);
+    indexFont.setBold(true);
+    indexText->setFont(indexFont);
+    groupItems.append(indexText);
+
+    // Show data directly inside the bucket
+    QVector<QGraphicsTextItem*> chainItems;
+    for (int j = 0; j < items.size(); ++j) {
+        const int itemY = y + 10 + j * 30; // Items stacked vertically inside bucket
+
+        // Chain item background inside bucket
+        QGraphicsPathItem *itemBgPath = new QGraphicsPathItem();
+        QPainterPath itemPath;
+        itemPath.addRoundedRect(QRectF(x + 4, itemY, BUCKET_WIDTH - 8, 25), 6, 6);
+        itemBgPath->setPath(itemPath);
+        itemBgPath->setBrush(QBrush(QColor(255, 255, 255, 180)));
+        itemBgPath->setPen(QPen(QColor(123, 79, 255, 100), 1.5));
+        itemBgPath->setZValue(1);
+        scene->addItem(itemBgPath);
+        groupItems.append(itemBgPath);
+
+        // Chain item text with actual key-value pair
+        const QVariant &key = items[j].first;
+        const QVariant &value = items[j].second;
+        QString keyStr = HashMap::variantToDisplayString(key);
+        QString valueStr = HashMap::variantToDisplayString(value);
+        QString displayText = QString("%1→%2").arg(keyStr.left(4), valueStr.left(4));
+
+        QGraphicsTextItem *chainItem = scene->addText(displayText);
+        chainItem->setPos(x + 6, itemY + 2);
+        chainItem->setDefaultTextColor(QColor(45, 27, 105));
+        QFont chainFont("Segoe UI", 8);
+        chainFont.setBold(true);
+        chainItem->setFont(chainFont);
+        chainItem->setZValue(2);
+        chainItems.append(chainItem);
+        groupItems.append(chainItem);
+
+        // Add chain link arrow for multiple items
+        if (j > 0) {
+            QGraphicsTextItem *arrow = scene->addText("↓");
+            arrow->setPos(x + BUCKET_WIDTH/2 - 5, itemY - 15);
+            arrow->setDefaultTextColor(QColor(123, 79, 255, 150));
+            QFont arrowFont("Segoe UI", 10);
+            arrowFont.setBold(true);
+            arrow->setFont(arrowFont);
+            arrow->setZValue(2);
+            groupItems.append(arrow);
+        }
+    }
+    chainTexts[i] = chainItems;
+
+    // Empty bucket label
+    if (items.isEmpty()) {
+        QGraphicsTextItem *emptyText = scene->addText("empty");
+        emptyText->setPos(x + BUCKET_WIDTH/2 - 15, y + BUCKET_HEIGHT/2 - 10);
+        emptyText->setDefaultTextColor(QColor(150, 150, 150));
+        QFont emptyFont("Segoe UI", 9);
+        emptyFont.setItalic(true);
+        emptyText->setFont(emptyFont);
+        emptyText->setZValue(2);
+        groupItems.append(emptyText);
+    }
+
+    bucketGroups[i] = scene->createItemGroup(groupItems);
+}
+
+void HashMapVisualization::onEngineEvent(const EngineEvent &event)
+{
+    switch (event.type) {
+    case EngineEvent::BucketChanged:
+        // Buckets past the displayed range only affect the stats
+        if (event.first < bucketGroups.size()) dirtyBuckets.insert(event.first);
+        break;
+    case EngineEvent::Rehashed:
+    case EngineEvent::Cleared:
+        fullRedrawPending = true;
+        break;
+    default:
+        break;
+    }
+    // Coalesce bursts (Randomize) into a single refresh
+    animationTimer->start(0);
+}
+
 void HashMapVisualization::updateVisualization()
 {
+    animationTimer->stop();  // A direct refresh supersedes a queued one
     int currentBucketCount = hashMap->bucketCount();
-    
-    drawBuckets();
+
+    if (fullRedrawPending || bucketGroups.size() != qMin(currentBucketCount, 16)) {
+        drawBuckets();
+    } else {
+        for (int index : std::as_const(dirtyBuckets)) {
+            drawBucket(index);
+            // Grow the scene if a chain got longer; never shrink mid-session
+            scene->setSceneRect(scene->sceneRect().united(
+                bucketGroups[index]->sceneBoundingRect().adjusted(-60, -100, 60, 80)));
+        }
+    }
+    fullRedrawPending = false;
+    dirtyBuckets.clear();
     showStats();
     
     // Zoom out if bucket count increased (rehashing occurred)
@@ -808,10 +896,11 @@ void HashMapVisualization::zoomToFit()
 
 void HashMapVisualization::updateStepTrace()
 {
-    stepsList->clear();
+    // The step log only grows, so append the new steps instead of rebuilding the list
     const QVector<QString> &steps = hashMap->lastSteps();
+    if (steps.size() < stepsList->count()) stepsList->clear();
 
-    for (int i = 0; i < steps.size(); ++i) {
+    for (int i = stepsList->count(); i < steps.size(); ++i) {
         const QString &step = steps[i];
 
         // Handle separator lines
@@ -996,6 +1085,9 @@ void HashMapVisualization::onTypeChanged()
     HashMap::DataType keyType = static_cast<HashMap::DataType>(keyTypeCombo->currentIndex());
     HashMap::DataType valueType = static_cast<HashMap::DataType>(valueTypeCombo->currentIndex());
 
+    OperationRecorder::instance().record(LoggedOperation::HashTable, "setTypes",
+                                         {HashMap::dataTypeToString(keyType), HashMap::dataTypeToString(valueType)});
+
     hashMap->setKeyType(keyType);
     hashMap->setValueType(valueType);
 
@@ -1014,29 +1106,7 @@ void HashMapVisualization::onTypeChanged()
 
 QVariant HashMapVisualization::convertStringToVariant(const QString &str, HashMap::DataType type)
 {
-    bool ok;
-    switch (type) {
-    case HashMap::STRING:
-        return QVariant(str);
-    case HashMap::INTEGER: {
-        int intVal = str.toInt(&ok);
-        return ok ? QVariant(intVal) : QVariant();
-    }
-    case HashMap::DOUBLE: {
-        double doubleVal = str.toDouble(&ok);
-        return ok ? QVariant(doubleVal) : QVariant();
-    }
-    case HashMap::FLOAT: {
-        float floatVal = str.toFloat(&ok);
-        return ok ? QVariant(floatVal) : QVariant();
-    }
-    case HashMap::CHAR: {
-        if (str.isEmpty()) return QVariant();
-        return QVariant(QChar(str.at(0)));
-    }
-    default:
-        return QVariant();
-    }
+    return HashMap::variantFromString(str, type);
 }
 
 void HashMapVisualization::onInsertClicked()
@@ -1070,6 +1140,7 @@ void HashMapVisualization::onInsertClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::HashTable, "put", {keyStr, valueStr});
     hashMap->put(key, value);
     animateOperation("Insert");
     showAlgorithm("Insert");
@@ -1103,6 +1174,8 @@ void HashMapVisualization::onSearchClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::HashTable, "get", {keyStr});
+
     // Perform search by key
     auto result = hashMap->get(key);
     animateOperation("Search");
@@ -1156,11 +1229,11 @@ void HashMapVisualization::animateSearchResult(const QString &key, bool found)
         const int x = startX + bucketIndex * (BUCKET_WIDTH + BUCKET_SPACING);
         const int y = 0;
 
-        // Calculate bucket height (same logic as drawBuckets)
-        const QVector<QVector<QPair<QVariant, QVariant>>> bucketContents = hashMap->getBucketContents();
+        // Calculate bucket height (same logic as drawBucket)
+        const int chainLength = hashMap->bucketContents(bucketIndex).size();
         int bucketHeight = BUCKET_HEIGHT;
-        if (bucketIndex < bucketContents.size() && !bucketContents[bucketIndex].isEmpty()) {
-            bucketHeight = BUCKET_HEIGHT + (bucketContents[bucketIndex].size() * 30);
+        if (chainLength > 0) {
+            bucketHeight = BUCKET_HEIGHT + (chainLength * 30);
         }
 
         // Create highlight effect (like Binary Search Tree node highlighting)
@@ -1213,6 +1286,7 @@ void HashMapVisualization::onDeleteClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::HashTable, "delete", {keyStr});
     bool removed = hashMap->erase(key);
     animateOperation("Delete");
     showAlgorithm("Delete");
@@ -1225,6 +1299,7 @@ void HashMapVisualization::onDeleteClicked()
 
 void HashMapVisualization::onClearClicked()
 {
+    OperationRecorder::instance().record(LoggedOperation::HashTable, "clear");
     hashMap->clear();
     animateOperation("Clear");
     showAlgorithm("Clear");
@@ -1306,6 +1381,7 @@ void HashMapVisualization::onRandomizeClicked()
         }
         }
 
+        OperationRecorder::instance().record(LoggedOperation::HashTable, "put", {key.toString(), value.toString()});
         hashMap->put(key, value);
     }
 
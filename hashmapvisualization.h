@@ -14,6 +14,7 @@
 #include <QGraphicsRectItem>
 #include <QGraphicsTextItem>
 #include <QGraphicsPathItem>
+#include <QGraphicsItemGroup>
 #include <QPainterPath>
 #include <QTimer>
 #include <QPropertyAnimation>
@@ -34,13 +35,15 @@
 #include <QGraphicsDropShadowEffect>
 #include <QScrollBar>
 #include <QSplitterHandle>
+#include <QSet>
 #include <memory>
 #include "hashmap.h"
 #include "backbutton.h"
 #include "stylemanager.h"
 #include "widgetmanager.h"
+#include "sessioncontrols.h"
 
-class HashMapVisualization : public QWidget
+class HashMapVisualization : public QWidget, public ReplayTarget, public EngineObserver
 {
     Q_OBJECT
 
@@ -48,6 +51,14 @@ public:
     explicit HashMapVisualization(QWidget *parent = nullptr);
     ~HashMapVisualization();
 
+    // ReplayTarget
+    LoggedOperation::Lab replayLab() const override { return LoggedOperation::HashTable; }
+    bool isReplayBusy() const override { return false; }  // Operations apply immediately
+    bool replayOperation(const LoggedOperation &operation) override;
+
+    // EngineObserver
+    void onEngineEvent(const EngineEvent &event) override;
+
 signals:
     void backToOperations();
 
@@ -73,7 +84,9 @@ private:
     void setupStatsAndControls();
     void setupStepTrace();
     void setupStepTraceTop();
+    void setupSessionControls();
     void drawBuckets();
+    void drawBucket(int index);
     void animateOperation(const QString &operation);
     void animateSearchResult(const QString &key, bool found);
     void showAlgorithm(const QString &operation);
@@ -120,11 +133,15 @@ private:
     QListWidget *stepsList;
     QListWidget *algorithmList;
 
+    // Session record / replay
+    SessionControls *sessionControls;
+
     // Data and visualization
     HashMap *hashMap;
-    QVector<QGraphicsRectItem*> bucketRects;
-    QVector<QGraphicsTextItem*> bucketTexts;
+    QVector<QGraphicsItemGroup*> bucketGroups;  // One per displayed bucket
     QVector<QVector<QGraphicsTextItem*>> chainTexts;
+    QSet<int> dirtyBuckets;         // Displayed buckets changed since the last refresh
+    bool fullRedrawPending = true;  // Rehash or clear: rebuild the whole scene
 
     // Animation
     QTimer *animationTimer;
@@ -0,0 +1,157 @@
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Allocation counters for one arena
+struct NodeArenaStats {
+    std::size_t blockAllocations = 0;  // Heap allocations - the only malloc calls an arena makes
+    std::size_t nodesCreated = 0;
+    std::size_t freeListReuses = 0;    // Creates served by a slot freed earlier
+    std::size_t liveNodes = 0;
+    std::size_t capacity = 0;          // Slots across all blocks
+};
+
+// Per-tree node pool. Nodes are carved from large blocks in creation order,
+// so nodes inserted together sit together in memory. Freed slots go on a
+// free list and are handed out again before fresh ones, which keeps a
+// steady insert/delete mix off the heap. releaseAll() forgets every node at
+// once and keeps the blocks for the next build.
+//
+// Nodes are never destroyed one by one, so they must be trivially destructible.
+template<typename Node>
+class NodeArena
+{
+    static_assert(std::is_trivially_destructible<Node>::value,
+                  "NodeArena skips destructors on releaseAll()");
+
+public:
+    NodeArena() = default;
+
+    template<typename... Args>
+    Node* create(Args&&... args)
+    {
+        void *storage;
+        if (freeList) {
+            storage = freeList;
+            freeList = freeList->next;
+            ++counters.freeListReuses;
+        } else {
+            storage = nextFreshSlot();
+        }
+        ++counters.nodesCreated;
+        ++counters.liveNodes;
+        return new (storage) Node(std::forward<Args>(args)...);
+    }
+
+    void destroy(Node *node)
+    {
+        if (!node) return;
+        Slot *slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+        --counters.liveNodes;
+    }
+
+    // Drop every node in O(1); the blocks stay allocated for reuse
+    void releaseAll()
+    {
+        freeList = nullptr;
+        currentBlock = 0;
+        usedInBlock = 0;
+        counters.liveNodes = 0;
+    }
+
+    // Take over every block of other, live nodes included, so nodes can move
+    // between trees without being copied. other ends up empty.
+    void adopt(NodeArena &other)
+    {
+        if (&other == this || other.blocks.empty()) return;
+
+        // Blocks other has carved nodes from go in front of ours, where the
+        // fresh-slot cursor never looks again; the unused tail of its current
+        // block goes on the free list, and its untouched blocks join our spares.
+        std::size_t carved = std::min(other.currentBlock, other.blocks.size());
+        if (carved < other.blocks.size() && other.usedInBlock > 0) {
+            Block &partial = other.blocks[carved];
+            for (std::size_t i = other.usedInBlock; i < partial.size; ++i) {
+                partial.slots[i].next = other.freeList;
+                other.freeList = &partial.slots[i];
+            }
+            ++carved;
+        }
+        const auto firstSpare = other.blocks.begin() + static_cast<std::ptrdiff_t>(carved);
+        blocks.insert(blocks.begin(), std::make_move_iterator(other.blocks.begin()),
+                      std::make_move_iterator(firstSpare));
+        blocks.insert(blocks.end(), std::make_move_iterator(firstSpare),
+                      std::make_move_iterator(other.blocks.end()));
+        currentBlock += carved;
+
+        if (other.freeList) {
+            Slot *tail = other.freeList;
+            while (tail->next) tail = tail->next;
+            tail->next = freeList;
+            freeList = other.freeList;
+        }
+
+        counters.liveNodes += other.counters.liveNodes;
+        counters.capacity += other.counters.capacity;
+        other.blocks.clear();
+        other.releaseAll();
+        other.counters.capacity = 0;
+    }
+
+    const NodeArenaStats &stats() const { return counters; }
+
+private:
+    union Slot {
+        Slot *next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    struct Block {
+        std::unique_ptr<Slot[]> slots;
+        std::size_t size;
+    };
+
+    void *nextFreshSlot()
+    {
+        // Move on to the next block - one kept from before releaseAll(), or a new one
+        while (currentBlock < blocks.size() && usedInBlock == blocks[currentBlock].size) {
+            ++currentBlock;
+            usedInBlock = 0;
+        }
+        if (currentBlock == blocks.size()) {
+            // Blocks double up to a cap, so small trees stay small
+            const std::size_t size = blocks.empty()
+                ? FIRST_BLOCK_SLOTS
+                : std::min(blocks.back().size * 2, MAX_BLOCK_SLOTS);
+            blocks.push_back({std::unique_ptr<Slot[]>(new Slot[size]), size});
+            ++counters.blockAllocations;
+            counters.capacity += size;
+            usedInBlock = 0;
+        }
+        return &blocks[currentBlock].slots[usedInBlock++];
+    }
+
+    static constexpr std::size_t FIRST_BLOCK_SLOTS = 64;
+    static constexpr std::size_t MAX_BLOCK_SLOTS = 64 * 1024;
+
+    std::vector<Block> blocks;
+    std::size_t currentBlock = 0;
+    std::size_t usedInBlock = 0;
+    Slot *freeList = nullptr;
+    NodeArenaStats counters;
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+};
+
+#endif // NODEARENA_H
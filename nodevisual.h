@@ -0,0 +1,165 @@
+#ifndef NODEVISUAL_H
+#define NODEVISUAL_H
+
+#include "treelayout.h"
+
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+
+// Drawing state for one tree node. Engines' nodes only hold what the
+// algorithms need; everything the painter needs lives here instead.
+struct NodeVisual {
+    int x = 0, y = 0;  // Position for drawing
+    // Extent of the subtree under the node, for culling and summaries
+    int subtreeLeft = 0, subtreeRight = 0, subtreeBottom = 0;
+    int subtreeNodes = 1;
+    bool isHighlighted = false;
+    bool isRotating = false;
+    bool isNewNode = false;
+    bool isSearchHighlighted = false;
+    bool isDeleteHighlighted = false;
+    bool isTraversalHighlighted = false;
+    bool isVisited = false;
+    // Epochs the operation flags and the traversal flags were last written
+    // in; flags from an older epoch are stale (see NodeVisualTable)
+    quint64 highlightStamp = 0;
+    quint64 traversalStamp = 0;
+
+    bool isDecorated() const
+    {
+        return isHighlighted || isRotating || isNewNode || isSearchHighlighted || isDeleteHighlighted
+               || isTraversalHighlighted || isVisited;
+    }
+
+    // Same place, no highlights: how the node looks in a cached static layer
+    NodeVisual undecorated() const
+    {
+        NodeVisual plain;
+        plain.x = x;
+        plain.y = y;
+        plain.subtreeLeft = subtreeLeft;
+        plain.subtreeRight = subtreeRight;
+        plain.subtreeBottom = subtreeBottom;
+        plain.subtreeNodes = subtreeNodes;
+        return plain;
+    }
+};
+
+// Side table owned by a tree lab, keyed by node id. Values are unique
+// within a tree and follow a key when the engine relinks nodes, so the
+// value is the id. Drop an entry when its node is removed.
+//
+// Highlights are set through operator[], which remembers the id, so the
+// per-frame overlay visits only those nodes, not the tree. Resets don't
+// visit anything: they start a new epoch, and flags stamped with an older
+// one read as cleared from then on - O(1) per animation step.
+class NodeVisualTable
+{
+public:
+    NodeVisual &operator[](int id)
+    {
+        decorated.insert(id);
+        NodeVisual &visual = table[id];
+        expireStale(visual);
+        return visual;
+    }
+    NodeVisual at(int id) const
+    {
+        NodeVisual visual = table.value(id);
+        expireStale(visual);
+        return visual;
+    }
+    // For layout: positions only, the node is not remembered as decorated
+    NodeVisual &place(int id) { return table[id]; }
+
+    void remove(int id)
+    {
+        table.remove(id);
+        decorated.remove(id);
+    }
+    void clear()
+    {
+        table.clear();
+        decorated.clear();
+        invalidateLayout();
+    }
+
+    // visit(id, visual) for every node with a highlight set. Ids that are
+    // gone or whose highlights went stale are forgotten on the way.
+    template <typename Visit>
+    void forEachDecorated(Visit visit)
+    {
+        for (auto id = decorated.begin(); id != decorated.end();) {
+            auto visual = table.find(*id);
+            if (visual != table.end()) expireStale(*visual);
+            if (visual == table.end() || !visual->isDecorated()) {
+                id = decorated.erase(id);
+                continue;
+            }
+            visit(*id, *visual);
+            ++id;
+        }
+    }
+
+    // Positions are cached across repaints, so highlight-only frames do no
+    // layout work. Labs invalidate the layout when the canvas or the tree's
+    // shape changes.
+    bool isLayoutValid() const { return layoutValid; }
+    void setLayoutValid() { layoutValid = true; }
+    void invalidateLayout() { layoutValid = false; }
+
+    // Fill in every node's subtree extent once its x and y are placed
+    template <typename Node>
+    void updateSubtreeBounds(const std::vector<TidyTreeLayout::Placement<Node>> &placements, Node *nil)
+    {
+        // Preorder, so walking it backwards meets children before their parent
+        for (auto it = placements.rbegin(); it != placements.rend(); ++it) {
+            NodeVisual &visual = table[it->node->value];
+            visual.subtreeLeft = visual.subtreeRight = visual.x;
+            visual.subtreeBottom = visual.y;
+            visual.subtreeNodes = 1;
+            for (Node *child : {it->node->left, it->node->right}) {
+                if (child == nil) continue;
+                const NodeVisual &below = *table.constFind(child->value);
+                visual.subtreeLeft = std::min(visual.subtreeLeft, below.subtreeLeft);
+                visual.subtreeRight = std::max(visual.subtreeRight, below.subtreeRight);
+                visual.subtreeBottom = std::max(visual.subtreeBottom, below.subtreeBottom);
+                visual.subtreeNodes += below.subtreeNodes;
+            }
+        }
+    }
+
+    // Clear every operation highlight; positions are kept
+    void resetHighlights() { ++highlightEpoch; }
+    void resetTraversal() { ++traversalEpoch; }
+
+private:
+    // Clear the flags a reset made stale and stamp them with the current epoch
+    void expireStale(NodeVisual &visual) const
+    {
+        if (visual.highlightStamp != highlightEpoch) {
+            visual.isHighlighted = false;
+            visual.isRotating = false;
+            visual.isNewNode = false;
+            visual.isSearchHighlighted = false;
+            visual.isDeleteHighlighted = false;
+            visual.highlightStamp = highlightEpoch;
+        }
+        if (visual.traversalStamp != traversalEpoch) {
+            visual.isTraversalHighlighted = false;
+            visual.isVisited = false;
+            visual.traversalStamp = traversalEpoch;
+        }
+    }
+
+    QHash<int, NodeVisual> table;
+    QSet<int> decorated;
+    // 64-bit, so the epochs never wrap back onto an old stamp
+    quint64 highlightEpoch = 1;
+    quint64 traversalEpoch = 1;
+    bool layoutValid = false;
+};
+
+#endif // NODEVISUAL_H
@@ -0,0 +1,105 @@
+#include "operationlog.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+QString LoggedOperation::labName(Lab lab)
+{
+    switch (lab) {
+    case BST: return "bst";
+    case RedBlack: return "rb";
+    case Graph: return "graph";
+    case HashTable: return "hash";
+    default: return "unknown";
+    }
+}
+
+bool LoggedOperation::labFromName(const QString &name, Lab &lab)
+{
+    for (Lab candidate : {BST, RedBlack, Graph, HashTable}) {
+        if (labName(candidate) == name) {
+            lab = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OperationLog::save(const QString &path, QString *error) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    for (const LoggedOperation &entry : entries) {
+        QJsonObject object;
+        object["lab"] = LoggedOperation::labName(entry.lab);
+        object["op"] = entry.op;
+        object["args"] = QJsonArray::fromStringList(entry.args);
+        out << QJsonDocument(object).toJson(QJsonDocument::Compact) << '\n';
+    }
+    return true;
+}
+
+bool OperationLog::load(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QVector<LoggedOperation> loaded;
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+        const QJsonObject object = document.object();
+
+        LoggedOperation entry;
+        if (parseError.error != QJsonParseError::NoError || !document.isObject()
+            || !LoggedOperation::labFromName(object["lab"].toString(), entry.lab)
+            || object["op"].toString().isEmpty()) {
+            if (error) *error = QString("Line %1: not a valid operation").arg(lineNumber);
+            return false;
+        }
+
+        entry.op = object["op"].toString();
+        for (const QJsonValue &arg : object["args"].toArray()) {
+            // Accept bare numbers too, for hand-written workloads
+            entry.args << (arg.isDouble() ? QString::number(arg.toDouble()) : arg.toString());
+        }
+        loaded.append(entry);
+    }
+
+    entries = loaded;
+    return true;
+}
+
+OperationRecorder& OperationRecorder::instance()
+{
+    static OperationRecorder recorder;
+    return recorder;
+}
+
+void OperationRecorder::start()
+{
+    session.clear();
+    recording = true;
+}
+
+void OperationRecorder::record(LoggedOperation::Lab lab, const QString &op, const QStringList &args)
+{
+    if (!recording) return;
+    session.append({lab, op, args});
+}
@@ -0,0 +1,75 @@
+#ifndef OPERATIONLOG_H
+#define OPERATIONLOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// One user action in a lab, e.g. {RedBlack, "insert", ["42"]}.
+// Arguments are kept as the text typed into the lab's inputs so a replay
+// goes through exactly the same parsing as the original click.
+struct LoggedOperation {
+    enum Lab {
+        BST,
+        RedBlack,
+        Graph,
+        HashTable
+    };
+
+    Lab lab = BST;
+    QString op;
+    QStringList args;
+
+    static QString labName(Lab lab);
+    static bool labFromName(const QString &name, Lab &lab);
+};
+
+// Operation log stored as JSON Lines - one operation per line:
+//   {"lab":"rb","op":"insert","args":["42"]}
+// Operation names per lab:
+//   bst / rb : insert v, search v, delete v, clear, bfs, dfs
+//   bst      : balance none|avl|treap, rebalance (Day-Stout-Warren)
+//   rb       : load file (bulk-load a key file, see datasetfile.h),
+//              bulk v1 v2 ... (one batch, one version), undo, redo,
+//              version i, select k|p%, rank v, range lo hi, scan lo hi
+//   graph    : addVertex [id], deleteVertex id, addEdge u v, deleteEdge u v,
+//              clear, bfs [start], dfs [start]
+//   hash     : setTypes keyType valueType, put k v, get k, delete k, clear
+class OperationLog
+{
+public:
+    void append(const LoggedOperation &operation) { entries.append(operation); }
+    void clear() { entries.clear(); }
+
+    const QVector<LoggedOperation> &operations() const { return entries; }
+    int size() const { return entries.size(); }
+    bool isEmpty() const { return entries.isEmpty(); }
+
+    bool save(const QString &path, QString *error = nullptr) const;
+    bool load(const QString &path, QString *error = nullptr);
+
+private:
+    QVector<LoggedOperation> entries;
+};
+
+// Session recorder shared by all labs (like StyleManager)
+class OperationRecorder
+{
+public:
+    static OperationRecorder& instance();
+
+    void start();
+    void stop() { recording = false; }
+    bool isRecording() const { return recording; }
+
+    void record(LoggedOperation::Lab lab, const QString &op, const QStringList &args = QStringList());
+    const OperationLog &log() const { return session; }
+
+private:
+    OperationRecorder() = default;
+
+    OperationLog session;
+    bool recording = false;
+};
+
+#endif // OPERATIONLOG_H
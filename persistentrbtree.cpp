@@ -0,0 +1,451 @@
+#include "persistentrbtree.h"
+
+namespace {
+
+using Node = PersistentRBTree::Node;
+using NodePtr = std::shared_ptr<const Node>;
+// A node copied by the operation in progress. Nothing else can see it yet,
+// so it may be rewired freely until the new version is returned.
+using MutableNode = std::shared_ptr<Node>;
+
+Color colorOf(const NodePtr &node)
+{
+    return node ? node->color : BLACK;  // Leaves are black, as NIL is in the engine
+}
+
+MutableNode copyOf(const NodePtr &node)
+{
+    return std::make_shared<Node>(*node);
+}
+
+// Put replacement where child hung under parent, or at the root
+void replaceChild(NodePtr &root, const MutableNode &parent, const Node *child, const NodePtr &replacement)
+{
+    if (!parent) {
+        root = replacement;
+    } else if (parent->left.get() == child) {
+        parent->left = replacement;
+    } else {
+        parent->right = replacement;
+    }
+}
+
+// Both nodes must be copies; the caller relinks pivot in node's place
+void rotateLeft(const MutableNode &node, const MutableNode &pivot)
+{
+    node->right = pivot->left;
+    pivot->left = node;
+}
+
+void rotateRight(const MutableNode &node, const MutableNode &pivot)
+{
+    node->left = pivot->right;
+    pivot->right = node;
+}
+
+NodePtr copyEngineSubtree(const RBNode *node, const RBNode *nil)
+{
+    if (node == nil) return nullptr;
+    return std::make_shared<const Node>(Node{node->value, node->color(),
+                                             copyEngineSubtree(node->left, nil),
+                                             copyEngineSubtree(node->right, nil)});
+}
+
+// In-order cursor over one version that can skip a whole subtree. The
+// subtree in pending comes before the node on top of the stack.
+struct DiffCursor {
+    const Node *pending;
+    std::vector<const Node*> stack;
+
+    explicit DiffCursor(const Node *root) : pending(root) {}
+
+    void descend()
+    {
+        stack.push_back(pending);
+        pending = pending->left.get();
+    }
+
+    const Node *next() const { return stack.empty() ? nullptr : stack.back(); }
+
+    void pop()
+    {
+        pending = stack.back()->right.get();
+        stack.pop_back();
+    }
+};
+
+} // namespace
+
+PersistentRBTree PersistentRBTree::fromEngine(const RBTreeEngine &engine)
+{
+    return PersistentRBTree(copyEngineSubtree(engine.root(), engine.nil()), engine.size());
+}
+
+bool PersistentRBTree::contains(int value) const
+{
+    const Node *node = rootNode.get();
+    while (node && node->value != value) {
+        node = value < node->value ? node->left.get() : node->right.get();
+    }
+    return node != nullptr;
+}
+
+std::vector<int> PersistentRBTree::keys() const
+{
+    std::vector<int> keys;
+    keys.reserve(static_cast<std::size_t>(count));
+    std::vector<const Node*> stack;
+    const Node *node = rootNode.get();
+    while (node || !stack.empty()) {
+        while (node) {
+            stack.push_back(node);
+            node = node->left.get();
+        }
+        node = stack.back();
+        stack.pop_back();
+        keys.push_back(node->value);
+        node = node->right.get();
+    }
+    return keys;
+}
+
+PersistentRBTree PersistentRBTree::insert(int value) const
+{
+    if (contains(value)) return *this;
+
+    // Copy the search path (RBTreeEngine::insert) and hang a red leaf below it
+    std::vector<MutableNode> path;
+    NodePtr root;
+    NodePtr original = rootNode;
+    while (original) {
+        MutableNode copy = copyOf(original);
+        replaceChild(root, path.empty() ? nullptr : path.back(), original.get(), copy);
+        path.push_back(copy);
+        original = value < copy->value ? copy->left : copy->right;
+    }
+    MutableNode leaf = std::make_shared<Node>(Node{value, RED, nullptr, nullptr});
+    if (path.empty()) {
+        root = leaf;
+    } else if (value < path.back()->value) {
+        path.back()->left = leaf;
+    } else {
+        path.back()->right = leaf;
+    }
+    path.push_back(leaf);
+
+    // RBTreeEngine::planInsertCase on the copied path: path[i] is the node,
+    // path[i - 1] its parent, path[i - 2] its grandparent
+    std::size_t i = path.size() - 1;
+    while (i >= 2 && path[i - 1]->color == RED) {
+        const MutableNode parent = path[i - 1];
+        const MutableNode grandparent = path[i - 2];
+        const MutableNode greatGrandparent = i >= 3 ? path[i - 3] : nullptr;
+
+        if (grandparent->left.get() == parent.get()) {
+            if (colorOf(grandparent->right) == RED) {
+                // Case 1: Uncle is red
+                MutableNode uncle = copyOf(grandparent->right);
+                grandparent->right = uncle;
+                parent->color = BLACK;
+                uncle->color = BLACK;
+                grandparent->color = RED;
+                i -= 2;
+                continue;
+            }
+            MutableNode top = parent;
+            if (parent->right.get() == path[i].get()) {
+                // Case 2: Triangle - convert to line
+                top = path[i];
+                rotateLeft(parent, top);
+                grandparent->left = top;
+            }
+            // Case 3: Line
+            top->color = BLACK;
+            grandparent->color = RED;
+            rotateRight(grandparent, top);
+            replaceChild(root, greatGrandparent, grandparent.get(), top);
+        } else {
+            if (colorOf(grandparent->left) == RED) {
+                MutableNode uncle = copyOf(grandparent->left);
+                grandparent->left = uncle;
+                parent->color = BLACK;
+                uncle->color = BLACK;
+                grandparent->color = RED;
+                i -= 2;
+                continue;
+            }
+            MutableNode top = parent;
+            if (parent->left.get() == path[i].get()) {
+                top = path[i];
+                rotateRight(parent, top);
+                grandparent->right = top;
+            }
+            top->color = BLACK;
+            grandparent->color = RED;
+            rotateLeft(grandparent, top);
+            replaceChild(root, greatGrandparent, grandparent.get(), top);
+        }
+        break;  // The subtree now hangs from a black node
+    }
+
+    if (root->color == RED) {
+        MutableNode blackRoot = copyOf(root);
+        blackRoot->color = BLACK;
+        root = blackRoot;
+    }
+    return PersistentRBTree(root, count + 1);
+}
+
+PersistentRBTree PersistentRBTree::remove(int value) const
+{
+    if (!contains(value)) return *this;
+
+    // Copy the search path down to z, the node holding value
+    std::vector<MutableNode> path;
+    NodePtr root;
+    NodePtr original = rootNode;
+    while (true) {
+        MutableNode copy = copyOf(original);
+        replaceChild(root, path.empty() ? nullptr : path.back(), original.get(), copy);
+        path.push_back(copy);
+        if (copy->value == value) break;
+        original = value < copy->value ? copy->left : copy->right;
+    }
+
+    // RBTreeEngine::deleteNode. above holds x's ancestors, nearest last;
+    // x may be a leaf (nullptr), so its side is tracked as well.
+    const std::size_t zIndex = path.size() - 1;
+    const MutableNode z = path[zIndex];
+    const MutableNode zParent = zIndex > 0 ? path[zIndex - 1] : nullptr;
+    Color removedColor = z->color;
+    std::vector<MutableNode> above(path.begin(), path.begin() + static_cast<std::ptrdiff_t>(zIndex));
+    NodePtr x;
+    bool xIsLeft;
+
+    if (!z->left || !z->right) {
+        x = z->left ? z->left : z->right;
+        xIsLeft = zParent && zParent->left.get() == z.get();
+        replaceChild(root, zParent, z.get(), x);
+    } else {
+        // y = z's successor, the leftmost node of z's right subtree
+        MutableNode cursor = copyOf(z->right);
+        z->right = cursor;
+        path.push_back(cursor);
+        while (cursor->left) {
+            MutableNode next = copyOf(cursor->left);
+            cursor->left = next;
+            path.push_back(next);
+            cursor = next;
+        }
+        const MutableNode y = path.back();
+        removedColor = y->color;
+        x = y->right;
+
+        above.push_back(y);
+        if (path.size() - 1 == zIndex + 1) {
+            xIsLeft = false;  // y was z's right child and keeps x on its right
+        } else {
+            const MutableNode yParent = path[path.size() - 2];
+            yParent->left = y->right;
+            y->right = z->right;
+            above.insert(above.end(), path.begin() + static_cast<std::ptrdiff_t>(zIndex + 1), path.end() - 1);
+            xIsLeft = true;
+        }
+        y->left = z->left;
+        y->color = z->color;
+        replaceChild(root, zParent, z.get(), y);
+    }
+
+    // RBTreeEngine::planDeleteCase: x carries an extra black
+    while (removedColor == BLACK && !above.empty() && colorOf(x) == BLACK) {
+        const MutableNode parent = above.back();
+        MutableNode grandparent = above.size() >= 2 ? above[above.size() - 2] : nullptr;
+
+        if (xIsLeft) {
+            MutableNode sibling = copyOf(parent->right);
+            parent->right = sibling;
+
+            if (sibling->color == RED) {
+                // Case 1: red sibling - rotate so the sibling is black
+                sibling->color = BLACK;
+                parent->color = RED;
+                rotateLeft(parent, sibling);
+                replaceChild(root, grandparent, parent.get(), sibling);
+                above.insert(above.end() - 1, sibling);
+                grandparent = sibling;
+                sibling = copyOf(parent->right);
+                parent->right = sibling;
+            }
+
+            if (colorOf(sibling->left) == BLACK && colorOf(sibling->right) == BLACK) {
+                // Case 2: move the extra black up
+                sibling->color = RED;
+                x = parent;
+                above.pop_back();
+                xIsLeft = grandparent && grandparent->left.get() == parent.get();
+                continue;
+            }
+            if (colorOf(sibling->right) == BLACK) {
+                // Case 3: near child red - rotate it into the far position
+                MutableNode near = copyOf(sibling->left);
+                near->color = BLACK;
+                sibling->color = RED;
+                rotateRight(sibling, near);
+                parent->right = near;
+                sibling = near;
+            }
+            // Case 4: far child red - one rotation at the parent finishes
+            MutableNode far = copyOf(sibling->right);
+            sibling->right = far;
+            sibling->color = parent->color;
+            parent->color = BLACK;
+            far->color = BLACK;
+            rotateLeft(parent, sibling);
+            replaceChild(root, grandparent, parent.get(), sibling);
+        } else {
+            MutableNode sibling = copyOf(parent->left);
+            parent->left = sibling;
+
+            if (sibling->color == RED) {
+                sibling->color = BLACK;
+                parent->color = RED;
+                rotateRight(parent, sibling);
+                replaceChild(root, grandparent, parent.get(), sibling);
+                above.insert(above.end() - 1, sibling);
+                grandparent = sibling;
+                sibling = copyOf(parent->left);
+                parent->left = sibling;
+            }
+
+            if (colorOf(sibling->right) == BLACK && colorOf(sibling->left) == BLACK) {
+                sibling->color = RED;
+                x = parent;
+                above.pop_back();
+                xIsLeft = grandparent && grandparent->left.get() == parent.get();
+                continue;
+            }
+            if (colorOf(sibling->left) == BLACK) {
+                MutableNode near = copyOf(sibling->right);
+                near->color = BLACK;
+                sibling->color = RED;
+                rotateLeft(sibling, near);
+                parent->left = near;
+                sibling = near;
+            }
+            MutableNode far = copyOf(sibling->left);
+            sibling->left = far;
+            sibling->color = parent->color;
+            parent->color = BLACK;
+            far->color = BLACK;
+            rotateRight(parent, sibling);
+            replaceChild(root, grandparent, parent.get(), sibling);
+        }
+        x = root;
+        above.clear();
+    }
+
+    // The engine ends by colouring x black
+    if (x && x->color == RED) {
+        MutableNode blackX = copyOf(x);
+        blackX->color = BLACK;
+        replaceChild(root, above.empty() ? nullptr : above.back(), x.get(), blackX);
+    }
+    return PersistentRBTree(root, count - 1);
+}
+
+void PersistentRBTree::diff(const PersistentRBTree &a, const PersistentRBTree &b,
+                            std::vector<int> &onlyInA, std::vector<int> &onlyInB)
+{
+    // A merge of the two in-order sequences. Whenever both cursors are about
+    // to enter the same shared subtree, its keys match pairwise, so it is
+    // skipped in one step.
+    DiffCursor left(a.root()), right(b.root());
+    while (true) {
+        if (left.pending && left.pending == right.pending) {
+            left.pending = right.pending = nullptr;
+        } else if (left.pending || right.pending) {
+            if (left.pending) left.descend();
+            if (right.pending) right.descend();
+        } else {
+            const Node *inA = left.next();
+            const Node *inB = right.next();
+            if (!inA && !inB) break;
+            if (inA && (!inB || inA->value < inB->value)) {
+                onlyInA.push_back(inA->value);
+                left.pop();
+            } else if (inB && (!inA || inB->value < inA->value)) {
+                onlyInB.push_back(inB->value);
+                right.pop();
+            } else {
+                left.pop();
+                right.pop();
+            }
+        }
+    }
+}
+
+RBVersionHistory::RBVersionHistory(RBTreeEngine &engine)
+    : engine(engine)
+{
+    history.push_back({PersistentRBTree::fromEngine(engine), Initial, engine.size()});
+    engine.addObserver(this);
+}
+
+RBVersionHistory::~RBVersionHistory()
+{
+    engine.removeObserver(this);
+}
+
+bool RBVersionHistory::restore(int index)
+{
+    if (index < 0 || index >= static_cast<int>(history.size())) return false;
+    current = index;
+    restoring = true;
+    engine.loadVersion(history[static_cast<std::size_t>(index)].tree);
+    restoring = false;
+    return true;
+}
+
+void RBVersionHistory::snapshot()
+{
+    commit(PersistentRBTree::fromEngine(engine), Reloaded, engine.size());
+}
+
+void RBVersionHistory::onEngineEvent(const EngineEvent &event)
+{
+    if (restoring) return;
+
+    const PersistentRBTree &tree = currentVersion().tree;
+    switch (event.type) {
+    case EngineEvent::NodeInserted:
+        // The version gets the finished insert; the engine may still be
+        // showing the leaf before its rebalance
+        commit(tree.insert(event.first), Inserted, event.first);
+        break;
+    case EngineEvent::NodeRemoved:
+        commit(tree.remove(event.first), Removed, event.first);
+        break;
+    case EngineEvent::Cleared:
+        commit(PersistentRBTree(), Cleared, 0);
+        afterClear = true;
+        return;
+    case EngineEvent::BulkLoaded:
+        if (afterClear) {
+            history.pop_back();
+            --current;
+        }
+        commit(PersistentRBTree::fromEngine(engine), Reloaded, event.first);
+        break;
+    default:
+        break;  // Rotations and recolourings are part of the insert or delete
+    }
+    afterClear = false;
+}
+
+void RBVersionHistory::commit(const PersistentRBTree &tree, Change change, int value)
+{
+    // A new edit drops the versions that could have been redone
+    history.erase(history.begin() + current + 1, history.end());
+    history.push_back({tree, change, value});
+    current = static_cast<int>(history.size()) - 1;
+}
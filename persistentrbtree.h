@@ -0,0 +1,100 @@
+#ifndef PERSISTENTRBTREE_H
+#define PERSISTENTRBTREE_H
+
+#include "engineobserver.h"
+#include "rbtreeengine.h"
+
+#include <memory>
+#include <vector>
+
+// Immutable Red-Black Tree. insert() and remove() copy only the nodes they
+// change - the search path plus the siblings and uncles the fix-ups
+// recolour, O(log n) in all - and return a new version sharing every other
+// node with the old one. A version is a cheap value: copying it is O(1),
+// and a copy stays readable for as long as it is held, from any thread and
+// without locks, whatever happens to the versions derived from it.
+//
+// The algorithms follow RBTreeEngine step for step, so the same operations
+// give the same shape and colours in both.
+class PersistentRBTree
+{
+public:
+    struct Node {
+        int value;
+        Color color;
+        std::shared_ptr<const Node> left;   // nullptr for leaves
+        std::shared_ptr<const Node> right;
+    };
+
+    PersistentRBTree() = default;
+    // O(n) copy of the engine's current shape
+    static PersistentRBTree fromEngine(const RBTreeEngine &engine);
+
+    PersistentRBTree insert(int value) const;  // Returns *this when already present
+    PersistentRBTree remove(int value) const;  // Returns *this when absent
+    bool contains(int value) const;
+
+    const Node* root() const { return rootNode.get(); }
+    int size() const { return count; }
+    std::vector<int> keys() const;  // Ascending
+
+    // Keys only in a and keys only in b, ascending. Subtrees the two
+    // versions share are skipped without being walked, so comparing
+    // versions a few edits apart costs O(d log n) for d differences.
+    static void diff(const PersistentRBTree &a, const PersistentRBTree &b,
+                     std::vector<int> &onlyInA, std::vector<int> &onlyInB);
+
+private:
+    PersistentRBTree(std::shared_ptr<const Node> root, int count) : rootNode(std::move(root)), count(count) {}
+
+    std::shared_ptr<const Node> rootNode;
+    int count = 0;
+};
+
+// Keeps every version of an RBTreeEngine by listening to it. Inserts and
+// deletes path-copy the previous version; bulk changes (BulkLoaded)
+// snapshot the engine. undo()/redo()/restore() load a kept version back
+// into the engine in O(n), with the exact shape it had.
+class RBVersionHistory : public EngineObserver
+{
+public:
+    enum Change { Initial, Inserted, Removed, Cleared, Reloaded };
+
+    struct Version {
+        PersistentRBTree tree;
+        Change change;
+        int value;  // Key inserted or removed; size for Reloaded
+    };
+
+    explicit RBVersionHistory(RBTreeEngine &engine);
+    ~RBVersionHistory() override;
+
+    const std::vector<Version> &versions() const { return history; }
+    int currentIndex() const { return current; }
+    const Version &currentVersion() const { return history[static_cast<std::size_t>(current)]; }
+
+    bool canUndo() const { return current > 0; }
+    bool canRedo() const { return current + 1 < static_cast<int>(history.size()); }
+    bool undo() { return canUndo() && restore(current - 1); }
+    bool redo() { return canRedo() && restore(current + 1); }
+    bool restore(int index);
+
+    // Record the engine as it is now - for changes made while detached
+    void snapshot();
+
+    void onEngineEvent(const EngineEvent &event) override;
+
+private:
+    void commit(const PersistentRBTree &tree, Change change, int value);
+
+    RBTreeEngine &engine;
+    std::vector<Version> history;
+    int current = 0;
+    bool restoring = false;
+    bool afterClear = false;  // A reload sends Cleared first; its version is replaced, not kept
+
+    RBVersionHistory(const RBVersionHistory&) = delete;
+    RBVersionHistory& operator=(const RBVersionHistory&) = delete;
+};
+
+#endif // PERSISTENTRBTREE_H
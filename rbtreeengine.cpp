@@ -0,0 +1,1072 @@
+#include "rbtreeengine.h"
+#include "persistentrbtree.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <future>
+#include <mutex>
+
+namespace {
+
+// A subtree handed around on its own: its root (parent cleared) and its
+// black height - black nodes on any root-to-leaf path, NIL not counted.
+// Carrying the height saves join from measuring it on every call.
+struct Tree {
+    RBNode *root;
+    int blackHeight;
+};
+
+// join/split and the set operations built on them. Nothing here emits
+// events or writes to the shared NIL, so disjoint subtrees can be worked on
+// from several threads at once.
+class JoinAlgebra
+{
+public:
+    struct Split {
+        Tree less;
+        RBNode *match;  // Node holding the split key, or nullptr
+        Tree greater;
+    };
+
+    JoinAlgebra(RBNode *nil, int parallelThreshold) : nil(nil), parallelThreshold(parallelThreshold) {}
+
+    Tree measured(RBNode *root) const
+    {
+        int blackHeight = 0;
+        for (RBNode *node = root; node != nil; node = node->left) {
+            if (node->color() == BLACK) ++blackHeight;
+        }
+        return {root, blackHeight};
+    }
+
+    // left ++ key ++ right, every key in left < key < every key in right
+    Tree join(Tree left, RBNode *key, Tree right)
+    {
+        // Black roots keep the red key from ever sitting on a red child
+        makeRootBlack(left);
+        makeRootBlack(right);
+
+        Tree result;
+        if (left.blackHeight > right.blackHeight) {
+            result = {joinRight(left.root, left.blackHeight, key, right.root, right.blackHeight), left.blackHeight};
+            if (result.root->color() == RED && result.root->right->color() == RED) {
+                result.root->setColor(BLACK);
+                ++result.blackHeight;
+            }
+        } else if (right.blackHeight > left.blackHeight) {
+            result = {joinLeft(left.root, left.blackHeight, key, right.root, right.blackHeight), right.blackHeight};
+            if (result.root->color() == RED && result.root->left->color() == RED) {
+                result.root->setColor(BLACK);
+                ++result.blackHeight;
+            }
+        } else {
+            result = {link(left.root, key, right.root, RED), left.blackHeight};
+        }
+        result.root->setParent(nullptr);
+        return result;
+    }
+
+    // left ++ right: the largest key of left becomes the middle key
+    Tree join2(Tree left, Tree right)
+    {
+        if (left.root == nil) return right;
+        RBNode *last = nullptr;
+        const Tree rest = splitLast(left, last);
+        return join(rest, last, right);
+    }
+
+    Split split(Tree tree, int key)
+    {
+        if (tree.root == nil) return {{nil, 0}, nullptr, {nil, 0}};
+
+        RBNode *node = tree.root;
+        const Tree left = detach(node->left, childHeight(tree));
+        const Tree right = detach(node->right, childHeight(tree));
+        if (key == node->value) return {left, node, right};
+
+        if (key < node->value) {
+            Split parts = split(left, key);
+            parts.greater = join(parts.greater, node, right);
+            return parts;
+        }
+        Split parts = split(right, key);
+        parts.less = join(left, node, parts.less);
+        return parts;
+    }
+
+    // Expose b's root, split a around it, recurse on both sides in
+    // parallel and join the halves back with b's root as the middle key
+    Tree unite(Tree a, Tree b)
+    {
+        if (a.root == nil) return b;
+        if (b.root == nil) return a;
+
+        const int work = a.root->size + b.root->size;
+        RBNode *key = b.root;
+        const Tree bLeft = detach(key->left, childHeight(b));
+        const Tree bRight = detach(key->right, childHeight(b));
+        const Split parts = split(a, key->value);
+        if (parts.match) discardNode(parts.match);
+
+        Tree left, right;
+        fork(work, [&] { left = unite(parts.less, bLeft); },
+                   [&] { right = unite(parts.greater, bRight); });
+        return join(left, key, right);
+    }
+
+    Tree intersect(Tree a, Tree b)
+    {
+        if (a.root == nil || b.root == nil) {
+            discard(a.root);
+            discard(b.root);
+            return {nil, 0};
+        }
+
+        const int work = a.root->size + b.root->size;
+        RBNode *key = b.root;
+        const Tree bLeft = detach(key->left, childHeight(b));
+        const Tree bRight = detach(key->right, childHeight(b));
+        const Split parts = split(a, key->value);
+
+        Tree left, right;
+        fork(work, [&] { left = intersect(parts.less, bLeft); },
+                   [&] { right = intersect(parts.greater, bRight); });
+        if (parts.match) {
+            discardNode(parts.match);
+            return join(left, key, right);
+        }
+        discardNode(key);
+        return join2(left, right);
+    }
+
+    // Keys of a that b lacks
+    Tree difference(Tree a, Tree b)
+    {
+        if (a.root == nil || b.root == nil) {
+            discard(b.root);
+            return a;
+        }
+
+        const int work = a.root->size + b.root->size;
+        RBNode *key = b.root;
+        const Tree bLeft = detach(key->left, childHeight(b));
+        const Tree bRight = detach(key->right, childHeight(b));
+        const Split parts = split(a, key->value);
+
+        Tree left, right;
+        fork(work, [&] { left = difference(parts.less, bLeft); },
+                   [&] { right = difference(parts.greater, bRight); });
+        discardNode(key);
+        if (parts.match) discardNode(parts.match);
+        return join2(left, right);
+    }
+
+    // Point every leaf link of a tree adopted from another engine at our NIL
+    void repoint(RBNode *node, const RBNode *foreignNil)
+    {
+        if (node == foreignNil) return;
+        fork(node->size, [&] { repoint(node->left, foreignNil); },
+                         [&] { repoint(node->right, foreignNil); });
+        if (node->left == foreignNil) node->left = nil;
+        if (node->right == foreignNil) node->right = nil;
+    }
+
+    void discard(RBNode *subtree)
+    {
+        if (subtree == nil) return;
+        std::lock_guard<std::mutex> lock(discardMutex);
+        discarded.push_back(subtree);
+    }
+
+    void discardNode(RBNode *node)
+    {
+        node->left = node->right = nil;
+        discard(node);
+    }
+
+    // Back on the calling thread: hand every dropped node to the arena
+    void releaseDiscarded(NodeArena<RBNode> &nodes)
+    {
+        while (!discarded.empty()) {
+            RBNode *node = discarded.back();
+            discarded.pop_back();
+            if (node->left != nil) discarded.push_back(node->left);
+            if (node->right != nil) discarded.push_back(node->right);
+            nodes.destroy(node);
+        }
+    }
+
+private:
+    int childHeight(const Tree &tree) const
+    {
+        return tree.blackHeight - (tree.root->color() == BLACK ? 1 : 0);
+    }
+
+    Tree detach(RBNode *node, int blackHeight) const
+    {
+        if (node != nil) node->setParent(nullptr);
+        return {node, blackHeight};
+    }
+
+    void makeRootBlack(Tree &tree) const
+    {
+        if (tree.root->color() == RED) {
+            tree.root->setColor(BLACK);
+            ++tree.blackHeight;
+        }
+    }
+
+    RBNode* link(RBNode *left, RBNode *node, RBNode *right, Color color) const
+    {
+        node->left = left;
+        node->right = right;
+        if (left != nil) left->setParent(node);
+        if (right != nil) right->setParent(node);
+        node->setColor(color);
+        node->size = left->size + right->size + 1;
+        return node;
+    }
+
+    // Walk down left's right spine to the black node as tall as right, hang
+    // key there, and fix red-red pairs with one rotation per level on the way up
+    RBNode* joinRight(RBNode *left, int leftHeight, RBNode *key, RBNode *right, int rightHeight) const
+    {
+        if (left->color() == BLACK && leftHeight == rightHeight) {
+            return link(left, key, right, RED);
+        }
+        const int below = leftHeight - (left->color() == BLACK ? 1 : 0);
+        RBNode *child = joinRight(left->right, below, key, right, rightHeight);
+        link(left->left, left, child, left->color());
+        if (left->color() == BLACK && child->color() == RED && child->right->color() == RED) {
+            child->right->setColor(BLACK);
+            return rotateLeft(left);
+        }
+        return left;
+    }
+
+    RBNode* joinLeft(RBNode *left, int leftHeight, RBNode *key, RBNode *right, int rightHeight) const
+    {
+        if (right->color() == BLACK && rightHeight == leftHeight) {
+            return link(left, key, right, RED);
+        }
+        const int below = rightHeight - (right->color() == BLACK ? 1 : 0);
+        RBNode *child = joinLeft(left, leftHeight, key, right->left, below);
+        link(child, right, right->right, right->color());
+        if (right->color() == BLACK && child->color() == RED && child->left->color() == RED) {
+            child->left->setColor(BLACK);
+            return rotateRight(right);
+        }
+        return right;
+    }
+
+    // Colours stay with their nodes; the caller links the new subtree root
+    RBNode* rotateLeft(RBNode *node) const
+    {
+        RBNode *pivot = node->right;
+        link(node->left, node, pivot->left, node->color());
+        return link(node, pivot, pivot->right, pivot->color());
+    }
+
+    RBNode* rotateRight(RBNode *node) const
+    {
+        RBNode *pivot = node->left;
+        link(pivot->right, node, node->right, node->color());
+        return link(pivot->left, pivot, node, pivot->color());
+    }
+
+    Tree splitLast(Tree tree, RBNode *&last)
+    {
+        RBNode *node = tree.root;
+        const Tree left = detach(node->left, childHeight(tree));
+        const Tree right = detach(node->right, childHeight(tree));
+        if (right.root == nil) {
+            last = node;
+            return left;
+        }
+        const Tree rest = splitLast(right, last);
+        return join(left, node, rest);
+    }
+
+    // Run both halves, the first as a pool task when there is enough work.
+    // Waiting helps drain the queue, so nested forks cannot starve the pool.
+    template<typename First, typename Second>
+    void fork(int work, First &&first, Second &&second)
+    {
+        if (work <= parallelThreshold) {
+            first();
+            second();
+            return;
+        }
+        ThreadPool &pool = ThreadPool::instance();
+        std::future<void> pending = pool.submit(std::forward<First>(first));
+        second();
+        pool.wait(pending);
+    }
+
+    RBNode *nil;
+    int parallelThreshold;
+    std::mutex discardMutex;
+    std::vector<RBNode*> discarded;  // Subtree roots; freed after the parallel part
+};
+
+RBNode* copyVersionSubtree(const PersistentRBTree::Node *node, RBNode *parent,
+                           NodeArena<RBNode> &nodes, RBNode *nil)
+{
+    if (!node) return nil;
+    RBNode *copy = nodes.create(node->value);
+    copy->setParent(parent);
+    copy->setColor(node->color);
+    copy->left = copyVersionSubtree(node->left.get(), copy, nodes, nil);
+    copy->right = copyVersionSubtree(node->right.get(), copy, nodes, nil);
+    copy->size = copy->left->size + copy->right->size + 1;
+    return copy;
+}
+
+} // namespace
+
+RBTreeEngine::RBTreeEngine()
+{
+    // Initialize NIL node (sentinel)
+    NIL = new RBNode(0);
+    NIL->setColor(BLACK);
+    NIL->size = 0;
+    NIL->left = NIL->right = nullptr;
+    rootNode = NIL;
+}
+
+RBTreeEngine::~RBTreeEngine()
+{
+    delete NIL;  // The arena frees the tree's nodes
+}
+
+bool RBTreeEngine::insert(int value, RBNode **inserted, bool rebalance)
+{
+    finishRebalance();
+
+    // One descent finds the parent and catches duplicates on the way
+    RBNode *parent = nullptr;
+    RBNode *current = rootNode;
+    while (current != NIL) {
+        if (value == current->value) {
+            return false;
+        }
+        parent = current;
+        current = value < current->value ? current->left : current->right;
+    }
+
+    RBNode *node = nodes.create(value);
+    node->left = node->right = NIL;
+    node->setParent(parent);
+
+    if (!parent) {
+        rootNode = node;
+    } else if (value < parent->value) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+    for (RBNode *ancestor = parent; ancestor; ancestor = ancestor->parent()) {
+        ++ancestor->size;
+    }
+
+    ++nodeCount;
+    // The fix-up only rotates and recolours around the path to the new key
+    lastPathKey = value;
+    hasLastPath = true;
+    emitEvent({EngineEvent::NodeInserted, value});
+    if (inserted) *inserted = node;
+
+    fix = Fix::Insert;
+    fixNode = node;
+    planInsertCase();
+    if (rebalance) finishRebalance();
+    return true;
+}
+
+bool RBTreeEngine::remove(int value, bool rebalance)
+{
+    finishRebalance();
+
+    RBNode *node = findNode(rootNode, value);
+    if (node == NIL) {
+        return false;
+    }
+
+    deleteNode(node);
+    --nodeCount;
+    emitEvent({EngineEvent::NodeRemoved, value});
+    if (rebalance) finishRebalance();
+    return true;
+}
+
+void RBTreeEngine::rebalanceStep()
+{
+    if (!isRebalancePending()) return;
+
+    const FixStep &step = fixSteps[nextFixStep++];
+    switch (step.kind) {
+    case FixStep::Recolor:     recolor(step.node, step.color); break;
+    case FixStep::RotateLeft:  rotateLeft(step.node); break;
+    case FixStep::RotateRight: rotateRight(step.node); break;
+    }
+
+    // The next case depends on the shape this one left behind
+    if (!isRebalancePending()) {
+        if (fix == Fix::Insert) planInsertCase();
+        else planDeleteCase();
+    }
+}
+
+void RBTreeEngine::finishRebalance()
+{
+    while (isRebalancePending()) rebalanceStep();
+}
+
+void RBTreeEngine::queueStep(FixStep::Kind kind, RBNode *node, Color color)
+{
+    // A recolouring that changes nothing would only cost the lab a frame
+    if (kind == FixStep::Recolor && (node == NIL || node->color() == color)) return;
+    fixSteps[fixStepCount++] = {kind, node, color};
+}
+
+bool RBTreeEngine::buildFromSorted(const std::vector<int> &values)
+{
+    if (values.size() > static_cast<std::size_t>(INT_MAX)) return false;
+    for (std::size_t i = 1; i < values.size(); ++i) {
+        if (values[i - 1] >= values[i]) return false;
+    }
+
+    clear();
+    if (values.empty()) return true;
+
+    // Midpoint splits keep every subtree's halves within one node of each
+    // other, so all leaves sit on the last two levels. Only the last level
+    // can be partial: colouring it red and everything above black gives
+    // every path the same black height.
+    const int n = static_cast<int>(values.size());
+    int redDepth = 0;
+    while ((2LL << redDepth) - 1 < n) ++redDepth;  // Depth of the deepest level
+
+    rootNode = buildBalanced(values, 0, n - 1, 0, redDepth);
+    rootNode->setParent(nullptr);
+    rootNode->setColor(BLACK);
+    nodeCount = n;
+    emitEvent({EngineEvent::BulkLoaded, n});
+    return true;
+}
+
+void RBTreeEngine::loadVersion(const PersistentRBTree &version)
+{
+    nodes.releaseAll();
+    rootNode = copyVersionSubtree(version.root(), nullptr, nodes, NIL);
+    nodeCount = version.size();
+    hasLastPath = false;
+    dropRebalance();
+    emitEvent(EngineEvent::Cleared);
+    emitEvent({EngineEvent::BulkLoaded, nodeCount});
+}
+
+RBNode* RBTreeEngine::buildBalanced(const std::vector<int> &values, int lo, int hi, int depth, int redDepth)
+{
+    if (lo > hi) return NIL;
+
+    const int mid = lo + (hi - lo) / 2;
+    RBNode *node = nodes.create(values[mid]);
+    node->size = hi - lo + 1;
+    node->setColor(depth == redDepth ? RED : BLACK);
+    node->left = buildBalanced(values, lo, mid - 1, depth + 1, redDepth);
+    node->right = buildBalanced(values, mid + 1, hi, depth + 1, redDepth);
+    if (node->left != NIL) node->left->setParent(node);
+    if (node->right != NIL) node->right->setParent(node);
+    return node;
+}
+
+RBNode* RBTreeEngine::lowerBound(int value) const
+{
+    RBNode *best = NIL;
+    RBNode *current = rootNode;
+    while (current != NIL) {
+        if (current->value >= value) {
+            best = current;  // Candidate - a smaller one may be on the left
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    return best;
+}
+
+RBNode* RBTreeEngine::upperBound(int value) const
+{
+    RBNode *best = NIL;
+    RBNode *current = rootNode;
+    while (current != NIL) {
+        if (current->value > value) {
+            best = current;
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+    return best;
+}
+
+const RBNode* RBTreeEngine::successorOf(const RBNode *node, const RBNode *nil)
+{
+    if (node == nil) return nil;
+
+    // Leftmost node of the right subtree...
+    if (node->right != nil) {
+        node = node->right;
+        while (node->left != nil) node = node->left;
+        return node;
+    }
+    // ...or the first ancestor we reach from its left side
+    const RBNode *parent = node->parent();
+    while (parent && node == parent->right) {
+        node = parent;
+        parent = parent->parent();
+    }
+    return parent ? parent : nil;
+}
+
+RBNode* RBTreeEngine::select(int k, std::vector<RBNode*> *path) const
+{
+    if (k < 0 || k >= nodeCount) return NIL;
+
+    RBNode *current = rootNode;
+    while (current != NIL) {
+        if (path) path->push_back(current);
+        const int leftSize = current->left->size;
+        if (k < leftSize) {
+            current = current->left;
+        } else if (k == leftSize) {
+            return current;
+        } else {
+            k -= leftSize + 1;  // Skip the left subtree and this node
+            current = current->right;
+        }
+    }
+    return NIL;
+}
+
+int RBTreeEngine::rank(int value, std::vector<RBNode*> *path) const
+{
+    return countBelow(value, false, path);
+}
+
+int RBTreeEngine::countAtMost(int value, std::vector<RBNode*> *path) const
+{
+    return countBelow(value, true, path);
+}
+
+int RBTreeEngine::countInRange(int lo, int hi) const
+{
+    if (lo > hi) return 0;
+    return countAtMost(hi) - rank(lo);
+}
+
+int RBTreeEngine::countBelow(int value, bool inclusive, std::vector<RBNode*> *path) const
+{
+    // Every time the walk goes right, the node and its left subtree are below value
+    int count = 0;
+    RBNode *current = rootNode;
+    while (current != NIL) {
+        if (path) path->push_back(current);
+        if (value < current->value || (!inclusive && value == current->value)) {
+            current = current->left;
+        } else {
+            count += current->left->size + 1;
+            current = current->right;
+        }
+    }
+    return count;
+}
+
+bool RBTreeEngine::join(int key, RBTreeEngine &right)
+{
+    if (&right == this) return false;
+    if (lowerBound(key) != NIL || right.countAtMost(key) > 0) return false;
+
+    JoinAlgebra algebra(NIL, parallelMergeThreshold);
+    const Tree left = algebra.measured(rootNode);
+    const Tree upper = algebra.measured(takeTree(right));
+    installRoot(algebra.join(left, nodes.create(key), upper).root);
+    return true;
+}
+
+bool RBTreeEngine::split(int key, RBTreeEngine &greater)
+{
+    if (&greater == this) return false;
+
+    JoinAlgebra algebra(NIL, parallelMergeThreshold);
+    const JoinAlgebra::Split parts = algebra.split(algebra.measured(rootNode), key);
+
+    // greater has its own arena, so the upper part is rebuilt there
+    std::vector<int> upper;
+    upper.reserve(static_cast<std::size_t>(parts.greater.root->size));
+    if (parts.greater.root != NIL) {
+        for (const RBNode *node = findMin(parts.greater.root); node != NIL; node = successorOf(node, NIL)) {
+            upper.push_back(node->value);
+        }
+    }
+    greater.buildFromSorted(upper);
+
+    algebra.discard(parts.greater.root);
+    if (parts.match) algebra.discardNode(parts.match);
+    algebra.releaseDiscarded(nodes);
+    installRoot(parts.less.root);
+    return parts.match != nullptr;
+}
+
+void RBTreeEngine::unionWith(RBTreeEngine &other)
+{
+    if (&other != this) applySetOperation(other, SetOperation::Union);
+}
+
+void RBTreeEngine::intersectWith(RBTreeEngine &other)
+{
+    if (&other != this) applySetOperation(other, SetOperation::Intersection);
+}
+
+void RBTreeEngine::differenceWith(RBTreeEngine &other)
+{
+    if (&other == this) {
+        clear();
+        return;
+    }
+    applySetOperation(other, SetOperation::Difference);
+}
+
+void RBTreeEngine::applySetOperation(RBTreeEngine &other, SetOperation operation)
+{
+    JoinAlgebra algebra(NIL, parallelMergeThreshold);
+    const Tree a = algebra.measured(rootNode);
+    const Tree b = algebra.measured(takeTree(other));
+
+    Tree result{NIL, 0};
+    switch (operation) {
+    case SetOperation::Union:        result = algebra.unite(a, b); break;
+    case SetOperation::Intersection: result = algebra.intersect(a, b); break;
+    case SetOperation::Difference:   result = algebra.difference(a, b); break;
+    }
+    algebra.releaseDiscarded(nodes);
+    installRoot(result.root);
+}
+
+RBNode* RBTreeEngine::takeTree(RBTreeEngine &source)
+{
+    RBNode *root = source.rootNode;
+    if (root != source.NIL) {
+        JoinAlgebra(NIL, parallelMergeThreshold).repoint(root, source.NIL);
+        nodes.adopt(source.nodes);
+    } else {
+        root = NIL;
+    }
+    source.rootNode = source.NIL;
+    source.nodeCount = 0;
+    source.hasLastPath = false;
+    source.dropRebalance();
+    source.emitEvent(EngineEvent::Cleared);
+    return root;
+}
+
+void RBTreeEngine::installRoot(RBNode* root)
+{
+    rootNode = root;
+    if (rootNode != NIL) {
+        rootNode->setParent(nullptr);
+        rootNode->setColor(BLACK);
+    }
+    nodeCount = rootNode->size;
+    hasLastPath = false;
+    dropRebalance();
+    emitEvent(EngineEvent::Cleared);
+    emitEvent({EngineEvent::BulkLoaded, nodeCount});
+}
+
+void RBTreeEngine::clear()
+{
+    nodes.releaseAll();  // O(1) - no walk over the tree
+    rootNode = NIL;
+    nodeCount = 0;
+    hasLastPath = false;
+    dropRebalance();
+    emitEvent(EngineEvent::Cleared);
+}
+
+void RBTreeEngine::planInsertCase()
+{
+    fixStepCount = nextFixStep = 0;
+    if (!fixNode) return;
+
+    RBNode *node = fixNode;
+    RBNode *parent = node->parent();
+    // Done once the parent is black, or is the root with no grandparent
+    if (!parent || parent->color() == BLACK || !parent->parent()) {
+        fixNode = nullptr;
+        queueStep(FixStep::Recolor, rootNode, BLACK);
+        return;
+    }
+
+    RBNode *grandparent = parent->parent();
+    const bool parentIsLeft = parent == grandparent->left;
+    RBNode *uncle = parentIsLeft ? grandparent->right : grandparent->left;
+
+    if (uncle->color() == RED) {
+        // Case 1: Uncle is red - push the red up to the grandparent
+        queueStep(FixStep::Recolor, parent, BLACK);
+        queueStep(FixStep::Recolor, uncle, BLACK);
+        queueStep(FixStep::Recolor, grandparent, RED);
+        fixNode = grandparent;
+    } else if (node == (parentIsLeft ? parent->right : parent->left)) {
+        // Case 2: Triangle - convert to line; the parent becomes the low node
+        queueStep(parentIsLeft ? FixStep::RotateLeft : FixStep::RotateRight, parent);
+        fixNode = parent;
+    } else {
+        // Case 3: Line - one rotation at the grandparent finishes
+        queueStep(FixStep::Recolor, parent, BLACK);
+        queueStep(FixStep::Recolor, grandparent, RED);
+        queueStep(parentIsLeft ? FixStep::RotateRight : FixStep::RotateLeft, grandparent);
+    }
+}
+
+void RBTreeEngine::rotateLeft(RBNode* node)
+{
+    if (!node || node->right == NIL) return;
+
+    RBNode *rightChild = node->right;
+    node->right = rightChild->left;
+
+    if (rightChild->left != NIL) {
+        rightChild->left->setParent(node);
+    }
+
+    rightChild->setParent(node->parent());
+
+    if (!node->parent()) {
+        rootNode = rightChild;
+    } else if (node == node->parent()->left) {
+        node->parent()->left = rightChild;
+    } else {
+        node->parent()->right = rightChild;
+    }
+
+    rightChild->left = node;
+    node->setParent(rightChild);
+
+    // rightChild now roots what node used to root
+    rightChild->size = node->size;
+    updateSize(node);
+    emitEvent({EngineEvent::Rotated, node->value, rightChild->value});
+}
+
+void RBTreeEngine::rotateRight(RBNode* node)
+{
+    if (!node || node->left == NIL) return;
+
+    RBNode *leftChild = node->left;
+    node->left = leftChild->right;
+
+    if (leftChild->right != NIL) {
+        leftChild->right->setParent(node);
+    }
+
+    leftChild->setParent(node->parent());
+
+    if (!node->parent()) {
+        rootNode = leftChild;
+    } else if (node == node->parent()->right) {
+        node->parent()->right = leftChild;
+    } else {
+        node->parent()->left = leftChild;
+    }
+
+    leftChild->right = node;
+    node->setParent(leftChild);
+
+    leftChild->size = node->size;
+    updateSize(node);
+    emitEvent({EngineEvent::Rotated, node->value, leftChild->value});
+}
+
+void RBTreeEngine::transplant(RBNode* u, RBNode* v)
+{
+    // Replace the subtree rooted at u with the one rooted at v. v may be NIL:
+    // its parent is still set so the delete fix-up can climb from it.
+    if (!u->parent()) {
+        rootNode = v;
+    } else if (u == u->parent()->left) {
+        u->parent()->left = v;
+    } else {
+        u->parent()->right = v;
+    }
+    v->setParent(u->parent());
+}
+
+void RBTreeEngine::deleteNode(RBNode* z)
+{
+    // CLRS RB-DELETE: y is the node that actually leaves its position
+    // (z itself, or z's successor), x is the node that moves into y's place
+    RBNode *y = z;
+    Color yOriginalColor = y->color();
+    RBNode *x;
+
+    if (z->left == NIL) {
+        x = z->right;
+        transplant(z, z->right);
+    } else if (z->right == NIL) {
+        x = z->left;
+        transplant(z, z->left);
+    } else {
+        y = findMin(z->right);
+        yOriginalColor = y->color();
+        x = y->right;
+        if (y->parent() == z) {
+            x->setParent(y);  // Matters when x is NIL
+        } else {
+            transplant(y, y->right);
+            y->right = z->right;
+            y->right->setParent(y);
+        }
+        transplant(z, y);
+        y->left = z->left;
+        y->left->setParent(y);
+        recolor(y, z->color());
+    }
+
+    nodes.destroy(z);
+
+    // The fix-up works upwards from x's parent, rotating its siblings above
+    // it, so the path to that parent covers every node it reshapes
+    hasLastPath = x->parent() != nullptr;
+    if (hasLastPath) lastPathKey = x->parent()->value;
+
+    // Every subtree that lost a node lies on the path from x up; y is on it
+    // too when it moved into z's place. Fix sizes bottom-up before rotating.
+    for (RBNode *ancestor = x->parent(); ancestor; ancestor = ancestor->parent()) {
+        updateSize(ancestor);
+    }
+
+    // Removing a black node shortens every path through x by one
+    fix = Fix::Delete;
+    fixNode = yOriginalColor == BLACK ? x : nullptr;
+    fixParent = x->parent();
+    planDeleteCase();
+}
+
+void RBTreeEngine::planDeleteCase()
+{
+    fixStepCount = nextFixStep = 0;
+    if (!fixNode) return;
+
+    // x carries an extra black; push it up or absorb it with rotations
+    RBNode *x = fixNode;
+    if (x == rootNode || x->color() == RED) {
+        fixNode = nullptr;
+        queueStep(FixStep::Recolor, x, BLACK);
+        return;
+    }
+
+    RBNode *parent = fixParent;
+    const bool xIsLeft = x == parent->left;
+    RBNode *sibling = xIsLeft ? parent->right : parent->left;
+    RBNode *nearChild = xIsLeft ? sibling->left : sibling->right;
+    RBNode *farChild = xIsLeft ? sibling->right : sibling->left;
+    const FixStep::Kind towardX = xIsLeft ? FixStep::RotateLeft : FixStep::RotateRight;
+    const FixStep::Kind awayFromX = xIsLeft ? FixStep::RotateRight : FixStep::RotateLeft;
+
+    if (sibling->color() == RED) {
+        // Case 1: red sibling - rotate so the sibling is black
+        queueStep(FixStep::Recolor, sibling, BLACK);
+        queueStep(FixStep::Recolor, parent, RED);
+        queueStep(towardX, parent);
+    } else if (nearChild->color() == BLACK && farChild->color() == BLACK) {
+        // Case 2: black sibling with black children - move the extra black up
+        queueStep(FixStep::Recolor, sibling, RED);
+        fixNode = parent;
+        fixParent = parent->parent();
+    } else if (farChild->color() == BLACK) {
+        // Case 3: near child red - rotate it into the far position
+        queueStep(FixStep::Recolor, nearChild, BLACK);
+        queueStep(FixStep::Recolor, sibling, RED);
+        queueStep(awayFromX, sibling);
+    } else {
+        // Case 4: far child red - one rotation at the parent finishes, and
+        // the sibling takes the parent's place and colour (black at the root)
+        queueStep(FixStep::Recolor, sibling, parent->color());
+        queueStep(FixStep::Recolor, parent, BLACK);
+        queueStep(FixStep::Recolor, farChild, BLACK);
+        queueStep(towardX, parent);
+        fixNode = nullptr;
+    }
+}
+
+void RBTreeEngine::recolor(RBNode* node, Color color)
+{
+    if (node == NIL || node->color() == color) return;
+    node->setColor(color);
+    emitEvent({EngineEvent::Recolored, node->value, color});
+}
+
+RBNode* RBTreeEngine::findMin(RBNode* node) const
+{
+    while (node && node->left != NIL) {
+        node = node->left;
+    }
+    return node;
+}
+
+RBNode* RBTreeEngine::findNode(RBNode* node, int value) const
+{
+    while (node != NIL && node->value != value) {
+        node = value < node->value ? node->left : node->right;
+    }
+    return node;
+}
+
+RBCheckReport RBTreeEngine::checkInvariants(CheckScope scope) const
+{
+    const auto start = std::chrono::steady_clock::now();
+    RBCheckReport report;
+
+    auto fail = [&report](std::string violation) {
+        if (report.valid) {
+            report.valid = false;
+            report.violation = std::move(violation);
+        }
+    };
+    if (NIL->color() != BLACK || NIL->size != 0) fail("NIL sentinel is not black with size 0");
+    if (rootNode->color() != BLACK) fail("root " + std::to_string(rootNode->value) + " is red");
+    if (rootNode != NIL && rootNode->parent()) fail("root " + std::to_string(rootNode->value) + " has a parent");
+    if (rootNode->size != nodeCount) {
+        fail("root size " + std::to_string(rootNode->size) + " but " + std::to_string(nodeCount) + " nodes counted");
+    }
+
+    if (scope == CheckScope::Full) {
+        checkSubtree(rootNode, nullptr, LLONG_MIN, LLONG_MAX, report);
+    } else {
+        // Walk the reshaped path with the key bounds a full check would use.
+        // The fix-ups also recolour and rotate the children hanging off it,
+        // so those are checked too. Deeper subtrees were not touched, so
+        // their black height is read down their left spine, not recomputed.
+        auto checkBalance = [&](const RBNode *node) {
+            const int leftHeight = blackHeightOf(node->left);
+            const int rightHeight = blackHeightOf(node->right);
+            if (leftHeight != rightHeight) {
+                fail("black heights " + std::to_string(leftHeight) + " and " + std::to_string(rightHeight) +
+                     " below " + std::to_string(node->value));
+            }
+        };
+        const RBNode *parent = nullptr;
+        const RBNode *node = rootNode;
+        long long lo = LLONG_MIN, hi = LLONG_MAX;
+        while (node != NIL && report.valid) {
+            checkNode(node, parent, lo, hi, report);
+            checkBalance(node);
+            if (node->left != NIL) {
+                checkNode(node->left, node, lo, node->value, report);
+                checkBalance(node->left);
+            }
+            if (node->right != NIL) {
+                checkNode(node->right, node, node->value, hi, report);
+                checkBalance(node->right);
+            }
+            if (!hasLastPath || lastPathKey == node->value) break;
+            parent = node;
+            if (lastPathKey < node->value) {
+                hi = node->value;
+                node = node->left;
+            } else {
+                lo = node->value;
+                node = node->right;
+            }
+        }
+    }
+
+    report.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+int RBTreeEngine::checkSubtree(const RBNode *node, const RBNode *parent, long long lo, long long hi,
+                               RBCheckReport &report) const
+{
+    if (node == NIL) return 0;
+    if (!checkNode(node, parent, lo, hi, report)) return -1;
+
+    const int leftHeight = checkSubtree(node->left, node, lo, node->value, report);
+    if (leftHeight < 0) return -1;
+    const int rightHeight = checkSubtree(node->right, node, node->value, hi, report);
+    if (rightHeight < 0) return -1;
+    if (leftHeight != rightHeight) {
+        report.valid = false;
+        report.violation = "black heights " + std::to_string(leftHeight) + " and " +
+                           std::to_string(rightHeight) + " below " + std::to_string(node->value);
+        return -1;
+    }
+    return leftHeight + (node->color() == BLACK ? 1 : 0);
+}
+
+bool RBTreeEngine::checkNode(const RBNode *node, const RBNode *parent, long long lo, long long hi,
+                             RBCheckReport &report) const
+{
+    // Everything that can be judged from the node and its children
+    ++report.nodesChecked;
+    const char *broken = nullptr;
+    if (node->value <= lo || node->value >= hi) {
+        broken = " is out of BST order";
+    } else if (node->parent() != parent) {
+        broken = " has a wrong parent link";
+    } else if (node->color() == RED && (node->left->color() == RED || node->right->color() == RED)) {
+        broken = " is red with a red child";
+    } else if (node->size != node->left->size + node->right->size + 1) {
+        broken = " has a wrong subtree size";
+    }
+    if (!broken) return true;
+    if (report.valid) {
+        report.valid = false;
+        report.violation = std::to_string(node->value) + broken;
+    }
+    return false;
+}
+
+int RBTreeEngine::blackHeightOf(const RBNode *node) const
+{
+    int blackHeight = 0;
+    for (; node != NIL; node = node->left) {
+        if (node->color() == BLACK) ++blackHeight;
+    }
+    return blackHeight;
+}
+
+int RBTreeEngine::height() const
+{
+    return getTreeHeight(rootNode);
+}
+
+int RBTreeEngine::getTreeHeight(RBNode *node) const
+{
+    if (node == NIL) return 0;
+    return 1 + std::max(getTreeHeight(node->left), getTreeHeight(node->right));
+}
+
+std::vector<RBNode*> RBTreeEngine::breadthFirstOrder() const
+{
+    std::vector<RBNode*> order;
+    order.reserve(nodeCount);
+    RBPolicy policy{{NIL}};
+    PolicyTraversal::breadthFirst(policy, rootNode, [&](RBNode *node) { order.push_back(node); });
+    return order;
+}
+
+std::vector<RBNode*> RBTreeEngine::depthFirstOrder() const
+{
+    std::vector<RBNode*> order;
+    order.reserve(nodeCount);
+    RBPolicy policy{{NIL}};
+    PolicyTraversal::depthFirst(policy, rootNode, [&](RBNode *node) { order.push_back(node); });
+    return order;
+}
@@ -0,0 +1,226 @@
+#ifndef RBTREEENGINE_H
+#define RBTREEENGINE_H
+
+#include "engineobserver.h"
+#include "nodearena.h"
+#include "treetraversal.h"
+#include "traversalpolicy.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum Color { RED, BLACK };
+
+class PersistentRBTree;
+
+// Only what the algorithms touch. The colour rides in the low bit of the
+// parent pointer (nodes are at least 4-byte aligned), so a node is a value,
+// a subtree size and three pointers. Drawing state lives in the lab - see
+// nodevisual.h.
+struct RBNode {
+    int value;
+    int size;  // Nodes in this subtree, itself included; 0 for NIL
+    RBNode *left;
+    RBNode *right;
+
+    explicit RBNode(int val) : value(val), size(1), left(nullptr), right(nullptr),
+        parentAndColor(RED) {}
+
+    RBNode* parent() const { return reinterpret_cast<RBNode*>(parentAndColor & ~COLOR_BIT); }
+    void setParent(RBNode *node) { parentAndColor = reinterpret_cast<std::uintptr_t>(node) | (parentAndColor & COLOR_BIT); }
+    Color color() const { return static_cast<Color>(parentAndColor & COLOR_BIT); }
+    void setColor(Color color) { parentAndColor = (parentAndColor & ~COLOR_BIT) | color; }
+
+private:
+    static constexpr std::uintptr_t COLOR_BIT = 1;
+    std::uintptr_t parentAndColor;
+};
+
+// For PolicyTraversal, built as RBPolicy{{engine.nil()}}
+using RBPolicy = BinaryTreePolicy<RBNode, SentinelChild<RBNode>>;
+
+// Result of RBTreeEngine::checkInvariants()
+struct RBCheckReport {
+    bool valid = true;
+    std::string violation;  // First broken property found, empty when valid
+    int nodesChecked = 0;
+    long long nanoseconds = 0;
+};
+
+// Headless Red-Black Tree - the algorithms behind the Red-Black lab,
+// without widgets or timers, so operations can run at full speed.
+// Leaves point at a shared black NIL sentinel; the root's parent is nullptr.
+class RBTreeEngine : public ObservableEngine
+{
+public:
+    // In-order iterator that climbs parent pointers - no stack, no list.
+    // Advancing is amortised O(1); end() is the NIL sentinel.
+    class ConstIterator
+    {
+    public:
+        ConstIterator(const RBNode *node, const RBNode *nil) : node(node), nil(nil) {}
+
+        const RBNode &operator*() const { return *node; }
+        const RBNode *operator->() const { return node; }
+        ConstIterator &operator++() { node = successorOf(node, nil); return *this; }
+        bool operator==(const ConstIterator &other) const { return node == other.node; }
+        bool operator!=(const ConstIterator &other) const { return node != other.node; }
+
+    private:
+        const RBNode *node;
+        const RBNode *nil;
+    };
+
+    RBTreeEngine();
+    ~RBTreeEngine();
+
+    // With rebalance false, insert and remove leave the Red-Black fix-up
+    // pending: rebalanceStep() then does one rotation or recolouring per
+    // call, so the lab can show each one. Other calls must wait until none
+    // is pending; clearing or replacing the tree drops it.
+    bool insert(int value, RBNode **inserted = nullptr, bool rebalance = true);
+    bool remove(int value, bool rebalance = true);
+    bool isRebalancePending() const { return nextFixStep < fixStepCount; }
+    void rebalanceStep();
+    // Replace the tree with a perfectly balanced one in O(n), no rotations.
+    // values must be strictly increasing; otherwise the tree is left as is.
+    bool buildFromSorted(const std::vector<int> &values);
+    // Replace the tree with a copy of a kept version, same shape and colours
+    void loadVersion(const PersistentRBTree &version);
+    RBNode* find(int value) const { return findNode(rootNode, value); }  // NIL when absent
+    bool contains(int value) const { return find(value) != NIL; }
+    void clear();
+
+    RBNode* root() const { return rootNode; }
+    RBNode* nil() const { return NIL; }
+    int size() const { return nodeCount; }
+    int height() const;
+    const NodeArenaStats &allocationStats() const { return nodes.stats(); }
+
+    // Ordered access - lowerBound/upperBound return NIL when no key qualifies
+    RBNode* lowerBound(int value) const;  // First key >= value
+    RBNode* upperBound(int value) const;  // First key > value
+    ConstIterator begin() const { return {rootNode == NIL ? NIL : findMin(rootNode), NIL}; }
+    ConstIterator end() const { return {NIL, NIL}; }
+    ConstIterator from(int value) const { return {lowerBound(value), NIL}; }
+    static const RBNode* successorOf(const RBNode *node, const RBNode *nil);
+
+    // Calls visit(node) for every key in [lo, hi] in ascending order and
+    // returns how many there were. Touches O(log n + k) nodes.
+    template<typename Visitor>
+    int rangeQuery(int lo, int hi, Visitor visit) const
+    {
+        int count = 0;
+        if (lo > hi) return count;
+        for (const RBNode *node = lowerBound(lo); node != NIL && node->value <= hi;
+             node = successorOf(node, NIL)) {
+            visit(node);
+            ++count;
+        }
+        return count;
+    }
+
+    // Join-based bulk operations (Blelloch, Ferizovic & Sun, "Just Join for
+    // Parallel Ordered Sets"). Nodes move between trees instead of being
+    // copied: this tree's arena adopts the other tree's blocks, and the
+    // other tree ends up empty.
+    //
+    // this ++ key ++ right. Every key here must be < key < every key in
+    // right; otherwise nothing changes and false is returned.
+    bool join(int key, RBTreeEngine &right);
+    // Keep the keys below key and move the keys above it into greater,
+    // replacing what greater held. Returns whether key was present (it is
+    // dropped). The upper part is rebuilt in greater's own arena, so this
+    // costs O(log n + k) for the k keys that move.
+    bool split(int key, RBTreeEngine &greater);
+
+    // Set algebra in place, each O(m log(n/m + 1)) work for sizes m <= n.
+    // Subproblems with more than parallelMergeThreshold nodes fork onto
+    // ThreadPool::instance().
+    void unionWith(RBTreeEngine &other);
+    void intersectWith(RBTreeEngine &other);
+    void differenceWith(RBTreeEngine &other);  // Keys here that other lacks
+    void setParallelMergeThreshold(int nodes) { parallelMergeThreshold = nodes; }
+
+    // Order statistics - O(log n) thanks to the subtree sizes. When path is
+    // given it receives every node visited, root first.
+    RBNode* select(int k, std::vector<RBNode*> *path = nullptr) const;  // k-th smallest, 0-based; NIL if out of range
+    int rank(int value, std::vector<RBNode*> *path = nullptr) const;        // Keys < value
+    int countAtMost(int value, std::vector<RBNode*> *path = nullptr) const; // Keys <= value
+    int countInRange(int lo, int hi) const;                                 // Keys in [lo, hi]
+
+    // Red-Black invariant checker: BST order, no red node with a red child,
+    // equal black heights, a black root, parent links and subtree sizes.
+    // Full walks every node, O(n). LastPath checks only the path the last
+    // insert or remove reshaped, plus the children hanging off it, in
+    // O(log^2 n) - cheap enough to run after every operation. With no such
+    // path (after a clear or a bulk change) it checks the root alone.
+    enum class CheckScope { Full, LastPath };
+    RBCheckReport checkInvariants(CheckScope scope = CheckScope::Full) const;
+
+    // Traversals - cursor() walks lazily, allocating only for a level
+    // order frontier; the *Order functions collect a whole walk for
+    // callers that want a list
+    TreeCursor<RBNode> cursor(TraversalOrder order) const { return {rootNode, NIL, order}; }
+    std::vector<RBNode*> breadthFirstOrder() const;
+    std::vector<RBNode*> depthFirstOrder() const;  // Preorder
+
+private:
+    enum class SetOperation { Union, Intersection, Difference };
+    void applySetOperation(RBTreeEngine &other, SetOperation operation);
+    RBNode* takeTree(RBTreeEngine &source);  // Adopts source's nodes, returns its root
+    void installRoot(RBNode* root);          // Adopt a rebuilt tree and report it
+
+    // Fix-up still owed after an insert or remove
+    enum class Fix {
+        Insert,  // fixNode is red and may have a red parent
+        Delete   // fixNode carries an extra black; fixParent is its parent
+    };
+    // One rotation or recolouring of the case being worked through
+    struct FixStep {
+        enum Kind { Recolor, RotateLeft, RotateRight } kind;
+        RBNode *node;
+        Color color;  // Recolor only
+    };
+
+    void planInsertCase();  // Queue the next case's steps, or the final ones
+    void planDeleteCase();
+    void queueStep(FixStep::Kind kind, RBNode *node, Color color = BLACK);
+    void finishRebalance();
+    void dropRebalance() { fixStepCount = nextFixStep = 0; fixNode = nullptr; }
+    void rotateLeft(RBNode* node);
+    void rotateRight(RBNode* node);
+    void recolor(RBNode* node, Color color);  // Reports the change
+    RBNode* findNode(RBNode* node, int value) const;
+    void transplant(RBNode* u, RBNode* v);
+    void deleteNode(RBNode* z);
+    RBNode* findMin(RBNode* node) const;
+    int countBelow(int value, bool inclusive, std::vector<RBNode*> *path) const;
+    void updateSize(RBNode* node) { node->size = node->left->size + node->right->size + 1; }
+    RBNode* buildBalanced(const std::vector<int> &values, int lo, int hi, int depth, int redDepth);
+    int getTreeHeight(RBNode *node) const;
+    int checkSubtree(const RBNode *node, const RBNode *parent, long long lo, long long hi, RBCheckReport &report) const;
+    bool checkNode(const RBNode *node, const RBNode *parent, long long lo, long long hi, RBCheckReport &report) const;
+    int blackHeightOf(const RBNode *node) const;
+
+    NodeArena<RBNode> nodes;  // Owns every node but NIL
+    RBNode *rootNode;
+    RBNode *NIL;  // Sentinel node
+    int nodeCount = 0;
+    int parallelMergeThreshold = 1 << 14;
+    // Bottom of the path the last insert or remove reshaped, for LastPath checks
+    int lastPathKey = 0;
+    bool hasLastPath = false;
+    Fix fix = Fix::Insert;
+    RBNode *fixNode = nullptr;    // Where the pending fix-up resumes; nullptr once it ends
+    RBNode *fixParent = nullptr;  // Delete only: NIL's parent link is shared, so kept here
+    FixStep fixSteps[4];          // Steps of the current case; no case takes more
+    int fixStepCount = 0;
+    int nextFixStep = 0;
+
+    RBTreeEngine(const RBTreeEngine&) = delete;
+    RBTreeEngine& operator=(const RBTreeEngine&) = delete;
+};
+
+#endif // RBTREEENGINE_H
@@ -7,11 +7,13 @@ RedBlackTree::RedBlackTree(QWidget *parent)
     , traversalType(TraversalType::None)
     , traversalIndex(0)
 {
-    // Initialize NIL node (sentinel)
-    NIL = new RBNode(0);
-    NIL->color = BLACK;
-    NIL->left = NIL->right = NIL->parent = nullptr;
-    root = NIL;
+    engine.addObserver(this);
+
+    // Insert and delete queue their steps here; every frame repaints
+    timeline = new AnimationTimeline(this);
+    connect(timeline, &AnimationTimeline::frameChanged, this, [this]() {
+        update();
+    });
 
     animationTimer = new QTimer(this);
     connect(animationTimer, &QTimer::timeout, this, [this]() {
@@ -21,6 +23,9 @@ RedBlackTree::RedBlackTree(QWidget *parent)
     traversalAnimTimer = new QTimer(this);
     connect(traversalAnimTimer, &QTimer::timeout, this, &RedBlackTree::onTraversalAnimationStep);
 
+    scanTimer = new QTimer(this);
+    connect(scanTimer, &QTimer::timeout, this, &RedBlackTree::onScanAnimationStep);
+
     setupUI();
     setMinimumSize(1200, 800);
 }
@@ -34,9 +39,11 @@ RedBlackTree::~RedBlackTree()
     if (traversalAnimTimer) {
         traversalAnimTimer->stop();
     }
-    
-    clearTree(root);
-    delete NIL;
+    if (scanTimer) {
+        scanTimer->stop();
+    }
+
+    engine.removeObserver(this);
 }
 
 void RedBlackTree::setupUI()
@@ -49,6 +56,10 @@ void RedBlackTree::setupUI()
     setupVisualizationArea();
     setupRightPanel();
     setupTraversalControls();
+    setupOrderStatisticsControls();
+    setupHistoryControls();
+    setupTimelineControls();
+    setupSessionControls();
     
     // Set splitter proportions (65% visualization, 35% controls+trace)
     mainSplitter->addWidget(leftPanel);
@@ -218,6 +229,48 @@ void RedBlackTree::setupVisualizationArea()
         QPushButton:disabled { background: #cccccc; }
     )");
 
+    bulkButton = new QPushButton("⚡ Bulk");
+    bulkButton->setFixedSize(75, 35);
+    bulkButton->setCursor(Qt::PointingHandCursor);
+    bulkButton->setToolTip("Insert N random values at once, without animation");
+    bulkButton->setStyleSheet(R"(
+        QPushButton {
+            background: qlineargradient(x1:0, y1:0, x2:1, y2:1,
+                stop:0 #f39c12, stop:1 #f5b041);
+            color: white;
+            border: none;
+            border-radius: 17px;
+            font-weight: bold;
+            font-size: 10px;
+        }
+        QPushButton:hover {
+            background: qlineargradient(x1:0, y1:0, x2:1, y2:1,
+                stop:0 #d68910, stop:1 #f39c12);
+        }
+        QPushButton:disabled { background: #cccccc; }
+    )");
+
+    loadButton = new QPushButton("📂 Load");
+    loadButton->setFixedSize(75, 35);
+    loadButton->setCursor(Qt::PointingHandCursor);
+    loadButton->setToolTip("Load a dataset of integer keys and build a balanced tree in O(n)");
+    loadButton->setStyleSheet(R"(
+        QPushButton {
+            background: qlineargradient(x1:0, y1:0, x2:1, y2:1,
+                stop:0 #16a085, stop:1 #1abc9c);
+            color: white;
+            border: none;
+            border-radius: 17px;
+            font-weight: bold;
+            font-size: 10px;
+        }
+        QPushButton:hover {
+            background: qlineargradient(x1:0, y1:0, x2:1, y2:1,
+                stop:0 #138d75, stop:1 #16a085);
+        }
+        QPushButton:disabled { background: #cccccc; }
+    )");
+
     // Buttons are already styled individually above
 
     // viewAlgorithmButton removed - algorithm now integrated in right panel
@@ -228,6 +281,8 @@ void RedBlackTree::setupVisualizationArea()
     controlLayout->addWidget(deleteButton);
     controlLayout->addWidget(clearButton);
     controlLayout->addWidget(randomizeButton);
+    controlLayout->addWidget(bulkButton);
+    controlLayout->addWidget(loadButton);
     controlLayout->addStretch();
 
     leftLayout->addLayout(controlLayout);
@@ -253,6 +308,8 @@ void RedBlackTree::setupVisualizationArea()
     connect(searchButton, &QPushButton::clicked, this, &RedBlackTree::onSearchClicked);
     connect(clearButton, &QPushButton::clicked, this, &RedBlackTree::onClearClicked);
     connect(randomizeButton, &QPushButton::clicked, this, &RedBlackTree::onRandomizeClicked);
+    connect(bulkButton, &QPushButton::clicked, this, &RedBlackTree::onBulkInsertClicked);
+    connect(loadButton, &QPushButton::clicked, this, &RedBlackTree::onLoadDatasetClicked);
     connect(inputField, &QLineEdit::returnPressed, this, &RedBlackTree::onInsertClicked);
 }
 
@@ -428,9 +485,11 @@ void RedBlackTree::addOperationSeparator()
 
 void RedBlackTree::updateStepTrace()
 {
-    stepsList->clear();
-    
-    for (const QString &step : stepHistory) {
+    // Only append steps added since the last refresh; clearing the history clears the list
+    if (stepHistory.size() < stepsList->count()) stepsList->clear();
+
+    for (int i = stepsList->count(); i < stepHistory.size(); ++i) {
+        const QString &step = stepHistory[i];
         QListWidgetItem *item = new QListWidgetItem(step);
         
         // Handle separators
@@ -820,10 +879,338 @@ void RedBlackTree::showAlgorithm(const QString &operation)
         spaceComp->setForeground(QColor(40, 167, 69));
         algorithmList->addItem(spaceComp);
     }
+    else if (operation == "OrderStatistics") {
+        // Title
+        QListWidgetItem *title = new QListWidgetItem("📊 Order Statistics (Select / Rank)");
+        title->setForeground(QColor(123, 79, 255));
+        title->setFont(QFont("Segoe UI", 12, QFont::Bold));
+        algorithmList->addItem(title);
+
+        // Step 1
+        QListWidgetItem *step1 = new QListWidgetItem("1️⃣ Every node stores its subtree size:");
+        step1->setForeground(QColor(52, 73, 94));
+        step1->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(step1);
+
+        QListWidgetItem *step1a = new QListWidgetItem("   • size = size(left) + size(right) + 1");
+        step1a->setForeground(QColor(108, 117, 125));
+        algorithmList->addItem(step1a);
+
+        QListWidgetItem *step1b = new QListWidgetItem("   • Rotations fix the two nodes they move");
+        step1b->setForeground(QColor(108, 117, 125));
+        algorithmList->addItem(step1b);
+
+        // Step 2
+        QListWidgetItem *step2 = new QListWidgetItem("2️⃣ Select(k): compare k with size(left)");
+        step2->setForeground(QColor(52, 73, 94));
+        step2->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(step2);
+
+        QListWidgetItem *less = new QListWidgetItem("   ⬅️ k < size(left) → go left");
+        less->setForeground(QColor(230, 126, 34));
+        algorithmList->addItem(less);
+
+        QListWidgetItem *equal = new QListWidgetItem("   🎯 k = size(left) → this node");
+        equal->setForeground(QColor(40, 167, 69));
+        algorithmList->addItem(equal);
+
+        QListWidgetItem *more = new QListWidgetItem("   ➡️ otherwise k -= size(left) + 1, go right");
+        more->setForeground(QColor(230, 126, 34));
+        algorithmList->addItem(more);
+
+        // Step 3
+        QListWidgetItem *step3 = new QListWidgetItem("3️⃣ Rank(v): going right skips size(left) + 1 smaller keys");
+        step3->setForeground(QColor(52, 73, 94));
+        step3->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(step3);
+
+        QListWidgetItem *step3a = new QListWidgetItem("   • Range [lo, hi] = count(≤ hi) - rank(lo)");
+        step3a->setForeground(QColor(108, 117, 125));
+        algorithmList->addItem(step3a);
+
+        // Complexity
+        QListWidgetItem *complexity = new QListWidgetItem("⏰ Time Complexity");
+        complexity->setForeground(QColor(155, 89, 182));
+        complexity->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(complexity);
+
+        QListWidgetItem *timeComp = new QListWidgetItem("   📊 O(log n) - one root-to-leaf walk");
+        timeComp->setForeground(QColor(40, 167, 69));
+        algorithmList->addItem(timeComp);
+    }
+    else if (operation == "RangeScan") {
+        // Title
+        QListWidgetItem *title = new QListWidgetItem("🔎 Range Scan [lo, hi]");
+        title->setForeground(QColor(243, 156, 18));
+        title->setFont(QFont("Segoe UI", 12, QFont::Bold));
+        algorithmList->addItem(title);
+
+        // Step 1
+        QListWidgetItem *step1 = new QListWidgetItem("1️⃣ lower_bound(lo): first key ≥ lo");
+        step1->setForeground(QColor(52, 73, 94));
+        step1->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(step1);
+
+        QListWidgetItem *step1a = new QListWidgetItem("   • Go left when key ≥ lo (remember it), else right");
+        step1a->setForeground(QColor(108, 117, 125));
+        algorithmList->addItem(step1a);
+
+        // Step 2
+        QListWidgetItem *step2 = new QListWidgetItem("2️⃣ Successor via parent pointers:");
+        step2->setForeground(QColor(52, 73, 94));
+        step2->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(step2);
+
+        QListWidgetItem *step2a = new QListWidgetItem("   ➡️ Right child? leftmost node of right subtree");
+        step2a->setForeground(QColor(230, 126, 34));
+        algorithmList->addItem(step2a);
+
+        QListWidgetItem *step2b = new QListWidgetItem("   ⬆️ Otherwise climb until coming up from a left child");
+        step2b->setForeground(QColor(230, 126, 34));
+        algorithmList->addItem(step2b);
+
+        // Step 3
+        QListWidgetItem *step3 = new QListWidgetItem("3️⃣ Stop at the first key > hi");
+        step3->setForeground(QColor(52, 73, 94));
+        step3->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(step3);
+
+        // Complexity
+        QListWidgetItem *complexity = new QListWidgetItem("⏰ Time Complexity");
+        complexity->setForeground(QColor(155, 89, 182));
+        complexity->setFont(QFont("Segoe UI", 11, QFont::Bold));
+        algorithmList->addItem(complexity);
+
+        QListWidgetItem *timeComp = new QListWidgetItem("   📊 O(log n + k) for k keys in range");
+        timeComp->setForeground(QColor(40, 167, 69));
+        algorithmList->addItem(timeComp);
+
+        QListWidgetItem *spaceComp = new QListWidgetItem("   💾 Space: O(1) - no stack, no list");
+        spaceComp->setForeground(QColor(40, 167, 69));
+        algorithmList->addItem(spaceComp);
+    }
     
     // Do not auto-switch tabs; keep user's current selection
 }
 
+void RedBlackTree::setupOrderStatisticsControls()
+{
+    orderStatsGroup = new QGroupBox("");
+    StyleManager::instance().applyTraversalGroupStyle(orderStatsGroup);
+
+    QVBoxLayout *orderStatsLayout = new QVBoxLayout(orderStatsGroup);
+    orderStatsLayout->setContentsMargins(20, 15, 20, 15);
+    orderStatsLayout->setSpacing(8);
+
+    QHBoxLayout *orderStatsControlLayout = new QHBoxLayout();
+    orderStatsControlLayout->setSpacing(8);
+
+    orderStatsInput = new QLineEdit();
+    orderStatsInput->setPlaceholderText("k, 90%, value or lo hi");
+    orderStatsInput->setFixedHeight(30);
+    StyleManager::instance().applyInputFieldStyle(orderStatsInput);
+
+    selectButton = new QPushButton("Select");
+    selectButton->setFixedSize(60, 30);
+    selectButton->setToolTip("k-th smallest key (0-based), or a percentile such as 90%");
+    StyleManager::instance().applyTraversalButtonStyle(selectButton, "#7b4fff");
+
+    rankButton = new QPushButton("Rank");
+    rankButton->setFixedSize(60, 30);
+    rankButton->setToolTip("How many keys are smaller than the value");
+    StyleManager::instance().applyTraversalButtonStyle(rankButton, "#4a90e2");
+
+    rangeButton = new QPushButton("Range");
+    rangeButton->setFixedSize(60, 30);
+    rangeButton->setToolTip("How many keys lie in [lo, hi]");
+    StyleManager::instance().applyTraversalButtonStyle(rangeButton, "#28a745");
+
+    scanButton = new QPushButton("Scan");
+    scanButton->setFixedSize(60, 30);
+    scanButton->setToolTip("Visit the keys in [lo, hi] in order, touching only O(log n + k) nodes");
+    StyleManager::instance().applyTraversalButtonStyle(scanButton, "#f39c12");
+
+    orderStatsControlLayout->addWidget(orderStatsInput, 1);
+    orderStatsControlLayout->addWidget(selectButton);
+    orderStatsControlLayout->addWidget(rankButton);
+    orderStatsControlLayout->addWidget(rangeButton);
+    orderStatsControlLayout->addWidget(scanButton);
+    orderStatsLayout->addLayout(orderStatsControlLayout);
+
+    orderStatsResultList = new QListWidget();
+    orderStatsResultList->setFixedHeight(60);
+    StyleManager::instance().applyTraversalResultListStyle(orderStatsResultList);
+    orderStatsLayout->addWidget(orderStatsResultList);
+
+    rightLayout->addWidget(orderStatsGroup, 0);
+
+    connect(selectButton, &QPushButton::clicked, this, &RedBlackTree::onSelectClicked);
+    connect(rankButton, &QPushButton::clicked, this, &RedBlackTree::onRankClicked);
+    connect(rangeButton, &QPushButton::clicked, this, &RedBlackTree::onRangeClicked);
+    connect(scanButton, &QPushButton::clicked, this, &RedBlackTree::onScanClicked);
+}
+
+void RedBlackTree::setupHistoryControls()
+{
+    historyGroup = new QGroupBox("");
+    StyleManager::instance().applyTraversalGroupStyle(historyGroup);
+
+    QVBoxLayout *historyLayout = new QVBoxLayout(historyGroup);
+    historyLayout->setContentsMargins(20, 15, 20, 15);
+    historyLayout->setSpacing(8);
+
+    QHBoxLayout *historyControlLayout = new QHBoxLayout();
+    historyControlLayout->setSpacing(8);
+
+    undoButton = new QPushButton("↩️ Undo");
+    undoButton->setFixedSize(80, 30);
+    undoButton->setToolTip("Back to the previous version");
+    StyleManager::instance().applyTraversalButtonStyle(undoButton, "#6c757d");
+
+    redoButton = new QPushButton("↪️ Redo");
+    redoButton->setFixedSize(80, 30);
+    redoButton->setToolTip("Forward to the next version");
+    StyleManager::instance().applyTraversalButtonStyle(redoButton, "#6c757d");
+
+    compareButton = new QPushButton("🔍 Compare");
+    compareButton->setFixedSize(100, 30);
+    compareButton->setToolTip("Keys added and removed between the selected version and the current one");
+    StyleManager::instance().applyTraversalButtonStyle(compareButton, "#17a2b8");
+
+    historyControlLayout->addWidget(undoButton);
+    historyControlLayout->addWidget(redoButton);
+    historyControlLayout->addWidget(compareButton);
+    historyControlLayout->addStretch();
+    historyLayout->addLayout(historyControlLayout);
+
+    versionList = new QListWidget();
+    versionList->setFixedHeight(90);
+    StyleManager::instance().applyTraversalResultListStyle(versionList);
+    historyLayout->addWidget(versionList);
+
+    rightLayout->addWidget(historyGroup, 0);
+
+    connect(undoButton, &QPushButton::clicked, this, &RedBlackTree::onUndoClicked);
+    connect(redoButton, &QPushButton::clicked, this, &RedBlackTree::onRedoClicked);
+    connect(compareButton, &QPushButton::clicked, this, &RedBlackTree::onCompareClicked);
+    // Double-click jumps straight to a version
+    connect(versionList, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem *item) {
+        const int index = versionList->row(item);
+        if (isReplayBusy() || index == versionHistory.currentIndex()) return;
+        OperationRecorder::instance().record(LoggedOperation::RedBlack, "version", {QString::number(index)});
+        restoreVersion(index, "⏮️ Jumped");
+    });
+
+    refreshVersionList();
+}
+
+void RedBlackTree::setupTimelineControls()
+{
+    timelineControls = new TimelineControls(timeline);
+    rightLayout->addWidget(timelineControls, 0);
+}
+
+void RedBlackTree::setupSessionControls()
+{
+    sessionControls = new SessionControls(this);
+    rightLayout->addWidget(sessionControls, 0);
+}
+
+bool RedBlackTree::isReplayBusy() const
+{
+    return isAnimating || traversalAnimTimer->isActive() || scanTimer->isActive();
+}
+
+void RedBlackTree::onEngineEvent(const EngineEvent &event)
+{
+    // Shape or colours changed: the cached picture of the tree is stale
+    staticLayer.invalidate();
+
+    // Rebalancing runs inside the engine; narrate each step as it is reported
+    switch (event.type) {
+    case EngineEvent::Rotated:
+        visuals.invalidateLayout();
+        fixValue = event.second;
+        addStepToHistory(QString("🔄 %1 rotation at %2: %3 moves up")
+                             .arg(event.second > event.first ? "Left" : "Right")
+                             .arg(event.first)
+                             .arg(event.second));
+        break;
+    case EngineEvent::Recolored:
+        fixValue = event.first;
+        addStepToHistory(QString("🎨 Recolored %1 to %2")
+                             .arg(event.first)
+                             .arg(event.second == RED ? "RED" : "BLACK"));
+        break;
+    case EngineEvent::NodeInserted:
+        // The tidy layout packs subtrees by their contours, so any change of
+        // shape can move nodes anywhere; highlight-only repaints reuse it
+        visuals.invalidateLayout();
+        refreshVersionList();
+        break;
+    case EngineEvent::NodeRemoved:
+        visuals.remove(event.first);
+        visuals.invalidateLayout();
+        refreshVersionList();
+        break;
+    case EngineEvent::Cleared:
+        visuals.clear();
+        refreshVersionList();
+        break;
+    case EngineEvent::BulkLoaded:
+        visuals.invalidateLayout();
+        refreshVersionList();
+        break;
+    default:
+        break;
+    }
+    update();
+}
+
+bool RedBlackTree::replayOperation(const LoggedOperation &operation)
+{
+    const QString &op = operation.op;
+    if (op == "clear") {
+        onClearClicked();
+    } else if (op == "bfs") {
+        onStartBFS();
+    } else if (op == "dfs") {
+        onStartDFS();
+    } else if (!operation.args.isEmpty() && (op == "insert" || op == "search" || op == "delete")) {
+        // Go through the input field exactly like a click would
+        inputField->setText(operation.args.first());
+        if (op == "insert") onInsertClicked();
+        else if (op == "search") onSearchClicked();
+        else onDeleteClicked();
+    } else if (op == "load" && !operation.args.isEmpty()) {
+        loadDataset(operation.args.first());
+    } else if (op == "bulk") {
+        QVector<int> values;
+        values.reserve(operation.args.size());
+        for (const QString &arg : operation.args) {
+            bool ok = false;
+            const int value = arg.toInt(&ok);
+            if (ok) values.append(value);
+        }
+        bulkInsert(values);
+    } else if (op == "undo") {
+        onUndoClicked();
+    } else if (op == "redo") {
+        onRedoClicked();
+    } else if (op == "version" && !operation.args.isEmpty()) {
+        restoreVersion(operation.args.first().toInt(), "⏮️ Jumped");
+    } else if (!operation.args.isEmpty() && (op == "select" || op == "rank" || op == "range" || op == "scan")) {
+        orderStatsInput->setText(operation.args.join(' '));
+        if (op == "select") onSelectClicked();
+        else if (op == "rank") onRankClicked();
+        else if (op == "range") onRangeClicked();
+        else onScanClicked();
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void RedBlackTree::onBackClicked()
 {
     emit backToOperations();
@@ -951,6 +1338,8 @@ void RedBlackTree::onInsertClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "insert", {QString::number(value)});
+
     // Show algorithm for insert
     showAlgorithm("Insert");
     
@@ -971,7 +1360,7 @@ void RedBlackTree::onDeleteClicked()
         return;
     }
 
-    if (root == NIL) {
+    if (engine.root() == engine.nil()) {
         QMessageBox::warning(this, "Empty Tree", "Tree is empty.");
         return;
     }
@@ -990,6 +1379,8 @@ void RedBlackTree::onDeleteClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "delete", {QString::number(value)});
+
     // Show algorithm for delete
     showAlgorithm("Delete");
     
@@ -1003,7 +1394,7 @@ void RedBlackTree::onDeleteClicked()
 
 void RedBlackTree::onSearchClicked()
 {
-    if (root == NIL) {
+    if (engine.root() == engine.nil()) {
         QMessageBox::information(this, "Empty Tree", "Tree is empty.");
         return;
     }
@@ -1022,6 +1413,8 @@ void RedBlackTree::onSearchClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "search", {QString::number(value)});
+
     // Show algorithm for search
     showAlgorithm("Search");
     
@@ -1035,14 +1428,16 @@ void RedBlackTree::onSearchClicked()
 
 void RedBlackTree::onClearClicked()
 {
-    clearTree(root);
-    root = NIL;
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "clear");
+    engine.clear();
     stepHistory.clear();
+    stepsList->clear();
     updateStepTrace();
     
     // Clear traversal results
     traversalResultList->clear();
-    traversalOrder.clear();
+    traversalCursor = {};
+    traversalCurrent = nullptr;
     traversalType = TraversalType::None;
     traversalIndex = 0;
     
@@ -1068,232 +1463,561 @@ void RedBlackTree::onRandomizeClicked()
     onInsertClicked();
 }
 
-void RedBlackTree::insertNode(int value)
+void RedBlackTree::onBulkInsertClicked()
 {
-    // Check for duplicate
-    if (findNode(root, value) != NIL) {
-        statusLabel->setText(QString("Value %1 already exists!").arg(value));
-        addStepToHistory(QString("❌ Insert failed: Value %1 already exists").arg(value));
-        addOperationSeparator();
+    if (isAnimating || traversalAnimTimer->isActive()) {
+        QMessageBox::warning(this, "Animation in Progress",
+                             "Please wait for the current animation to complete.");
         return;
     }
 
-    addStepToHistory(QString("🔍 Checking if value %1 already exists...").arg(value));
-    addStepToHistory("✅ Value is unique, proceeding with insertion");
+    bool ok;
+    const int count = inputField->text().trimmed().toInt(&ok);
+    if (!ok || count < 1 || count > MAX_BULK_INSERT) {
+        QMessageBox::warning(this, "Invalid Input",
+                             QString("Enter how many values to insert (1 - %1).").arg(MAX_BULK_INSERT));
+        return;
+    }
 
-    if (root == NIL) {
-        addStepToHistory(QString("🌱 Tree is empty, inserting %1 as root").arg(value));
-    } else {
-        addStepToHistory(QString("🌳 Tree has nodes, finding insertion position for %1").arg(value));
+    // Keys are drawn from a range ten times the count, so most are unique
+    QVector<int> values(count);
+    const int upper = count > INT_MAX / 10 ? INT_MAX : count * 10 + 1;
+    for (int &value : values) {
+        value = QRandomGenerator::global()->bounded(1, upper);
     }
 
-    isAnimating = true;
-    insertButton->setEnabled(false);
-    deleteButton->setEnabled(false);
-    searchButton->setEnabled(false);
+    showAlgorithm("Insert");
+    addStepToHistory("⚡ BULK INSERT");
+    addStepToHistory(QString("🎲 Generated %1 random values").arg(count));
+    bulkInsert(values);
+    inputField->clear();
+    inputField->setFocus();
+}
 
-    statusLabel->setText(QString("Inserting %1...").arg(value));
+void RedBlackTree::bulkInsert(const QVector<int> &values)
+{
+    // One entry for the whole batch, so a replay makes the same single version
+    OperationRecorder &recorder = OperationRecorder::instance();
+    if (recorder.isRecording()) {
+        QStringList args;
+        args.reserve(values.size());
+        for (int value : values) args << QString::number(value);
+        recorder.record(LoggedOperation::RedBlack, "bulk", args);
+    }
 
-    RBNode *node = new RBNode(value);
-    node->left = node->right = NIL;
+    // No timers and no per-rotation narration: go straight to the engine.
+    // The history takes one snapshot afterwards instead of a version per key.
+    engine.removeObserver(this);
+    engine.removeObserver(&versionHistory);
+    QElapsedTimer timer;
+    timer.start();
+    int inserted = 0;
+    for (int value : values) {
+        if (engine.insert(value)) ++inserted;
+    }
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    engine.addObserver(&versionHistory);
+    engine.addObserver(this);
+    if (inserted > 0) {
+        // The events that would have marked the drawing stale were muted
+        visuals.invalidateLayout();
+        staticLayer.invalidate();
+        versionHistory.snapshot();
+        refreshVersionList();
+    }
 
-    addStepToHistory(QString("🔴 Created new RED node with value %1").arg(value));
-    
-    root = BSTInsert(root, node);
-    addStepToHistory("📍 Node inserted using BST insertion rules");
+    statusLabel->setText(QString("Bulk inserted %1 values in %2 ms")
+                             .arg(inserted)
+                             .arg(elapsedNs / 1e6, 0, 'f', 1));
+    addStepToHistory(QString("✅ Inserted %1 new values, skipped %2 duplicates")
+                         .arg(inserted)
+                         .arg(values.size() - inserted));
+    addStepToHistory(QString("⏱️ %1 ms total, %2 ns per insert")
+                         .arg(elapsedNs / 1e6, 0, 'f', 1)
+                         .arg(values.isEmpty() ? 0.0 : static_cast<double>(elapsedNs) / values.size(), 0, 'f', 0));
+    addStepToHistory(QString("🌳 Tree now holds %1 nodes, height %2").arg(engine.size()).arg(engine.height()));
+    addOperationSeparator();
+    update();
+}
 
-    QTimer::singleShot(500, this, [this, node, value]() {
-        node->isHighlighted = true;
-        statusLabel->setText("Fixing Red-Black properties...");
-        addStepToHistory("🔄 Checking Red-Black tree properties...");
-        update();
+void RedBlackTree::onLoadDatasetClicked()
+{
+    if (isAnimating || traversalAnimTimer->isActive()) {
+        QMessageBox::warning(this, "Animation in Progress",
+                             "Please wait for the current animation to complete.");
+        return;
+    }
 
-        QTimer::singleShot(800, this, [this, node, value]() {
-            addStepToHistory("⚖️ Applying Red-Black tree balancing rules");
-            fixInsert(node);
-            node->isHighlighted = false;
+    const QString path = QFileDialog::getOpenFileName(this, "Load Dataset", QString(),
+                                                      "Key files (*.txt *.csv);;All files (*)");
+    if (path.isEmpty()) return;
+    loadDataset(path);
+}
 
-            statusLabel->setText(QString("Successfully inserted %1").arg(value));
-            addStepToHistory(QString("✅ Node %1 successfully inserted and tree balanced").arg(value));
-            addStepToHistory("🎯 Red-Black tree properties maintained");
-            addOperationSeparator();
+void RedBlackTree::loadDataset(const QString &path)
+{
+    showAlgorithm("Insert");
+    addStepToHistory("📂 LOAD DATASET");
+    addStepToHistory(QString("📄 Reading %1").arg(QFileInfo(path).fileName()));
+
+    KeyDataset dataset;
+    QString error;
+    if (!loadKeyDataset(path, dataset, &error)) {
+        statusLabel->setText("Dataset could not be loaded");
+        addStepToHistory(QString("❌ Load failed: %1").arg(error));
+        addOperationSeparator();
+        return;
+    }
 
-            isAnimating = false;
-            insertButton->setEnabled(true);
-            deleteButton->setEnabled(true);
-            searchButton->setEnabled(true);
-            update();
-        });
-    });
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "load", {path});
 
+    if (dataset.wasSorted) {
+        addStepToHistory(QString("✅ %1 keys, already sorted").arg(dataset.keys.size()));
+    } else {
+        addStepToHistory(QString("🔃 Sorted %1 keys, dropped %2 duplicates")
+                             .arg(dataset.keys.size())
+                             .arg(dataset.duplicates));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    engine.buildFromSorted(dataset.keys);
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    addStepToHistory("🏗️ Built from the middle key outwards: each subtree gets the middle of its range");
+    addStepToHistory("🎨 Deepest level coloured RED, all other levels BLACK - no rotations needed");
+    addStepToHistory(QString("⏱️ %1 nodes in %2 ms, height %3")
+                         .arg(engine.size())
+                         .arg(elapsedNs / 1e6, 0, 'f', 1)
+                         .arg(engine.height()));
+    addOperationSeparator();
+    statusLabel->setText(QString("Loaded %1 keys in %2 ms")
+                             .arg(engine.size())
+                             .arg(elapsedNs / 1e6, 0, 'f', 1));
     update();
 }
 
-RBNode* RedBlackTree::BSTInsert(RBNode* root, RBNode* node)
+void RedBlackTree::onSelectClicked()
 {
-    if (root == NIL) {
-        node->parent = nullptr;  // Root has no parent
-        return node;
+    if (engine.size() == 0) {
+        QMessageBox::information(this, "Empty Tree", "Tree is empty.");
+        return;
     }
 
-    if (node->value < root->value) {
-        root->left = BSTInsert(root->left, node);
-        if (root->left != NIL) {
-            root->left->parent = root;
-        }
-    } else if (node->value > root->value) {
-        root->right = BSTInsert(root->right, node);
-        if (root->right != NIL) {
-            root->right->parent = root;
+    // "k" is a 0-based position, "p%" a percentile of the live keys
+    QString text = orderStatsInput->text().trimmed();
+    const bool percentile = text.endsWith('%');
+    if (percentile) text.chop(1);
+    bool ok;
+    const double number = text.toDouble(&ok);
+    if (!ok || number < 0 || (percentile && number > 100) || (!percentile && number != std::floor(number))) {
+        QMessageBox::warning(this, "Invalid Input", "Enter a position k (0-based) or a percentile such as 90%.");
+        return;
+    }
+    const int k = percentile ? static_cast<int>(std::lround(number / 100.0 * (engine.size() - 1)))
+                             : static_cast<int>(std::min(number, static_cast<double>(INT_MAX)));
+
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "select", {orderStatsInput->text().trimmed()});
+    showAlgorithm("OrderStatistics");
+    addStepToHistory("📊 SELECT OPERATION");
+    if (percentile) {
+        addStepToHistory(QString("🎯 %1th percentile of %2 keys → position k = %3").arg(number).arg(engine.size()).arg(k));
+    } else {
+        addStepToHistory(QString("🎯 Looking for the key at position k = %1").arg(k));
+    }
+
+    std::vector<RBNode*> path;
+    RBNode *found = engine.select(k, &path);
+    int remaining = k;
+    for (RBNode *node : path) {
+        const int leftSize = node->left->size;
+        if (remaining < leftSize) {
+            addStepToHistory(QString("⬅️ At %1: k = %2 < left size %3, go left").arg(node->value).arg(remaining).arg(leftSize));
+        } else if (remaining == leftSize) {
+            addStepToHistory(QString("🎯 At %1: k = %2 = left size, this is the node").arg(node->value).arg(remaining));
+        } else {
+            addStepToHistory(QString("➡️ At %1: k = %2 > left size %3, k becomes %4, go right")
+                                 .arg(node->value).arg(remaining).arg(leftSize).arg(remaining - leftSize - 1));
+            remaining -= leftSize + 1;
         }
     }
 
-    return root;
+    visuals.resetHighlights();
+    QString result;
+    if (found != engine.nil()) {
+        visuals[found->value].isHighlighted = true;
+        result = QString("📊 select(%1) = %2").arg(k).arg(found->value);
+        addStepToHistory(QString("✅ Key at position %1 is %2").arg(k).arg(found->value));
+    } else {
+        result = QString("❌ Position %1 is out of range (0 - %2)").arg(k).arg(engine.size() - 1);
+        addStepToHistory(result);
+    }
+    statusLabel->setText(result);
+    showOrderStatsResult(result);
+    addOperationSeparator();
+    update();
 }
 
-void RedBlackTree::fixInsert(RBNode* node)
+void RedBlackTree::onRankClicked()
 {
-    while (node->parent && node->parent->color == RED) {
-        // Check if parent->parent exists (parent is not root)
-        if (!node->parent->parent) {
-            break;  // Parent is root, no grandparent
-        }
+    bool ok;
+    const int value = orderStatsInput->text().trimmed().toInt(&ok);
+    if (!ok) {
+        QMessageBox::warning(this, "Invalid Input", "Please enter a valid integer.");
+        return;
+    }
 
-        if (node->parent == node->parent->parent->left) {
-            RBNode *uncle = node->parent->parent->right;
-
-            // Check if uncle exists and is RED (uncle could be NIL which is BLACK)
-            if (uncle && uncle != NIL && uncle->color == RED) {
-                // Case 1: Uncle is red
-                node->parent->color = BLACK;
-                uncle->color = BLACK;
-                node->parent->parent->color = RED;
-                node = node->parent->parent;
-            } else {
-                // Uncle is BLACK or NIL
-                if (node == node->parent->right) {
-                    // Case 2: Triangle - convert to line
-                    node = node->parent;
-                    rotateLeftSync(node);
-                }
-                // Case 3: Line
-                node->parent->color = BLACK;
-                if (node->parent->parent) {
-                    node->parent->parent->color = RED;
-                    rotateRightSync(node->parent->parent);
-                }
-            }
-        } else {
-            RBNode *uncle = node->parent->parent->left;
-
-            // Check if uncle exists and is RED
-            if (uncle && uncle != NIL && uncle->color == RED) {
-                node->parent->color = BLACK;
-                uncle->color = BLACK;
-                node->parent->parent->color = RED;
-                node = node->parent->parent;
-            } else {
-                // Uncle is BLACK or NIL
-                if (node == node->parent->left) {
-                    node = node->parent;
-                    rotateRightSync(node);
-                }
-                node->parent->color = BLACK;
-                if (node->parent->parent) {
-                    node->parent->parent->color = RED;
-                    rotateLeftSync(node->parent->parent);
-                }
-            }
-        }
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "rank", {QString::number(value)});
+    showAlgorithm("OrderStatistics");
+    addStepToHistory("📊 RANK OPERATION");
+    addStepToHistory(QString("🎯 Counting keys smaller than %1").arg(value));
+
+    std::vector<RBNode*> path;
+    const int rank = engine.rank(value, &path);
+    narrateCountWalk(path, value, false);
+
+    visuals.resetHighlights();
+    for (RBNode *node : path) {
+        if (node->value == value) visuals[value].isHighlighted = true;
+    }
+    const QString result = QString("📊 rank(%1) = %2 of %3 keys").arg(value).arg(rank).arg(engine.size());
+    addStepToHistory(QString("✅ %1 keys are smaller than %2").arg(rank).arg(value));
+    statusLabel->setText(result);
+    showOrderStatsResult(result);
+    addOperationSeparator();
+    update();
+}
+
+bool RedBlackTree::readRangeInput(int &lo, int &hi)
+{
+    const QStringList parts = orderStatsInput->text().split(QRegularExpression("[\\s,]+"), Qt::SkipEmptyParts);
+    bool okLo = false, okHi = false;
+    if (parts.size() == 2) {
+        lo = parts.at(0).toInt(&okLo);
+        hi = parts.at(1).toInt(&okHi);
+    }
+    if (!okLo || !okHi) {
+        QMessageBox::warning(this, "Invalid Input", "Enter a range as two integers: lo hi");
+        return false;
     }
-    root->color = BLACK;
+    return true;
 }
 
-void RedBlackTree::rotateLeft(RBNode* node)
+void RedBlackTree::onRangeClicked()
 {
-    if (!node || node->right == NIL) return;
+    int lo, hi;
+    if (!readRangeInput(lo, hi)) return;
 
-    statusLabel->setText("Performing left rotation...");
-    node->isRotating = true;
-    update();
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "range", {QString::number(lo), QString::number(hi)});
+    showAlgorithm("OrderStatistics");
+    addStepToHistory("📊 RANGE COUNT OPERATION");
+    addStepToHistory(QString("🎯 Counting keys in [%1, %2]").arg(lo).arg(hi));
 
-    QTimer::singleShot(600, this, [this, node]() {
-        rotateLeftSync(node);
-        node->isRotating = false;
-        update();
-    });
+    int count = 0;
+    if (lo > hi) {
+        addStepToHistory("⚠️ lo > hi: the range is empty");
+    } else {
+        std::vector<RBNode*> path;
+        addStepToHistory(QString("1️⃣ Keys ≤ %1:").arg(hi));
+        const int atMost = engine.countAtMost(hi, &path);
+        narrateCountWalk(path, hi, true);
+        path.clear();
+        addStepToHistory(QString("2️⃣ Keys < %1:").arg(lo));
+        const int below = engine.rank(lo, &path);
+        narrateCountWalk(path, lo, false);
+        count = atMost - below;
+        addStepToHistory(QString("➖ %1 - %2 = %3").arg(atMost).arg(below).arg(count));
+    }
+
+    const QString result = QString("📊 %1 keys in [%2, %3]").arg(count).arg(lo).arg(hi);
+    statusLabel->setText(result);
+    showOrderStatsResult(result);
+    addOperationSeparator();
+    update();
 }
 
-void RedBlackTree::rotateLeftSync(RBNode* node)
+void RedBlackTree::onScanClicked()
 {
-    if (!node || node->right == NIL) return;
+    if (isAnimating || traversalAnimTimer->isActive() || scanTimer->isActive()) {
+        QMessageBox::warning(this, "Animation in Progress",
+                             "Please wait for the current animation to complete.");
+        return;
+    }
+
+    int lo, hi;
+    if (!readRangeInput(lo, hi)) return;
 
-    RBNode *rightChild = node->right;
-    node->right = rightChild->left;
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "scan", {QString::number(lo), QString::number(hi)});
+    showAlgorithm("RangeScan");
+    addStepToHistory("🔎 RANGE SCAN");
+    addStepToHistory(QString("🎯 Visiting keys in [%1, %2] in ascending order").arg(lo).arg(hi));
 
-    if (rightChild->left != NIL) {
-        rightChild->left->parent = node;
+    RBNode *first = lo <= hi ? engine.lowerBound(lo) : engine.nil();
+    if (first == engine.nil() || first->value > hi) {
+        const QString result = QString("🔎 No keys in [%1, %2]").arg(lo).arg(hi);
+        addStepToHistory(QString("❌ %1").arg(result));
+        statusLabel->setText(result);
+        showOrderStatsResult(result);
+        addOperationSeparator();
+        return;
     }
 
-    rightChild->parent = node->parent;
+    addStepToHistory(QString("⬇️ lower_bound(%1) = %2 - one root-to-leaf descent").arg(lo).arg(first->value));
+    addStepToHistory("➡️ Then step to in-order successors through parent pointers until a key passes hi");
 
-    if (!node->parent) {
-        root = rightChild;
-    } else if (node == node->parent->left) {
-        node->parent->left = rightChild;
-    } else {
-        node->parent->right = rightChild;
+    // Only the keys on show are collected; the total comes from the subtree sizes
+    const int total = engine.countInRange(lo, hi);
+    scanKeys.clear();
+    scanIndex = 0;
+    for (auto it = engine.from(lo); it != engine.end() && it->value <= hi && scanKeys.size() < MAX_SCAN_ANIMATION; ++it) {
+        scanKeys.append(it->value);
+    }
+    if (total > scanKeys.size()) {
+        addStepToHistory(QString("⏩ Animating the first %1 of %2 keys").arg(scanKeys.size()).arg(total));
     }
 
-    rightChild->left = node;
-    node->parent = rightChild;
+    QStringList shown;
+    for (int i = 0; i < std::min<int>(scanKeys.size(), 10); ++i) shown << QString::number(scanKeys.at(i));
+    showOrderStatsResult(QString("🔎 %1 keys in [%2, %3]: %4%5")
+                             .arg(total).arg(lo).arg(hi)
+                             .arg(shown.join(" → "))
+                             .arg(total > shown.size() ? " → ..." : ""));
+
+    visuals.resetHighlights();
+    visuals.resetTraversal();
+    traversalType = TraversalType::Range;
+    setControlsEnabled(false);
+    statusLabel->setText(QString("Scanning [%1, %2]...").arg(lo).arg(hi));
+    scanTimer->start(AnimationTimeline::scaled(SCAN_STEP_MS));
 }
 
-void RedBlackTree::rotateRight(RBNode* node)
+void RedBlackTree::onScanAnimationStep()
 {
-    if (!node || node->left == NIL) return;
+    if (scanIndex > 0) {
+        NodeVisual &visual = visuals[scanKeys.at(scanIndex - 1)];
+        visual.isVisited = true;
+        visual.isTraversalHighlighted = false;
+    }
+
+    if (scanIndex >= scanKeys.size()) {
+        scanTimer->stop();
+        traversalType = TraversalType::None;
+        visuals.resetTraversal();
+        setControlsEnabled(true);
+        statusLabel->setText("Range scan complete.");
+        addStepToHistory(QString("🎯 Range scan completed. Visited %1 keys").arg(scanKeys.size()));
+        addOperationSeparator();
+        update();
+        return;
+    }
 
-    statusLabel->setText("Performing right rotation...");
-    node->isRotating = true;
+    const int key = scanKeys.at(scanIndex++);
+    visuals[key].isTraversalHighlighted = true;
+    addStepToHistory(QString("👁️ Scan: visiting %1").arg(key));
     update();
+}
 
-    QTimer::singleShot(600, this, [this, node]() {
-        rotateRightSync(node);
-        node->isRotating = false;
-        update();
-    });
+void RedBlackTree::onUndoClicked()
+{
+    if (isReplayBusy()) {
+        QMessageBox::warning(this, "Animation in Progress",
+                             "Please wait for the current operation to complete.");
+        return;
+    }
+    if (!versionHistory.canUndo()) {
+        statusLabel->setText("Nothing to undo.");
+        return;
+    }
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "undo");
+    restoreVersion(versionHistory.currentIndex() - 1, "↩️ Undo");
 }
 
-void RedBlackTree::rotateRightSync(RBNode* node)
+void RedBlackTree::onRedoClicked()
 {
-    if (!node || node->left == NIL) return;
+    if (isReplayBusy()) {
+        QMessageBox::warning(this, "Animation in Progress",
+                             "Please wait for the current operation to complete.");
+        return;
+    }
+    if (!versionHistory.canRedo()) {
+        statusLabel->setText("Nothing to redo.");
+        return;
+    }
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "redo");
+    restoreVersion(versionHistory.currentIndex() + 1, "↪️ Redo");
+}
 
-    RBNode *leftChild = node->left;
-    node->left = leftChild->right;
+void RedBlackTree::restoreVersion(int index, const QString &action)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (!versionHistory.restore(index)) return;
+    const qint64 elapsedNs = timer.nsecsElapsed();
+
+    addStepToHistory(QString("%1: back at %2").arg(action, describeVersion(index)));
+    addStepToHistory(QString("🌳 Copied the kept version into the tree: %1 nodes in %2 µs")
+                         .arg(engine.size())
+                         .arg(elapsedNs / 1e3, 0, 'f', 1));
+    addOperationSeparator();
+    statusLabel->setText(QString("%1 → v%2").arg(action).arg(index));
+    refreshVersionList();
+    update();
+}
+
+void RedBlackTree::onCompareClicked()
+{
+    const int selected = versionList->currentRow();
+    const int current = versionHistory.currentIndex();
+    if (selected < 0 || selected == current) {
+        QMessageBox::information(this, "Compare Versions",
+                                 "Select another version in the list to compare it with the current one.");
+        return;
+    }
+
+    const auto &versions = versionHistory.versions();
+    std::vector<int> removed, added;
+    PersistentRBTree::diff(versions[static_cast<std::size_t>(selected)].tree,
+                           versions[static_cast<std::size_t>(current)].tree, removed, added);
+
+    auto preview = [](const std::vector<int> &keys) {
+        QStringList shown;
+        for (std::size_t i = 0; i < std::min<std::size_t>(keys.size(), 10); ++i) shown << QString::number(keys[i]);
+        if (keys.size() > 10) shown << "...";
+        return shown.join(", ");
+    };
+
+    addStepToHistory(QString("🔍 COMPARE v%1 → v%2").arg(selected).arg(current));
+    addStepToHistory("🌿 Subtrees both versions share are skipped without being walked");
+    if (added.empty() && removed.empty()) {
+        addStepToHistory("✅ Same keys in both versions");
+    }
+    if (!added.empty()) {
+        addStepToHistory(QString("➕ %1 added: %2").arg(added.size()).arg(preview(added)));
+    }
+    if (!removed.empty()) {
+        addStepToHistory(QString("➖ %1 removed: %2").arg(removed.size()).arg(preview(removed)));
+    }
+    addOperationSeparator();
+    statusLabel->setText(QString("v%1 → v%2: +%3 / -%4 keys")
+                             .arg(selected).arg(current).arg(added.size()).arg(removed.size()));
+}
+
+void RedBlackTree::refreshVersionList()
+{
+    const int count = static_cast<int>(versionHistory.versions().size());
+    const int current = versionHistory.currentIndex();
+
+    versionList->clear();
+    for (int i = 0; i < count; ++i) {
+        QListWidgetItem *item = new QListWidgetItem(QString("%1 %2").arg(i == current ? QStringLiteral("▶") : QStringLiteral("  "), describeVersion(i)));
+        if (i == current) item->setFont(QFont("Segoe UI", 10, QFont::Bold));
+        versionList->addItem(item);
+    }
+    versionList->scrollToItem(versionList->item(current));
+
+    const bool idle = !isReplayBusy();
+    undoButton->setEnabled(idle && versionHistory.canUndo());
+    redoButton->setEnabled(idle && versionHistory.canRedo());
+}
 
-    if (leftChild->right != NIL) {
-        leftChild->right->parent = node;
+QString RedBlackTree::describeVersion(int index) const
+{
+    const RBVersionHistory::Version &version = versionHistory.versions()[static_cast<std::size_t>(index)];
+    QString change;
+    switch (version.change) {
+    case RBVersionHistory::Initial:  change = "🌱 start"; break;
+    case RBVersionHistory::Inserted: change = QString("➕ insert %1").arg(version.value); break;
+    case RBVersionHistory::Removed:  change = QString("🗑️ delete %1").arg(version.value); break;
+    case RBVersionHistory::Cleared:  change = "🧹 clear"; break;
+    case RBVersionHistory::Reloaded: change = "📦 bulk change"; break;
     }
+    return QString("v%1 %2 (%3 keys)").arg(index).arg(change).arg(version.tree.size());
+}
 
-    leftChild->parent = node->parent;
+void RedBlackTree::narrateCountWalk(const std::vector<RBNode*> &path, int value, bool inclusive)
+{
+    int count = 0;
+    for (RBNode *node : path) {
+        if (value < node->value || (!inclusive && value == node->value)) {
+            addStepToHistory(QString("⬅️ At %1: go left, count stays %2").arg(node->value).arg(count));
+        } else {
+            count += node->left->size + 1;
+            addStepToHistory(QString("➡️ At %1: add left size %2 + 1, count = %3, go right")
+                                 .arg(node->value).arg(node->left->size).arg(count));
+        }
+    }
+}
 
-    if (!node->parent) {
-        root = leftChild;
-    } else if (node == node->parent->right) {
-        node->parent->right = leftChild;
+void RedBlackTree::showOrderStatsResult(const QString &result)
+{
+    orderStatsResultList->addItem(result);
+    orderStatsResultList->scrollToBottom();
+}
+
+void RedBlackTree::insertNode(int value)
+{
+    addStepToHistory(QString("🔍 Descending from the root to find the parent of %1...").arg(value));
+
+    const bool wasEmpty = engine.root() == engine.nil();
+    // The same descent that finds the parent also catches a duplicate. The
+    // fix-up is left pending so queueRebalance() can show each step.
+    RBNode *node = nullptr;
+    if (!engine.insert(value, &node, false)) {
+        statusLabel->setText(QString("Value %1 already exists!").arg(value));
+        addStepToHistory(QString("❌ Insert failed: Value %1 already exists").arg(value));
+        addOperationSeparator();
+        return;
+    }
+
+    if (wasEmpty) {
+        addStepToHistory(QString("🌱 Tree is empty, inserting %1 as root").arg(value));
     } else {
-        node->parent->left = leftChild;
+        addStepToHistory(QString("📍 Attached %1 as the %2 child of %3")
+                             .arg(value)
+                             .arg(node == node->parent()->left ? "left" : "right")
+                             .arg(node->parent()->value));
     }
+    addStepToHistory(QString("🔴 Created new RED node with value %1").arg(value));
+
+    setAnimating(true);
+
+    // The new leaf is shown red and unbalanced first, then highlighted,
+    // then the fix-up runs one rotation or recolouring per frame
+    std::vector<AnimationFrame> frames(3);
+    frames[0].durationMs = 500;
+    frames[0].show = [this, node, value]() {
+        if (engine.find(value) == node) visuals[value].isHighlighted = false;
+        statusLabel->setText(QString("Inserting %1...").arg(value));
+    };
+
+    frames[1].durationMs = 800;
+    frames[1].reach = [this]() {
+        addStepToHistory("🔄 Checking Red-Black tree properties...");
+    };
+    frames[1].show = [this, node, value]() {
+        if (engine.find(value) == node) visuals[value].isHighlighted = true;
+        statusLabel->setText("Fixing Red-Black properties...");
+    };
 
-    leftChild->right = node;
-    node->parent = leftChild;
+    frames[2].reach = [this, value]() {
+        addStepToHistory("⚖️ Applying Red-Black tree balancing rules");
+        queueRebalance([this, value]() {
+            addStepToHistory(QString("✅ Node %1 successfully inserted and tree balanced").arg(value));
+            addStepToHistory("🎯 Red-Black tree properties maintained");
+            addOperationSeparator();
+            visuals.resetHighlights();
+            statusLabel->setText(QString("Successfully inserted %1").arg(value));
+            setAnimating(false);
+        });
+    };
+    timeline->play(std::move(frames));
 }
 
 void RedBlackTree::deleteNode(int value)
 {
     addStepToHistory(QString("🔍 Searching for node %1 to delete...").arg(value));
-    RBNode *node = findNode(root, value);
-    if (node == NIL) {
+    RBNode *node = engine.find(value);
+    if (node == engine.nil()) {
         statusLabel->setText(QString("Value %1 not found!").arg(value));
         addStepToHistory(QString("❌ Delete failed: Value %1 not found in tree").arg(value));
         addOperationSeparator();
@@ -1303,264 +2027,95 @@ void RedBlackTree::deleteNode(int value)
     addStepToHistory(QString("🎯 Found node %1, preparing for deletion").arg(value));
     
     // Determine deletion case
-    if (node->left == NIL && node->right == NIL) {
+    if (node->left == engine.nil() && node->right == engine.nil()) {
         addStepToHistory("📋 Case: Node has no children (leaf node)");
-    } else if (node->left == NIL || node->right == NIL) {
+    } else if (node->left == engine.nil() || node->right == engine.nil()) {
         addStepToHistory("📋 Case: Node has one child");
     } else {
         addStepToHistory("📋 Case: Node has two children (complex deletion)");
         addStepToHistory("🔄 Finding inorder successor for replacement");
     }
 
-    isAnimating = true;
-    insertButton->setEnabled(false);
-    deleteButton->setEnabled(false);
-    searchButton->setEnabled(false);
-
-    // Highlight node to be deleted
-    node->isHighlighted = true;
-    statusLabel->setText(QString("Deleting %1...").arg(value));
-    addStepToHistory("🔴 Node marked for deletion (highlighted)");
-    update();
-
-    QTimer::singleShot(800, this, [this, node, value]() {
+    setAnimating(true);
+
+    // Highlight node to be deleted, unlink it, then show each fix-up step
+    std::vector<AnimationFrame> frames(2);
+    frames[0].durationMs = 800;
+    frames[0].reach = [this]() {
+        addStepToHistory("🔴 Node marked for deletion (highlighted)");
+    };
+    frames[0].show = [this, value]() {
+        visuals[value].isHighlighted = true;
+        statusLabel->setText(QString("Deleting %1...").arg(value));
+    };
+
+    frames[1].changesEngine = true;
+    frames[1].reach = [this, value]() {
         addStepToHistory("⚖️ Applying Red-Black deletion rules");
-        root = deleteNodeHelper(root, value);
-
-        statusLabel->setText(QString("Successfully deleted %1").arg(value));
-        addStepToHistory(QString("✅ Node %1 successfully deleted").arg(value));
-        addStepToHistory("🎯 Red-Black tree properties maintained");
-        addOperationSeparator();
-
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        update();
-    });
+        engine.remove(value, false);
+        queueRebalance([this, value]() {
+            addStepToHistory(QString("✅ Node %1 successfully deleted").arg(value));
+            addStepToHistory("🎯 Red-Black tree properties maintained");
+            addOperationSeparator();
+            visuals.resetHighlights();
+            statusLabel->setText(QString("Successfully deleted %1").arg(value));
+            setAnimating(false);
+        });
+    };
+    frames[1].show = [this, value]() {
+        statusLabel->setText(QString("Deleted %1, fixing Red-Black properties...").arg(value));
+    };
+    timeline->play(std::move(frames));
 }
 
-RBNode* RedBlackTree::deleteNodeHelper(RBNode* node, int value)
+void RedBlackTree::setAnimating(bool animating)
 {
-    if (node == NIL) return NIL;
-
-    if (value < node->value) {
-        node->left = deleteNodeHelper(node->left, value);
-        if (node->left != NIL) {
-            node->left->parent = node;
-        }
-    } else if (value > node->value) {
-        node->right = deleteNodeHelper(node->right, value);
-        if (node->right != NIL) {
-            node->right->parent = node;
-        }
-    } else {
-        // Node found - delete it
-        Color originalColor = node->color;
-        RBNode* replacement = NIL;
-        RBNode* parent = node->parent;
-        bool isLeftChild = parent && parent->left == node;
-
-        if (node->left == NIL) {
-            replacement = node->right;
-            if (replacement != NIL) {
-                replacement->parent = parent;
-            }
-            if (parent) {
-                if (isLeftChild) {
-                    parent->left = replacement;
-                } else {
-                    parent->right = replacement;
-                }
-            } else {
-                root = replacement;
-            }
-            if (originalColor == BLACK) {
-                if (replacement != NIL) {
-                    fixDelete(replacement);
-                } else if (parent) {
-                    // Double-black situation - replacement is NIL
-                    // Use a temporary node to represent the double-black position
-                    RBNode* doubleBlack = new RBNode(0);
-                    doubleBlack->color = BLACK;
-                    doubleBlack->parent = parent;
-                    doubleBlack->left = NIL;
-                    doubleBlack->right = NIL;
-                    if (isLeftChild) {
-                        parent->left = doubleBlack;
-                    } else {
-                        parent->right = doubleBlack;
-                    }
-                    fixDelete(doubleBlack);
-                    // Remove the marker
-                    if (isLeftChild) {
-                        parent->left = NIL;
-                    } else {
-                        parent->right = NIL;
-                    }
-                    delete doubleBlack;
-                }
-            }
-            delete node;
-            return replacement;
-        } else if (node->right == NIL) {
-            replacement = node->left;
-            if (replacement != NIL) {
-                replacement->parent = parent;
-            }
-            if (parent) {
-                if (isLeftChild) {
-                    parent->left = replacement;
-                } else {
-                    parent->right = replacement;
-                }
-            } else {
-                root = replacement;
-            }
-            if (originalColor == BLACK) {
-                if (replacement != NIL) {
-                    fixDelete(replacement);
-                } else if (parent) {
-                    RBNode* doubleBlack = new RBNode(0);
-                    doubleBlack->color = BLACK;
-                    doubleBlack->parent = parent;
-                    doubleBlack->left = NIL;
-                    doubleBlack->right = NIL;
-                    if (isLeftChild) {
-                        parent->left = doubleBlack;
-                    } else {
-                        parent->right = doubleBlack;
-                    }
-                    fixDelete(doubleBlack);
-                    if (isLeftChild) {
-                        parent->left = NIL;
-                    } else {
-                        parent->right = NIL;
-                    }
-                    delete doubleBlack;
-                }
-            }
-            delete node;
-            return replacement;
-        }
-
-        // Node with two children
-        RBNode* successor = findMin(node->right);
-        originalColor = successor->color;
-        node->value = successor->value;
-        node->right = deleteNodeHelper(node->right, successor->value);
-        if (node->right != NIL) {
-            node->right->parent = node;
-        }
-        if (originalColor == BLACK) {
-            // The successor was deleted, need to fix
-            // Note: This is simplified - full implementation would track the replacement
-        }
-    }
-
-    return node;
+    isAnimating = animating;
+    insertButton->setEnabled(!animating);
+    deleteButton->setEnabled(!animating);
+    searchButton->setEnabled(!animating);
+    clearButton->setEnabled(!animating);
+    bulkButton->setEnabled(!animating);
+    loadButton->setEnabled(!animating);
+    undoButton->setEnabled(!animating && versionHistory.canUndo());
+    redoButton->setEnabled(!animating && versionHistory.canRedo());
 }
 
-void RedBlackTree::fixDelete(RBNode* node)
+void RedBlackTree::queueRebalance(std::function<void()> done)
 {
-    // Basic fixDelete implementation
-    // This is a simplified version - full implementation would handle all cases
-    while (node != root && (!node || node->color == BLACK)) {
-        if (!node || !node->parent) break;
-
-        if (node == node->parent->left) {
-            RBNode* sibling = node->parent->right;
-            
-            if (sibling && sibling->color == RED) {
-                // Case 1: Sibling is red
-                sibling->color = BLACK;
-                node->parent->color = RED;
-                rotateLeftSync(node->parent);
-                sibling = node->parent->right;
-            }
-
-            if ((!sibling || sibling == NIL) ||
-                ((!sibling->left || sibling->left == NIL || sibling->left->color == BLACK) &&
-                 (!sibling->right || sibling->right == NIL || sibling->right->color == BLACK))) {
-                // Case 2: Sibling and both children are black
-                if (sibling && sibling != NIL) {
-                    sibling->color = RED;
-                }
-                node = node->parent;
-            } else {
-                // Case 3 & 4: Sibling has at least one red child
-                if (!sibling->right || sibling->right == NIL || sibling->right->color == BLACK) {
-                    if (sibling->left && sibling->left != NIL) {
-                        sibling->left->color = BLACK;
-                    }
-                    if (sibling && sibling != NIL) {
-                        sibling->color = RED;
-                    }
-                    rotateRightSync(sibling);
-                    sibling = node->parent->right;
-                }
-                if (sibling && sibling != NIL) {
-                    sibling->color = node->parent->color;
-                }
-                node->parent->color = BLACK;
-                if (sibling->right && sibling->right != NIL) {
-                    sibling->right->color = BLACK;
-                }
-                rotateLeftSync(node->parent);
-                node = root;
-            }
-        } else {
-            RBNode* sibling = node->parent->left;
-            
-            if (sibling && sibling->color == RED) {
-                sibling->color = BLACK;
-                node->parent->color = RED;
-                rotateRightSync(node->parent);
-                sibling = node->parent->left;
-            }
+    if (!engine.isRebalancePending()) {
+        // A frame of its own, so the last step stays highlighted a while
+        AnimationFrame finish;
+        finish.reach = done;
+        timeline->extend({std::move(finish)});
+        return;
+    }
 
-            if ((!sibling || sibling == NIL) ||
-                ((!sibling->right || sibling->right == NIL || sibling->right->color == BLACK) &&
-                 (!sibling->left || sibling->left == NIL || sibling->left->color == BLACK))) {
-                if (sibling && sibling != NIL) {
-                    sibling->color = RED;
-                }
-                node = node->parent;
-            } else {
-                if (!sibling->left || sibling->left == NIL || sibling->left->color == BLACK) {
-                    if (sibling->right && sibling->right != NIL) {
-                        sibling->right->color = BLACK;
-                    }
-                    if (sibling && sibling != NIL) {
-                        sibling->color = RED;
-                    }
-                    rotateLeftSync(sibling);
-                    sibling = node->parent->left;
-                }
-                if (sibling && sibling != NIL) {
-                    sibling->color = node->parent->color;
-                }
-                node->parent->color = BLACK;
-                if (sibling->left && sibling->left != NIL) {
-                    sibling->left->color = BLACK;
-                }
-                rotateRightSync(node->parent);
-                node = root;
-            }
+    // One frame per rotation or recolouring; the count is only known as
+    // they happen, so each frame queues the next one
+    AnimationFrame step;
+    step.durationMs = 800;
+    step.changesEngine = true;
+    step.reach = [this, done]() {
+        fixValue.reset();
+        engine.rebalanceStep();
+        queueRebalance(done);
+    };
+    step.show = [this]() {
+        visuals.resetHighlights();
+        if (fixValue && engine.contains(*fixValue)) {
+            visuals[*fixValue].isHighlighted = true;
+            statusLabel->setText(QString("Fixing Red-Black properties at %1").arg(*fixValue));
         }
-    }
-    
-    if (node && node != NIL) {
-        node->color = BLACK;
-    }
-    root->color = BLACK;
+    };
+    timeline->extend({std::move(step)});
 }
 
 void RedBlackTree::searchNode(int value)
 {
-    resetHighlights(root);
+    visuals.resetHighlights();
     
-    if (root == NIL) {
+    if (engine.root() == engine.nil()) {
         addStepToHistory("❌ Tree is empty - search failed");
         statusLabel->setText("Tree is empty!");
         addOperationSeparator();
@@ -1568,10 +2123,10 @@ void RedBlackTree::searchNode(int value)
     }
     
     addStepToHistory("🌳 Starting search from root");
-    RBNode *node = findNode(root, value);
+    RBNode *node = engine.find(value);
 
-    if (node != NIL) {
-        node->isHighlighted = true;
+    if (node != engine.nil()) {
+        visuals[value].isHighlighted = true;
         statusLabel->setText(QString("Found %1 in tree!").arg(value));
         addStepToHistory(QString("🎯 Traversing tree to find %1...").arg(value));
         addStepToHistory(QString("✅ Success! Found node %1 in tree").arg(value));
@@ -1585,28 +2140,6 @@ void RedBlackTree::searchNode(int value)
     update();
 }
 
-RBNode* RedBlackTree::findMin(RBNode* node)
-{
-    while (node && node->left != NIL) {
-        node = node->left;
-    }
-    return node;
-}
-
-RBNode* RedBlackTree::findNode(RBNode* node, int value)
-{
-    if (node == NIL || node->value == value) {
-        return node;
-    }
-
-    if (value < node->value) {
-        return findNode(node->left, value);
-    }
-    return findNode(node->right, value);
-}
-
-
-
 // addHistory function removed - now using addStepToHistory directly
 
 QString RedBlackTree::getCurrentTime()
@@ -1614,54 +2147,79 @@ QString RedBlackTree::getCurrentTime()
     return QDateTime::currentDateTime().toString("HH:mm:ss");
 }
 
-void RedBlackTree::calculateNodePositions(RBNode *node, int x, int y, int horizontalSpacing)
+void RedBlackTree::updateLayout(const QRect &canvasRect)
 {
-    if (node == NIL) return;
-
-    node->x = x;
-    node->y = y;
+    if (canvasRect != layoutCanvas) {
+        layoutCanvas = canvasRect;
+        visuals.invalidateLayout();
+    }
+    if (visuals.isLayoutValid()) return;
 
-    int nextSpacing = horizontalSpacing / 2;
+    QElapsedTimer timer;
+    timer.start();
 
-    if (node->left != NIL) {
-        calculateNodePositions(node->left, x - horizontalSpacing, y + 80, nextSpacing);
+    const auto placements = TidyTreeLayout::layout(engine.root(), engine.nil(), 2 * NODE_RADIUS + NODE_GAP);
+    int minX = 0, maxX = 0;
+    for (const auto &placement : placements) {
+        minX = std::min(minX, placement.x);
+        maxX = std::max(maxX, placement.x);
     }
-    if (node->right != NIL) {
-        calculateNodePositions(node->right, x + horizontalSpacing, y + 80, nextSpacing);
+
+    // Spread small trees out to fill the canvas; a tree wider than the
+    // canvas keeps the minimum gap and stays centred on its root
+    const int available = canvasRect.width() - 2 * NODE_RADIUS - 2 * NODE_GAP;
+    const int width = maxX - minX;
+    const bool fits = width <= available;
+    const double spread = fits && width > 0 ? std::min(MAX_LAYOUT_SPREAD, static_cast<double>(available) / width) : 1.0;
+    const double anchor = fits ? (minX + maxX) / 2.0 : 0.0;
+    const int treeCenterX = canvasRect.x() + canvasRect.width() / 2;
+    const int treeStartY = canvasRect.y() + 40;
+
+    for (const auto &placement : placements) {
+        NodeVisual &visual = visuals.place(placement.node->value);
+        visual.x = treeCenterX + static_cast<int>(std::lround((placement.x - anchor) * spread));
+        visual.y = treeStartY + placement.depth * LEVEL_HEIGHT;
     }
+    visuals.updateSubtreeBounds(placements, engine.nil());
+    visuals.setLayoutValid();
+    staticLayer.invalidate();
+    layoutNanoseconds = timer.nsecsElapsed();
 }
 
-void RedBlackTree::resetHighlights(RBNode *node)
+void RedBlackTree::paintEvent(QPaintEvent *event)
 {
-    if (node == NIL) return;
-    node->isHighlighted = false;
-    node->isRotating = false;
-    resetHighlights(node->left);
-    resetHighlights(node->right);
-}
+    Q_UNUSED(event);
 
-void RedBlackTree::resetTraversalHighlights(RBNode *node)
-{
-    if (node == NIL) return;
-    node->isTraversalHighlighted = false;
-    node->isVisited = false;
-    resetTraversalHighlights(node->left);
-    resetTraversalHighlights(node->right);
-}
+    // Calculate canvas area (left 70% of content area)
+    int canvasY = 200; // Position like binary search tree
+    int canvasHeight = height() - canvasY - 30;
+    int canvasWidth = (int)(width() * 0.65);
+    QRect canvasRect(30, canvasY, canvasWidth, canvasHeight);
+
+    const bool hasTree = engine.root() != engine.nil();
+    if (hasTree) {
+        // Positions are only recomputed when the shape or canvas changed
+        updateLayout(canvasRect);
+        viewport.setCanvas(canvasRect);
+    }
 
-void RedBlackTree::clearTree(RBNode *node)
-{
-    if (node == NIL) return;
-    clearTree(node->left);
-    clearTree(node->right);
-    delete node;
+    QPainter painter(this);
+    staticLayer.draw(painter, this, [&](QPainter &layer) { paintStaticLayer(layer, canvasRect); });
+    if (!hasTree) return;
+
+    // Only the highlighted nodes are drawn each frame, over the cached rest
+    painter.setClipRect(canvasRect);
+    painter.setTransform(viewport.transform());
+    painter.setRenderHint(QPainter::Antialiasing, viewport.zoom() >= 0.5);
+    painter.setFont(QFont("Segoe UI", 12, QFont::Bold));
+    visuals.forEachDecorated([&](int value, const NodeVisual &visual) {
+        RBNode *node = engine.find(value);
+        if (node != engine.nil()) drawNode(painter, node, visual);
+    });
 }
 
-void RedBlackTree::paintEvent(QPaintEvent *event)
+void RedBlackTree::paintStaticLayer(QPainter &painter, const QRect &canvasRect)
 {
-    Q_UNUSED(event);
-
-    QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
     // Background gradient
@@ -1671,75 +2229,123 @@ void RedBlackTree::paintEvent(QPaintEvent *event)
     painter.fillRect(rect(), gradient);
 
     // Draw tree on the main widget if we're on tree view
-    if (root != NIL) {
-        // Calculate canvas area (left 70% of content area)
-        int canvasY = 200; // Position like binary search tree
-        int canvasHeight = height() - canvasY - 30;
-        int canvasWidth = (int)(width() * 0.65);
-        QRect canvasRect(30, canvasY, canvasWidth, canvasHeight);
+    if (engine.root() == engine.nil()) return;
+
+    // Draw white canvas background
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::white);
+    painter.drawRoundedRect(canvasRect, 12, 12);
+
+    painter.save();
+    painter.setClipRect(canvasRect);
+    painter.setTransform(viewport.transform());
+    // Antialiasing thousands of tiny shapes costs more than it shows
+    painter.setRenderHint(QPainter::Antialiasing, viewport.zoom() >= 0.5);
+    painter.setFont(QFont("Segoe UI", 12, QFont::Bold));
+    drawTree(painter);
+    painter.restore();
+
+    painter.setPen(QColor(120, 120, 140));
+    painter.setFont(QFont("Segoe UI", 9));
+    painter.drawText(canvasRect.adjusted(12, 0, -12, -8), Qt::AlignLeft | Qt::AlignBottom,
+                     QString("📐 Tidy layout: %1 nodes in %2 ms")
+                         .arg(engine.size())
+                         .arg(layoutNanoseconds / 1e6, 0, 'f', 2));
+    painter.drawText(canvasRect.adjusted(12, 0, -12, -8), Qt::AlignRight | Qt::AlignBottom,
+                     QString("🔍 %1% · drag to pan, wheel to zoom, double-click to reset")
+                         .arg(viewport.zoom() * 100, 0, 'f', viewport.zoom() < 0.1 ? 2 : 0));
+}
 
-        // Draw white canvas background
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(Qt::white);
-        painter.drawRoundedRect(canvasRect, 12, 12);
+void RedBlackTree::wheelEvent(QWheelEvent *event)
+{
+    if (viewport.wheel(event)) {
+        staticLayer.invalidate();
+        update();
+    } else {
+        QWidget::wheelEvent(event);
+    }
+}
 
-        // Calculate and draw tree
-        int treeCenterX = canvasRect.x() + canvasRect.width() / 2;
-        int treeStartY = canvasRect.y() + 40;
+void RedBlackTree::mousePressEvent(QMouseEvent *event)
+{
+    if (viewport.press(event)) setCursor(Qt::ClosedHandCursor);
+    else QWidget::mousePressEvent(event);
+}
 
-        calculateNodePositions(root, treeCenterX, treeStartY, canvasWidth / 4);
-        drawTree(painter, root);
+void RedBlackTree::mouseMoveEvent(QMouseEvent *event)
+{
+    if (viewport.move(event)) {
+        staticLayer.invalidate();
+        update();
+    } else {
+        QWidget::mouseMoveEvent(event);
     }
 }
 
-void RedBlackTree::drawTree(QPainter &painter, RBNode *node)
+void RedBlackTree::mouseReleaseEvent(QMouseEvent *event)
 {
-    if (node == NIL) return;
+    if (viewport.release(event)) unsetCursor();
+    else QWidget::mouseReleaseEvent(event);
+}
 
-    if (node->left != NIL) {
-        drawEdge(painter, node->x, node->y, node->left->x, node->left->y, node->left->color);
-        drawTree(painter, node->left);
-    }
-    if (node->right != NIL) {
-        drawEdge(painter, node->x, node->y, node->right->x, node->right->y, node->right->color);
-        drawTree(painter, node->right);
+void RedBlackTree::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (viewport.doubleClick(event)) {
+        staticLayer.invalidate();
+        update();
+    } else {
+        QWidget::mouseDoubleClickEvent(event);
     }
+}
 
-    drawNode(painter, node);
+void RedBlackTree::drawTree(QPainter &painter)
+{
+    viewport.walk(engine.root(), engine.nil(), visuals, NODE_RADIUS,
+        [&](RBNode *node, const NodeVisual &visual) {
+            // Edges first, so the node covers their ends
+            for (RBNode *child : {node->left, node->right}) {
+                if (child == engine.nil()) continue;
+                const NodeVisual below = visuals.at(child->value);
+                drawEdge(painter, visual.x, visual.y, below.x, below.y, child->color());
+            }
+            drawNode(painter, node, visual.undecorated());
+        },
+        [&](RBNode *, const NodeVisual &visual) {
+            viewport.drawSummary(painter, visual, QColor(52, 58, 64));
+        });
 }
 
-void RedBlackTree::drawNode(QPainter &painter, RBNode *node)
+void RedBlackTree::drawNode(QPainter &painter, RBNode *node, const NodeVisual &visual)
 {
-    if (node == NIL) return;
+    const Color color = node->color();
 
     // Node circle - larger for rotating nodes
-    int radius = node->isRotating ? NODE_RADIUS + 5 : NODE_RADIUS;
+    int radius = visual.isRotating ? NODE_RADIUS + 5 : NODE_RADIUS;
 
-    if (node->isTraversalHighlighted) {
+    if (visual.isTraversalHighlighted) {
         painter.setPen(QPen(QColor(255, 140, 0), 4));  // Orange border for currently visiting
         painter.setBrush(QColor(255, 165, 0));         // Orange fill
-    } else if (node->isVisited && traversalType != TraversalType::None) {
+    } else if (visual.isVisited && traversalType != TraversalType::None) {
         painter.setPen(QPen(QColor(34, 139, 34), 4));  // Green border for visited (only during traversal)
         painter.setBrush(QColor(50, 205, 50));         // Green fill
-    } else if (node->isHighlighted) {
+    } else if (visual.isHighlighted) {
         painter.setPen(QPen(QColor(255, 215, 0), 4));
-        painter.setBrush(node->color == RED ? QColor(255, 150, 150) : QColor(100, 100, 100));
-    } else if (node->isRotating) {
+        painter.setBrush(color == RED ? QColor(255, 150, 150) : QColor(100, 100, 100));
+    } else if (visual.isRotating) {
         painter.setPen(QPen(QColor(0, 200, 0), 4));
-        painter.setBrush(node->color == RED ? QColor(255, 100, 100) : QColor(80, 80, 80));
+        painter.setBrush(color == RED ? QColor(255, 100, 100) : QColor(80, 80, 80));
     } else {
         // Default Red-Black Tree colors
         painter.setPen(QPen(Qt::black, 2));
-        painter.setBrush(node->color == RED ? QColor(220, 53, 69) : QColor(52, 58, 64));
+        painter.setBrush(color == RED ? QColor(220, 53, 69) : QColor(52, 58, 64));
     }
 
-    painter.drawEllipse(QPoint(node->x, node->y), radius, radius);
+    painter.drawEllipse(QPoint(visual.x, visual.y), radius, radius);
 
-    // Node value
+    // Node value, in the font paintEvent set; unreadable when zoomed far out
+    if (!viewport.showsLabels(radius)) return;
     painter.setPen(Qt::white);
-    QFont font("Segoe UI", 12, QFont::Bold);
-    painter.setFont(font);
-    painter.drawText(QRect(node->x - radius, node->y - radius,
+    painter.drawText(QRect(visual.x - radius, visual.y - radius,
                            radius * 2, radius * 2),
                      Qt::AlignCenter, QString::number(node->value));
 }
@@ -1759,6 +2365,15 @@ void RedBlackTree::setControlsEnabled(bool enabled)
     deleteButton->setEnabled(enabled);
     searchButton->setEnabled(enabled);
     clearButton->setEnabled(enabled);
+    bulkButton->setEnabled(enabled);
+    loadButton->setEnabled(enabled);
+    selectButton->setEnabled(enabled);
+    rankButton->setEnabled(enabled);
+    rangeButton->setEnabled(enabled);
+    scanButton->setEnabled(enabled);
+    undoButton->setEnabled(enabled && versionHistory.canUndo());
+    redoButton->setEnabled(enabled && versionHistory.canRedo());
+    compareButton->setEnabled(enabled);
     bfsButton->setEnabled(enabled);
     dfsButton->setEnabled(enabled);
 }
@@ -1766,168 +2381,142 @@ void RedBlackTree::setControlsEnabled(bool enabled)
 void RedBlackTree::onStartBFS()
 {
     showAlgorithm("BFS");
-    
-    if (root == NIL) {
+
+    if (engine.root() == engine.nil()) {
         addStepToHistory("❌ Tree is empty: Please insert nodes first");
         QMessageBox::warning(this, "Empty Tree", "Please insert nodes to the tree first.");
         return;
     }
-    
+
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "bfs");
     addStepToHistory("🌊 Starting BFS traversal from root");
-    resetTraversalHighlights(root);
+    visuals.resetTraversal();
     traversalType = TraversalType::BFS;
-    traversalOrder.clear();
+    traversalCursor = engine.cursor(TraversalOrder::LevelOrder);
+    traversalCurrent = nullptr;
     traversalIndex = 0;
-    
-    performBFS();
-    
-    QString result = "🌊 BFS Order: ";
-    for (int i = 0; i < traversalOrder.size(); ++i) {
-        result += QString::number(traversalOrder[i]->value);
-        if (i < traversalOrder.size() - 1) result += " → ";
-    }
-    
-    traversalResultList->clear();
-    if (traversalOrder.isEmpty()) {
-        traversalResultList->addItem("❌ No traversal result");
-    } else {
-        traversalResultList->addItem(result);
-    }
-    
+
+    showTraversalResult("🌊 BFS Order: ", TraversalOrder::LevelOrder);
+    addStepToHistory("🔄 Initializing BFS queue");
+    addStepToHistory(QString("➕ Added root node %1 to queue").arg(engine.root()->value));
+
     setControlsEnabled(false);
-    traversalAnimTimer->start(800);
+    traversalAnimTimer->start(AnimationTimeline::scaled(800));
     statusLabel->setText("Running BFS...");
-    addStepToHistory("✅ BFS traversal order computed, starting animation");
+    addStepToHistory("✅ BFS ready, visiting one node per step");
     addOperationSeparator();
 }
 
 void RedBlackTree::onStartDFS()
 {
     showAlgorithm("DFS");
-    
-    if (root == NIL) {
+
+    if (engine.root() == engine.nil()) {
         addStepToHistory("❌ Tree is empty: Please insert nodes first");
         QMessageBox::warning(this, "Empty Tree", "Please insert nodes to the tree first.");
         return;
     }
-    
+
+    OperationRecorder::instance().record(LoggedOperation::RedBlack, "dfs");
     addStepToHistory("🏔️ Starting DFS traversal from root");
-    resetTraversalHighlights(root);
+    visuals.resetTraversal();
     traversalType = TraversalType::DFS;
-    traversalOrder.clear();
+    traversalCursor = engine.cursor(TraversalOrder::PreOrder);
+    traversalCurrent = nullptr;
     traversalIndex = 0;
-    
-    performDFS();
-    
-    QString result = "🏔️ DFS Order: ";
-    for (int i = 0; i < traversalOrder.size(); ++i) {
-        result += QString::number(traversalOrder[i]->value);
-        if (i < traversalOrder.size() - 1) result += " → ";
-    }
-    
-    traversalResultList->clear();
-    if (traversalOrder.isEmpty()) {
-        traversalResultList->addItem("❌ No traversal result");
-    } else {
-        traversalResultList->addItem(result);
-    }
-    
+
+    showTraversalResult("🏔️ DFS Order: ", TraversalOrder::PreOrder);
+    addStepToHistory("🔄 Starting DFS traversal (preorder: Root → Left → Right)");
+    addStepToHistory("📍 Following child and parent links - no recursion, no stack");
+
     setControlsEnabled(false);
-    traversalAnimTimer->start(800);
+    traversalAnimTimer->start(AnimationTimeline::scaled(800));
     statusLabel->setText("Running DFS...");
-    addStepToHistory("✅ DFS traversal order computed, starting animation");
+    addStepToHistory("✅ DFS ready, visiting one node per step");
     addOperationSeparator();
 }
 
-void RedBlackTree::performBFS()
+void RedBlackTree::showTraversalResult(const QString &title, TraversalOrder order)
 {
-    if (root == NIL) return;
-    
-    addStepToHistory("🔄 Initializing BFS queue");
-    QList<RBNode*> queue;
-    queue.append(root);
-    addStepToHistory(QString("➕ Added root node %1 to queue").arg(root->value));
-    
-    while (!queue.isEmpty()) {
-        RBNode* current = queue.front();
-        queue.pop_front();
-        traversalOrder.append(current);
-        
-        addStepToHistory(QString("🎯 Processing node %1").arg(current->value));
-        
-        if (current->left != NIL) {
-            queue.append(current->left);
-            addStepToHistory(QString("⬅️ Added left child %1 to queue").arg(current->left->value));
-        }
-        if (current->right != NIL) {
-            queue.append(current->right);
-            addStepToHistory(QString("➡️ Added right child %1 to queue").arg(current->right->value));
+    // A walk of its own: the order is listed without collecting it, and
+    // big trees show only its head and the node count
+    TreeCursor<RBNode> walk = engine.cursor(order);
+    QString result = title;
+    int count = 0;
+    while (RBNode *node = walk.next()) {
+        if (count < TRAVERSAL_PREVIEW_LIMIT) {
+            if (count > 0) result += " → ";
+            result += QString::number(node->value);
         }
+        ++count;
     }
-}
+    if (count > TRAVERSAL_PREVIEW_LIMIT) result += QString(" → … (%1 nodes)").arg(count);
 
-void RedBlackTree::performDFS()
-{
-    if (root == NIL) return;
-    
-    addStepToHistory("🔄 Starting DFS traversal (preorder: Root → Left → Right)");
-    addStepToHistory("📍 Using recursive depth-first approach");
-    
-    // Use recursive DFS for correct preorder traversal
-    performDFSRecursive(root);
+    traversalResultList->clear();
+    if (count == 0) {
+        traversalResultList->addItem("❌ No traversal result");
+    } else {
+        traversalResultList->addItem(result);
+    }
 }
 
-void RedBlackTree::performDFSRecursive(RBNode* node)
+void RedBlackTree::narrateTraversalStep(RBNode *node)
 {
-    if (node == NIL) return;
-    
-    // Preorder: Process current node first
-    traversalOrder.append(node);
-    addStepToHistory(QString("🎯 Visiting node %1 (preorder)").arg(node->value));
-    
-    // Then recursively visit left subtree
-    if (node->left != NIL) {
-        addStepToHistory(QString("⬅️ Going to left subtree of %1").arg(node->value));
-        performDFSRecursive(node->left);
+    if (traversalType == TraversalType::BFS) {
+        addStepToHistory(QString("🎯 Processing node %1").arg(node->value));
+        if (node->left != engine.nil()) {
+            addStepToHistory(QString("⬅️ Added left child %1 to queue").arg(node->left->value));
+        }
+        if (node->right != engine.nil()) {
+            addStepToHistory(QString("➡️ Added right child %1 to queue").arg(node->right->value));
+        }
+        return;
     }
-    
-    // Finally recursively visit right subtree
-    if (node->right != NIL) {
-        addStepToHistory(QString("➡️ Going to right subtree of %1").arg(node->value));
-        performDFSRecursive(node->right);
+
+    // Preorder reaches each node from its parent
+    if (RBNode *parent = node->parent()) {
+        if (node == parent->left) {
+            addStepToHistory(QString("⬅️ Going to left subtree of %1").arg(parent->value));
+        } else {
+            addStepToHistory(QString("➡️ Going to right subtree of %1").arg(parent->value));
+        }
     }
+    addStepToHistory(QString("🎯 Visiting node %1 (preorder)").arg(node->value));
 }
 
 void RedBlackTree::onTraversalAnimationStep()
 {
-    if (traversalIndex > 0 && traversalIndex <= traversalOrder.size()) {
-        RBNode* prev = traversalOrder[traversalIndex - 1];
+    if (traversalCurrent) {
         // Mark previous as visited (persist green), remove highlight
-        prev->isVisited = true;
-        prev->isTraversalHighlighted = false;
+        NodeVisual &visual = visuals[traversalCurrent->value];
+        visual.isVisited = true;
+        visual.isTraversalHighlighted = false;
     }
-    
-    if (traversalIndex >= traversalOrder.size()) {
+
+    RBNode* current = traversalCursor.next();
+    if (!current) {
         QString algo = (traversalType == TraversalType::BFS) ? "BFS" : "DFS";
         traversalAnimTimer->stop();
         traversalType = TraversalType::None;
-        
+        traversalCurrent = nullptr;
+
         // Reset traversal highlights to restore original red/black colors
-        resetTraversalHighlights(root);
-        
+        visuals.resetTraversal();
+
         setControlsEnabled(true);
         statusLabel->setText("Traversal complete.");
-        addStepToHistory(QString("🎯 %1 traversal completed. Visited %2 nodes").arg(algo).arg(traversalOrder.size()));
+        addStepToHistory(QString("🎯 %1 traversal completed. Visited %2 nodes").arg(algo).arg(traversalIndex));
         update();
         return;
     }
-    
-    RBNode* current = traversalOrder[traversalIndex];
-    current->isTraversalHighlighted = true;
-    
+
+    traversalCurrent = current;
+    narrateTraversalStep(current);
+    visuals[current->value].isTraversalHighlighted = true;
+
     QString algo = (traversalType == TraversalType::BFS) ? "BFS" : "DFS";
     addStepToHistory(QString("👁️ %1: Currently visiting node %2").arg(algo).arg(current->value));
-    
+
     traversalIndex++;
     update();
 }
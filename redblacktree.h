@@ -24,39 +24,33 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QRegularExpression>
 #include <QGraphicsDropShadowEffect>
 #include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <vector>
 #include "backbutton.h"
 #include "stylemanager.h"
 #include "widgetmanager.h"
-
-enum Color { RED, BLACK };
-
-struct RBNode {
-    int value;
-    Color color;
-    RBNode *left;
-    RBNode *right;
-    RBNode *parent;
-    int x, y;
-    bool isHighlighted;
-    bool isRotating;
-    bool isSearchHighlighted;
-    bool isDeleteHighlighted;
-    bool isNewNode;
-    bool isTraversalHighlighted;
-    bool isVisited;
-
-    RBNode(int val) : value(val), color(RED), left(nullptr), right(nullptr),
-        parent(nullptr), x(0), y(0), isHighlighted(false),
-        isRotating(false), isSearchHighlighted(false), 
-        isDeleteHighlighted(false), isNewNode(false), 
-        isTraversalHighlighted(false), isVisited(false) {}
-};
+#include "rbtreeengine.h"
+#include "persistentrbtree.h"
+#include "nodevisual.h"
+#include "treelayout.h"
+#include "treeviewport.h"
+#include "staticlayer.h"
+#include "datasetfile.h"
+#include "sessioncontrols.h"
+#include "animationtimeline.h"
 
 // HistoryEntry removed - now using step tracking system
 
-class RedBlackTree : public QWidget
+class RedBlackTree : public QWidget, public ReplayTarget, public EngineObserver
 {
     Q_OBJECT
 
@@ -64,11 +58,25 @@ public:
     explicit RedBlackTree(QWidget *parent = nullptr);
     ~RedBlackTree();
 
+    // ReplayTarget
+    LoggedOperation::Lab replayLab() const override { return LoggedOperation::RedBlack; }
+    bool isReplayBusy() const override;
+    bool replayOperation(const LoggedOperation &operation) override;
+
+    // EngineObserver
+    void onEngineEvent(const EngineEvent &event) override;
+
 signals:
     void backToOperations();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    // Pan and zoom on the canvas
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
 
 private slots:
     void onBackClicked();
@@ -77,6 +85,16 @@ private slots:
     void onSearchClicked();
     void onClearClicked();
     void onRandomizeClicked();
+    void onBulkInsertClicked();
+    void onLoadDatasetClicked();
+    void onSelectClicked();
+    void onRankClicked();
+    void onRangeClicked();
+    void onScanClicked();
+    void onScanAnimationStep();
+    void onUndoClicked();
+    void onRedoClicked();
+    void onCompareClicked();
     void onViewAlgorithmClicked();
     void onAlgorithmBackClicked();
     void showInsertionAlgorithm();
@@ -93,40 +111,36 @@ private:
     void setupStepTrace();
     void setupAlgorithmView();
     void setupTraversalControls();
+    void setupOrderStatisticsControls();
+    void setupHistoryControls();
+    void setupTimelineControls();
+    void setupSessionControls();
 
     // RB Tree operations
     void insertNode(int value);
+    void bulkInsert(const QVector<int> &values);  // Headless: no timers, one repaint
+    void loadDataset(const QString &path);         // O(n) balanced build, replaces the tree
+    bool readRangeInput(int &lo, int &hi);
+    void narrateCountWalk(const std::vector<RBNode*> &path, int value, bool inclusive);
+    void showOrderStatsResult(const QString &result);
+    void restoreVersion(int index, const QString &action);
+    void refreshVersionList();
+    QString describeVersion(int index) const;
     void deleteNode(int value);
     void searchNode(int value);
-    RBNode* BSTInsert(RBNode* root, RBNode* node);
-    void fixInsert(RBNode* node);
-    void rotateLeft(RBNode* node);
-    void rotateRight(RBNode* node);
-    void rotateLeftSync(RBNode* node);  // Synchronous rotation for fixInsert
-    void rotateRightSync(RBNode* node); // Synchronous rotation for fixInsert
-    RBNode* findNode(RBNode* node, int value);
-    void fixDelete(RBNode* node);
-    RBNode* findMin(RBNode* node);
-    void transplant(RBNode* u, RBNode* v);
-    RBNode* deleteNodeHelper(RBNode* node, int value);
-
-    // Animation
-    void animateRotation(RBNode* node, const QString& direction);
-    void highlightNode(RBNode* node, int delay);
+    void setAnimating(bool animating);
+    void queueRebalance(std::function<void()> done);  // One frame per fix-up step
 
     // Drawing
-    void calculateNodePositions(RBNode *node, int x, int y, int horizontalSpacing);
-    void drawTree(QPainter &painter, RBNode *node);
-    void drawNode(QPainter &painter, RBNode *node);
+    void updateLayout(const QRect &canvasRect);
+    void paintStaticLayer(QPainter &painter, const QRect &canvasRect);
+    void drawTree(QPainter &painter);
+    void drawNode(QPainter &painter, RBNode *node, const NodeVisual &visual);
     void drawEdge(QPainter &painter, int x1, int y1, int x2, int y2, Color color);
-    void clearTree(RBNode *node);
-    void resetHighlights(RBNode *node);
-    void resetTraversalHighlights(RBNode *node);
     
     // Traversal methods
-    void performBFS();
-    void performDFS();
-    void performDFSRecursive(RBNode* node);
+    void showTraversalResult(const QString &title, TraversalOrder order);
+    void narrateTraversalStep(RBNode *node);
     void setControlsEnabled(bool enabled);
 
     // History and step tracking
@@ -151,6 +165,8 @@ private:
     QPushButton *searchButton;
     QPushButton *clearButton;
     QPushButton *randomizeButton;
+    QPushButton *bulkButton;
+    QPushButton *loadButton;
     QPushButton *bfsButton;
     QPushButton *dfsButton;
 
@@ -168,11 +184,36 @@ private:
     QGroupBox *traversalGroup;
     QListWidget *traversalResultList;
 
+    // Order statistics (select / rank / range count)
+    QGroupBox *orderStatsGroup;
+    QLineEdit *orderStatsInput;
+    QPushButton *selectButton;
+    QPushButton *rankButton;
+    QPushButton *rangeButton;
+    QPushButton *scanButton;
+    QListWidget *orderStatsResultList;
+
+    // Version history (undo / redo / compare)
+    QGroupBox *historyGroup;
+    QListWidget *versionList;
+    QPushButton *undoButton;
+    QPushButton *redoButton;
+    QPushButton *compareButton;
+
+    // Animation speed / scrubbing, session record / replay
+    TimelineControls *timelineControls;
+    SessionControls *sessionControls;
+
     // Algorithm functionality now integrated in right panel
 
-    // Tree data
-    RBNode *root;
-    RBNode *NIL;  // Sentinel node
+    // Tree data - the engine owns the nodes and the NIL sentinel
+    RBTreeEngine engine;
+    NodeVisualTable visuals;  // Positions and highlights, keyed by value
+    QRect layoutCanvas;       // Canvas the cached positions were laid out for
+    qint64 layoutNanoseconds = 0;
+    TreeViewport viewport;
+    StaticLayer staticLayer;  // Background, edges and plain nodes between shape changes
+    RBVersionHistory versionHistory{engine};  // Every version, path-copied
 
     // History and step tracking
     // history vector removed - now using stepHistory QStringList
@@ -182,17 +223,31 @@ private:
     // Animation
     bool isAnimating;
     QTimer *animationTimer;
+    AnimationTimeline *timeline;  // Plays insert/delete step by step
+    std::optional<int> fixValue;  // Node the last fix-up step rotated up or recoloured
     
     // Traversal animation
-    enum class TraversalType { None, BFS, DFS };
+    enum class TraversalType { None, BFS, DFS, Range };
     TraversalType traversalType;
-    QList<RBNode*> traversalOrder;
+    TreeCursor<RBNode> traversalCursor;  // Yields one node per animation step
+    RBNode *traversalCurrent = nullptr;   // Node highlighted by the last step
     int traversalIndex;
     QTimer *traversalAnimTimer;
+    static constexpr int TRAVERSAL_PREVIEW_LIMIT = 32;  // Values listed before "…"
+
+    // Range scan animation - only the keys on show are collected
+    QVector<int> scanKeys;
+    int scanIndex = 0;
+    QTimer *scanTimer;
 
     // Drawing constants
     const int NODE_RADIUS = 25;
     const int LEVEL_HEIGHT = 80;
+    const int NODE_GAP = 10;  // Least space between two nodes on a level
+    static constexpr double MAX_LAYOUT_SPREAD = 3.0;  // Small trees: gaps up to 3x wider
+    static constexpr int MAX_BULK_INSERT = 1000000;
+    static constexpr int MAX_SCAN_ANIMATION = 50;
+    static constexpr int SCAN_STEP_MS = 500;
 };
 
 #endif // REDBLACKTREE_H
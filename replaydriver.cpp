@@ -0,0 +1,315 @@
+#include "replaydriver.h"
+#include "datasetfile.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QPair>
+#include <QTextStream>
+
+#include <cmath>
+
+namespace {
+
+bool parseInt(const QStringList &args, int index, int &value)
+{
+    if (index >= args.size()) return false;
+    bool ok = false;
+    value = args.at(index).trimmed().toInt(&ok);
+    return ok;
+}
+
+// Walks the whole order like the lab's animation does, without a node list
+template<typename Node>
+int walkedNodes(TreeCursor<Node> walk)
+{
+    int count = 0;
+    while (walk.next()) ++count;
+    return count;
+}
+
+} // namespace
+
+QStringList ReplayReport::summary() const
+{
+    struct Aggregate {
+        int count = 0;
+        int rejected = 0;
+        qint64 nanoseconds = 0;
+    };
+
+    // QMap keeps the report sorted by lab, then operation name
+    QMap<QPair<int, QString>, Aggregate> byOperation;
+    qint64 checkNanoseconds = 0;
+    for (const ReplayTiming &timing : timings) {
+        checkNanoseconds += timing.checkNanoseconds;
+        Aggregate &aggregate = byOperation[qMakePair(static_cast<int>(timing.operation.lab), timing.operation.op)];
+        ++aggregate.count;
+        if (!timing.applied) ++aggregate.rejected;
+        aggregate.nanoseconds += timing.nanoseconds;
+    }
+
+    QStringList lines;
+    lines << QString("⚡ Replayed %1 operations in %2 ms")
+                 .arg(timings.size())
+                 .arg(totalNanoseconds / 1e6, 0, 'f', 3);
+    if (checks > 0) {
+        lines << QString("%1 %2 invariant checks, %3 ns/check, %4 violations")
+                     .arg(violations ? QStringLiteral("❌") : QStringLiteral("✅"))
+                     .arg(checks)
+                     .arg(static_cast<double>(checkNanoseconds) / checks, 0, 'f', 0)
+                     .arg(violations);
+        for (int i = 0; i < timings.size(); ++i) {
+            if (!timings.at(i).violation.isEmpty()) {
+                // The first one is the interesting one - later ones usually follow from it
+                lines << QString("   first at #%1 %2 %3: %4")
+                             .arg(i)
+                             .arg(timings.at(i).operation.op, timings.at(i).operation.args.join(' '),
+                                  timings.at(i).violation);
+                break;
+            }
+        }
+    }
+    for (auto it = byOperation.cbegin(); it != byOperation.cend(); ++it) {
+        const Aggregate &aggregate = it.value();
+        const double meanNs = static_cast<double>(aggregate.nanoseconds) / aggregate.count;
+        lines << QString("%1.%2: %3 ops, %4 ns/op, %5 ops/s%6")
+                     .arg(LoggedOperation::labName(static_cast<LoggedOperation::Lab>(it.key().first)),
+                          it.key().second)
+                     .arg(aggregate.count)
+                     .arg(meanNs, 0, 'f', 0)
+                     .arg(meanNs > 0 ? 1e9 / meanNs : 0.0, 0, 'f', 0)
+                     .arg(aggregate.rejected ? QString(" (%1 rejected)").arg(aggregate.rejected) : QString());
+    }
+    return lines;
+}
+
+bool ReplayReport::saveCsv(const QString &path, QString *error) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "index,lab,op,args,applied,ns,check_ns\n";
+    for (int i = 0; i < timings.size(); ++i) {
+        const ReplayTiming &timing = timings.at(i);
+        QString args = timing.operation.args.join(' ');
+        args.replace('"', "\"\"");
+        out << i << ',' << LoggedOperation::labName(timing.operation.lab) << ','
+            << timing.operation.op << ",\"" << args << "\","
+            << (timing.applied ? 1 : 0) << ',' << timing.nanoseconds << ','
+            << timing.checkNanoseconds << '\n';
+    }
+    return true;
+}
+
+ReplayDriver::ReplayDriver()
+{
+    hashMap.setTracingEnabled(false);
+}
+
+ReplayReport ReplayDriver::run(const OperationLog &log)
+{
+    ReplayReport report;
+    report.timings.reserve(log.size());
+
+    QElapsedTimer timer;
+    for (const LoggedOperation &operation : log.operations()) {
+        ReplayTiming timing;
+        timing.operation = operation;
+        timer.start();
+        timing.applied = apply(operation);
+        timing.nanoseconds = timer.nsecsElapsed();
+        report.totalNanoseconds += timing.nanoseconds;
+
+        if (checkInvariants && operation.lab == LoggedOperation::RedBlack) {
+            const RBCheckReport check = rbEngine.checkInvariants(checkScope);
+            timing.checkNanoseconds = check.nanoseconds;
+            ++report.checks;
+            if (!check.valid) {
+                timing.violation = QString::fromStdString(check.violation);
+                ++report.violations;
+            }
+        }
+        report.timings.append(timing);
+    }
+    return report;
+}
+
+bool ReplayDriver::apply(const LoggedOperation &operation)
+{
+    switch (operation.lab) {
+    case LoggedOperation::BST:
+    case LoggedOperation::RedBlack:
+        return applyTree(operation);
+    case LoggedOperation::Graph:
+        return applyGraph(operation);
+    case LoggedOperation::HashTable:
+        return applyHash(operation);
+    }
+    return false;
+}
+
+bool ReplayDriver::applyTree(const LoggedOperation &operation)
+{
+    const bool redBlack = operation.lab == LoggedOperation::RedBlack;
+    const QString &op = operation.op;
+
+    if (op == "clear") {
+        if (redBlack) rbEngine.clear(); else bstEngine.clear();
+        return true;
+    }
+    if (!redBlack && op == "balance" && !operation.args.isEmpty()) {
+        const QString &mode = operation.args.first();
+        if (mode == "none") bstEngine.setBalanceMode(BalanceMode::None);
+        else if (mode == "avl") bstEngine.setBalanceMode(BalanceMode::AVL);
+        else if (mode == "treap") bstEngine.setBalanceMode(BalanceMode::Treap);
+        else return false;
+        return true;
+    }
+    if (!redBlack && op == "rebalance") {
+        // AVL and treap trees keep their own shape; there it is a no-op
+        if (bstEngine.balanceMode() != BalanceMode::None) return false;
+        bstEngine.rebalanceInPlace();
+        return true;
+    }
+    if (op == "bfs") {
+        return (redBlack ? walkedNodes(rbEngine.cursor(TraversalOrder::LevelOrder))
+                         : walkedNodes(bstEngine.cursor(TraversalOrder::LevelOrder))) > 0;
+    }
+    if (op == "dfs") {
+        return (redBlack ? walkedNodes(rbEngine.cursor(TraversalOrder::PreOrder))
+                         : walkedNodes(bstEngine.cursor(TraversalOrder::PreOrder))) > 0;
+    }
+    if (redBlack && op == "bulk") {
+        // Like the lab: straight inserts, then one version for the batch
+        rbEngine.removeObserver(&rbHistory);
+        int inserted = 0;
+        for (int i = 0; i < operation.args.size(); ++i) {
+            int value;
+            if (parseInt(operation.args, i, value) && rbEngine.insert(value)) ++inserted;
+        }
+        rbEngine.addObserver(&rbHistory);
+        if (inserted > 0) rbHistory.snapshot();
+        return inserted > 0;
+    }
+    if (redBlack && (op == "undo" || op == "redo")) {
+        return op == "undo" ? rbHistory.undo() : rbHistory.redo();
+    }
+    if (op == "load") {
+        KeyDataset dataset;
+        return redBlack && !operation.args.isEmpty()
+               && loadKeyDataset(operation.args.first(), dataset)
+               && rbEngine.buildFromSorted(dataset.keys);
+    }
+
+    if (op == "select" && redBlack && !operation.args.isEmpty()) {
+        // Same input as the lab: a 0-based position or a percentile such as "90%"
+        QString text = operation.args.first().trimmed();
+        const bool percentile = text.endsWith('%');
+        if (percentile) text.chop(1);
+        bool ok = false;
+        const double number = text.toDouble(&ok);
+        if (!ok || number < 0 || rbEngine.size() == 0) return false;
+        const int k = percentile ? static_cast<int>(std::lround(number / 100.0 * (rbEngine.size() - 1)))
+                                 : static_cast<int>(number);
+        return rbEngine.select(k) != rbEngine.nil();
+    }
+
+    int value;
+    if (!parseInt(operation.args, 0, value)) return false;
+
+    if (redBlack && op == "version") {
+        return rbHistory.restore(value);
+    } else if (redBlack && op == "rank") {
+        return rbEngine.rank(value) >= 0;
+    } else if (redBlack && op == "range") {
+        int hi;
+        return parseInt(operation.args, 1, hi) && rbEngine.countInRange(value, hi) >= 0;
+    } else if (redBlack && op == "scan") {
+        int hi;
+        // Walk the range the way the lab does, without collecting it
+        return parseInt(operation.args, 1, hi) && rbEngine.rangeQuery(value, hi, [](const RBNode*) {}) >= 0;
+    }
+
+    if (op == "insert") {
+        return redBlack ? rbEngine.insert(value) : bstEngine.insert(value);
+    } else if (op == "search") {
+        return redBlack ? rbEngine.contains(value) : bstEngine.search(value) != nullptr;
+    } else if (op == "delete") {
+        return redBlack ? rbEngine.remove(value) : bstEngine.remove(value);
+    }
+    return false;
+}
+
+bool ReplayDriver::applyGraph(const LoggedOperation &operation)
+{
+    const QString &op = operation.op;
+    int u, v;
+
+    if (op == "addVertex") {
+        if (operation.args.isEmpty()) {
+            graphEngine.addVertex();
+            return true;
+        }
+        return parseInt(operation.args, 0, u) && graphEngine.addVertex(u);
+    } else if (op == "deleteVertex") {
+        return parseInt(operation.args, 0, u) && graphEngine.removeVertex(u);
+    } else if (op == "addEdge") {
+        return parseInt(operation.args, 0, u) && parseInt(operation.args, 1, v) && graphEngine.addEdge(u, v);
+    } else if (op == "deleteEdge") {
+        return parseInt(operation.args, 0, u) && parseInt(operation.args, 1, v) && graphEngine.removeEdge(u, v);
+    } else if (op == "clear") {
+        graphEngine.clear();
+        return true;
+    } else if (op == "bfs" || op == "dfs") {
+        // The lab always starts from the first vertex unless told otherwise
+        if (graphEngine.vertexCount() == 0) return false;
+        int start = graphEngine.vertices().front();
+        if (!operation.args.isEmpty() && !parseInt(operation.args, 0, start)) return false;
+        return op == "bfs" ? !graphEngine.breadthFirstOrder(start).empty()
+                           : !graphEngine.depthFirstOrder(start).empty();
+    }
+    return false;
+}
+
+bool ReplayDriver::applyHash(const LoggedOperation &operation)
+{
+    const QString &op = operation.op;
+
+    if (op == "setTypes") {
+        HashMap::DataType keyType, valueType;
+        if (operation.args.size() < 2
+            || !HashMap::dataTypeFromString(operation.args.at(0), keyType)
+            || !HashMap::dataTypeFromString(operation.args.at(1), valueType)) {
+            return false;
+        }
+        hashMap.setKeyType(keyType);
+        hashMap.setValueType(valueType);
+        hashMap.clear();
+        return true;
+    } else if (op == "clear") {
+        hashMap.clear();
+        return true;
+    }
+
+    if (operation.args.isEmpty()) return false;
+    const QVariant key = HashMap::variantFromString(operation.args.at(0), hashMap.getKeyType());
+    if (!key.isValid()) return false;
+
+    if (op == "put") {
+        if (operation.args.size() < 2) return false;
+        const QVariant value = HashMap::variantFromString(operation.args.at(1), hashMap.getValueType());
+        if (!value.isValid()) return false;
+        hashMap.put(key, value);
+        return true;
+    } else if (op == "get") {
+        return hashMap.get(key).has_value();
+    } else if (op == "delete") {
+        return hashMap.erase(key);
+    }
+    return false;
+}
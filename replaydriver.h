@@ -0,0 +1,73 @@
+#ifndef REPLAYDRIVER_H
+#define REPLAYDRIVER_H
+
+#include "operationlog.h"
+#include "bstengine.h"
+#include "rbtreeengine.h"
+#include "persistentrbtree.h"
+#include "graphengine.h"
+#include "hashmap.h"
+
+#include <QString>
+#include <QVector>
+
+// Timing of one replayed operation
+struct ReplayTiming {
+    LoggedOperation operation;
+    qint64 nanoseconds = 0;
+    bool applied = false;  // false = rejected (duplicate, missing key, bad args...)
+    qint64 checkNanoseconds = 0;  // Invariant check after a Red-Black op, not part of nanoseconds
+    QString violation;            // Empty when the check passed or did not run
+};
+
+struct ReplayReport {
+    QVector<ReplayTiming> timings;
+    qint64 totalNanoseconds = 0;
+    int checks = 0;
+    int violations = 0;
+
+    // One line per lab/op: count, mean ns/op, ops/sec
+    QStringList summary() const;
+    // One row per operation: index,lab,op,args,applied,ns,check_ns
+    bool saveCsv(const QString &path, QString *error = nullptr) const;
+};
+
+// Replays an operation log at full speed against fresh headless engines,
+// with no widgets, timers or step tracing in the way.
+class ReplayDriver
+{
+public:
+    ReplayDriver();
+
+    ReplayReport run(const OperationLog &log);
+
+    // Check the Red-Black invariants after every Red-Black operation.
+    // LastPath keeps the overhead to O(log^2 n) per operation.
+    void setInvariantCheck(bool enabled, RBTreeEngine::CheckScope scope = RBTreeEngine::CheckScope::LastPath)
+    {
+        checkInvariants = enabled;
+        checkScope = scope;
+    }
+
+    const BSTEngine &bst() const { return bstEngine; }
+    const RBTreeEngine &redBlack() const { return rbEngine; }
+    const GraphEngine &graph() const { return graphEngine; }
+    const HashMap &hashTable() const { return hashMap; }
+
+private:
+    bool apply(const LoggedOperation &operation);
+    bool applyTree(const LoggedOperation &operation);
+    bool applyGraph(const LoggedOperation &operation);
+    bool applyHash(const LoggedOperation &operation);
+
+    BSTEngine bstEngine;
+    RBTreeEngine rbEngine;
+    RBVersionHistory rbHistory{rbEngine};  // Backs undo / redo / version
+    GraphEngine graphEngine;
+    HashMap hashMap;
+
+    bool checkInvariants = false;
+    RBTreeEngine::CheckScope checkScope = RBTreeEngine::CheckScope::LastPath;
+};
+
+#endif // REPLAYDRIVER_H
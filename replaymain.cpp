@@ -0,0 +1,54 @@
+#include "replaydriver.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+
+// AdvDS-replay: plays a recorded session against the headless engines.
+//
+//   AdvDS-replay session.jsonl [--csv timings.csv] [--check full|path]
+//
+// A console program of its own, so the summary reaches the terminal on
+// Windows too, where the GUI app has no stdout. Exits 1 when the log
+// can't be loaded or --check finds a broken Red-Black invariant.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (args.size() < 2 || args.value(1).startsWith("--")) {
+        err << "usage: AdvDS-replay session.jsonl [--csv timings.csv] [--check full|path]" << Qt::endl;
+        return 2;
+    }
+
+    OperationLog log;
+    QString error;
+    if (!log.load(args.value(1), &error)) {
+        err << "Cannot load " << args.value(1) << ": " << error << Qt::endl;
+        return 1;
+    }
+
+    ReplayDriver driver;
+    const int checkIndex = args.indexOf("--check");
+    if (checkIndex > 0) {
+        const QString scope = args.value(checkIndex + 1);
+        if (scope != "full" && scope != "path") {
+            err << "--check takes full or path" << Qt::endl;
+            return 1;
+        }
+        driver.setInvariantCheck(true, scope == "full" ? RBTreeEngine::CheckScope::Full
+                                                       : RBTreeEngine::CheckScope::LastPath);
+    }
+    const ReplayReport report = driver.run(log);
+    for (const QString &line : report.summary()) {
+        out << line << Qt::endl;
+    }
+
+    const int csvIndex = args.indexOf("--csv");
+    if (csvIndex > 0 && !report.saveCsv(args.value(csvIndex + 1), &error)) {
+        err << "Cannot write CSV: " << error << Qt::endl;
+        return 1;
+    }
+    return report.violations > 0 ? 1 : 0;
+}
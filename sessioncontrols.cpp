@@ -0,0 +1,200 @@
+#include "sessioncontrols.h"
+#include "replaydriver.h"
+#include "animationtimeline.h"
+#include "stylemanager.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFileDialog>
+
+SessionControls::SessionControls(ReplayTarget *target, QWidget *parent)
+    : QGroupBox(parent)
+    , target(target)
+{
+    StyleManager::instance().applyTraversalGroupStyle(this);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(20, 15, 20, 15);
+    layout->setSpacing(8);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->setSpacing(8);
+
+    recordButton = new QPushButton("⏺ Record");
+    saveButton = new QPushButton("💾 Save");
+    replayButton = new QPushButton("▶ Replay");
+    headlessButton = new QPushButton("⚡ Headless");
+
+    for (QPushButton *button : {recordButton, saveButton, replayButton, headlessButton}) {
+        button->setFixedHeight(30);
+        buttonLayout->addWidget(button);
+    }
+    StyleManager::instance().applyTraversalButtonStyle(recordButton, "#4a90e2");
+    StyleManager::instance().applyTraversalButtonStyle(saveButton, "#4a90e2");
+    StyleManager::instance().applyTraversalButtonStyle(replayButton, "#28a745");
+    StyleManager::instance().applyTraversalButtonStyle(headlessButton, "#28a745");
+
+    layout->addLayout(buttonLayout);
+
+    resultList = new QListWidget();
+    resultList->setFixedHeight(80);
+    StyleManager::instance().applyTraversalResultListStyle(resultList);
+    layout->addWidget(resultList);
+
+    replayTimer = new QTimer(this);
+    replayTimer->setInterval(REPLAY_INTERVAL_MS);
+
+    connect(recordButton, &QPushButton::clicked, this, &SessionControls::onRecordClicked);
+    connect(saveButton, &QPushButton::clicked, this, &SessionControls::onSaveClicked);
+    connect(replayButton, &QPushButton::clicked, this, &SessionControls::onReplayAnimatedClicked);
+    connect(headlessButton, &QPushButton::clicked, this, &SessionControls::onReplayHeadlessClicked);
+    connect(replayTimer, &QTimer::timeout, this, &SessionControls::onReplayTick);
+
+    updateButtons();
+}
+
+void SessionControls::showEvent(QShowEvent *event)
+{
+    // Recording is shared by all labs - pick up changes made in another lab
+    updateButtons();
+    QGroupBox::showEvent(event);
+}
+
+void SessionControls::onRecordClicked()
+{
+    OperationRecorder &recorder = OperationRecorder::instance();
+    if (recorder.isRecording()) {
+        recorder.stop();
+        showMessage(QString("⏹ Recorded %1 operations").arg(recorder.log().size()));
+    } else {
+        recorder.start();
+        showMessage("⏺ Recording operations in every lab...");
+    }
+    updateButtons();
+}
+
+void SessionControls::onSaveClicked()
+{
+    const OperationLog &log = OperationRecorder::instance().log();
+    if (log.isEmpty()) {
+        showMessage("❌ Nothing recorded yet");
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "Save Operation Log", "session.jsonl",
+                                                      "Operation logs (*.jsonl)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (log.save(path, &error)) {
+        showMessage(QString("💾 Saved %1 operations").arg(log.size()));
+    } else {
+        showMessage(QString("❌ Save failed: %1").arg(error));
+    }
+}
+
+bool SessionControls::loadLog(OperationLog &log)
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Open Operation Log", QString(),
+                                                      "Operation logs (*.jsonl);;All files (*)");
+    if (path.isEmpty()) return false;
+
+    QString error;
+    if (!log.load(path, &error)) {
+        showMessage(QString("❌ Load failed: %1").arg(error));
+        return false;
+    }
+    return true;
+}
+
+void SessionControls::onReplayAnimatedClicked()
+{
+    if (replayTimer->isActive()) {
+        replayTimer->stop();
+        showMessage(QString("⏹ Replay stopped at operation %1").arg(pendingIndex));
+        updateButtons();
+        return;
+    }
+
+    OperationLog log;
+    if (!loadLog(log)) return;
+
+    // Only this lab's operations can be animated here
+    pending.clear();
+    for (const LoggedOperation &operation : log.operations()) {
+        if (operation.lab == target->replayLab()) pending.append(operation);
+    }
+    pendingIndex = 0;
+
+    if (pending.isEmpty()) {
+        showMessage(QString("❌ No %1 operations in this log")
+                        .arg(LoggedOperation::labName(target->replayLab())));
+        return;
+    }
+
+    // Don't record the replay into the session being replayed
+    OperationRecorder::instance().stop();
+    showMessage(QString("▶ Replaying %1 operations").arg(pending.size()));
+    replayTimer->start(AnimationTimeline::scaled(REPLAY_INTERVAL_MS));
+    updateButtons();
+}
+
+void SessionControls::onReplayTick()
+{
+    // Follow speed changes made while replaying; instant mode ticks back to back
+    replayTimer->setInterval(AnimationTimeline::scaled(REPLAY_INTERVAL_MS));
+    if (target->isReplayBusy()) return;  // Let the current animation finish
+
+    if (pendingIndex >= pending.size()) {
+        replayTimer->stop();
+        showMessage("✅ Replay complete");
+        updateButtons();
+        return;
+    }
+
+    const LoggedOperation &operation = pending.at(pendingIndex++);
+    const QString text = QString("%1 %2").arg(operation.op, operation.args.join(' ')).trimmed();
+    if (!target->replayOperation(operation)) {
+        showMessage(QString("⚠️ Skipped: %1").arg(text));
+    }
+}
+
+void SessionControls::onReplayHeadlessClicked()
+{
+    OperationLog log;
+    if (!loadLog(log)) return;
+
+    ReplayDriver driver;
+    const ReplayReport report = driver.run(log);
+
+    resultList->clear();
+    resultList->addItems(report.summary());
+    resultList->scrollToTop();
+
+    const QString csvPath = QFileDialog::getSaveFileName(this, "Save Per-Operation Timings (optional)",
+                                                         "replay-timings.csv", "CSV files (*.csv)");
+    if (!csvPath.isEmpty()) {
+        QString error;
+        if (!report.saveCsv(csvPath, &error)) {
+            showMessage(QString("❌ CSV export failed: %1").arg(error));
+        }
+    }
+}
+
+void SessionControls::updateButtons()
+{
+    const bool recording = OperationRecorder::instance().isRecording();
+    const bool replaying = replayTimer->isActive();
+
+    recordButton->setText(recording ? "⏹ Stop" : "⏺ Record");
+    recordButton->setEnabled(!replaying);
+    saveButton->setEnabled(!recording && !replaying);
+    replayButton->setText(replaying ? "⏹ Stop" : "▶ Replay");
+    headlessButton->setEnabled(!replaying);
+}
+
+void SessionControls::showMessage(const QString &message)
+{
+    resultList->addItem(message);
+    resultList->scrollToBottom();
+}
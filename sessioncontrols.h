@@ -0,0 +1,62 @@
+#ifndef SESSIONCONTROLS_H
+#define SESSIONCONTROLS_H
+
+#include <QWidget>
+#include <QGroupBox>
+#include <QPushButton>
+#include <QListWidget>
+#include <QTimer>
+#include "operationlog.h"
+
+// Implemented by every lab so a recorded session can be replayed through its UI
+class ReplayTarget
+{
+public:
+    virtual ~ReplayTarget() = default;
+
+    virtual LoggedOperation::Lab replayLab() const = 0;
+    // True while an animation is still running - replay waits for it
+    virtual bool isReplayBusy() const = 0;
+    // Fill the lab's inputs from the operation and trigger the matching slot
+    virtual bool replayOperation(const LoggedOperation &operation) = 0;
+};
+
+// Record / save / replay panel shown in each lab's right panel
+class SessionControls : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    explicit SessionControls(ReplayTarget *target, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void onRecordClicked();
+    void onSaveClicked();
+    void onReplayAnimatedClicked();
+    void onReplayHeadlessClicked();
+    void onReplayTick();
+
+private:
+    bool loadLog(OperationLog &log);
+    void updateButtons();
+    void showMessage(const QString &message);
+
+    ReplayTarget *target;
+    QPushButton *recordButton;
+    QPushButton *saveButton;
+    QPushButton *replayButton;
+    QPushButton *headlessButton;
+    QListWidget *resultList;
+
+    // Animated replay state
+    QTimer *replayTimer;
+    QVector<LoggedOperation> pending;
+    int pendingIndex = 0;
+
+    static constexpr int REPLAY_INTERVAL_MS = 400;  // At 1x; follows AnimationTimeline::speed()
+};
+
+#endif // SESSIONCONTROLS_H
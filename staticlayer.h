@@ -0,0 +1,53 @@
+#ifndef STATICLAYER_H
+#define STATICLAYER_H
+
+#include <QPainter>
+#include <QPixmap>
+#include <QWidget>
+
+// Cached picture of the parts of a canvas that stay put between animation
+// frames: background, edges, nodes without highlights. paintEvent() blits
+// it and draws only the highlighted nodes on top. The picture is redrawn
+// after invalidate() - on a change of shape, colour or view - or when the
+// widget's size or pixel ratio changes. invalidate(rect) redraws only that
+// part: paint() then runs clipped to it and may skip what lies outside
+// painter.clipBoundingRect().
+class StaticLayer
+{
+public:
+    void invalidate() { valid = false; }
+    void invalidate(const QRect &rect) { dirty = dirty.united(rect); }
+
+    // paint(QPainter &) draws the layer in widget coordinates when stale
+    template <typename Paint>
+    void draw(QPainter &painter, const QWidget *widget, Paint paint)
+    {
+        const qreal ratio = widget->devicePixelRatioF();
+        const QSize pixels = widget->size() * ratio;
+        if (!valid || pixmap.size() != pixels || pixmap.devicePixelRatio() != ratio) {
+            if (pixmap.size() != pixels) pixmap = QPixmap(pixels);
+            pixmap.setDevicePixelRatio(ratio);
+            pixmap.fill(Qt::transparent);
+            QPainter layer(&pixmap);
+            paint(layer);
+            valid = true;
+            dirty = QRect();
+        } else if (!dirty.isEmpty()) {
+            QPainter layer(&pixmap);
+            layer.setClipRect(dirty);
+            layer.setCompositionMode(QPainter::CompositionMode_Source);
+            layer.fillRect(dirty, Qt::transparent);
+            layer.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            paint(layer);
+            dirty = QRect();
+        }
+        painter.drawPixmap(0, 0, pixmap);
+    }
+
+private:
+    QPixmap pixmap;
+    bool valid = false;
+    QRect dirty;  // Part of a valid pixmap still to redraw
+};
+
+#endif // STATICLAYER_H
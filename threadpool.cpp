@@ -0,0 +1,86 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    // The caller always participates, so one worker fewer than the core count
+    const unsigned count = std::max(1u, threadCount) - 1;
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool instance;
+    return instance;
+}
+
+bool ThreadPool::runPendingTask()
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (queue.empty()) return false;
+        task = std::move(queue.front());
+        queue.pop_front();
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::wait(std::future<void> &future)
+{
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (!runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+    future.get();
+}
+
+void ThreadPool::parallelFor(unsigned partitions, const std::function<void(unsigned)> &body)
+{
+    if (partitions == 0) return;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(partitions - 1);
+    for (unsigned p = 1; p < partitions; ++p) {
+        pending.push_back(submit([&body, p]() { body(p); }));
+    }
+
+    body(0);
+    for (std::future<void> &future : pending) {
+        wait(future);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (stopping && queue.empty()) return;
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool shared by the data-structure engines.
+// Callers that wait on a task help drain the queue, so tasks may fork and
+// join sub-tasks without starving the workers.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    // Process-wide pool sized to the machine
+    static ThreadPool& instance();
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+
+    template<typename F>
+    std::future<void> submit(F &&task)
+    {
+        auto packaged = std::make_shared<std::packaged_task<void()>>(std::forward<F>(task));
+        std::future<void> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.emplace_back([packaged]() { (*packaged)(); });
+        }
+        queueReady.notify_one();
+        return result;
+    }
+
+    // Block until the future is ready, running queued tasks meanwhile
+    void wait(std::future<void> &future);
+
+    // Split [0, partitions) across the pool; body(partition) runs once per index.
+    // The calling thread runs partition 0 itself.
+    void parallelFor(unsigned partitions, const std::function<void(unsigned)> &body);
+
+private:
+    bool runPendingTask();
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool stopping = false;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,117 @@
+#ifndef TRAVERSALPOLICY_H
+#define TRAVERSALPOLICY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+// How a binary tree marks a missing child
+struct NullChild {
+    template <typename Node>
+    bool isAbsent(const Node *node) const { return node == nullptr; }
+};
+
+template <typename Node>
+struct SentinelChild {
+    const Node *nil;
+    bool isAbsent(const Node *node) const { return node == nil; }
+};
+
+// Policies live next to their structures (BSTPolicy in bstengine.h,
+// RBPolicy in rbtreeengine.h, GraphPolicy in graphengine.h), so this
+// core depends on none of them.
+
+// Binary tree nodes, children read through the Left and Right members.
+// A tree reaches every node once, so visited tracking compiles away.
+template <typename NodeT, typename Absent = NullChild,
+          NodeT *NodeT::*Left = &NodeT::left, NodeT *NodeT::*Right = &NodeT::right>
+struct BinaryTreePolicy {
+    using Node = NodeT*;
+
+    Absent absent;
+
+    bool isAbsent(Node node) const { return absent.isAbsent(node); }
+    static int key(Node node) { return node->value; }
+
+    template <typename Action>
+    void forEachChild(Node node, Action &&action) const
+    {
+        if (!absent.isAbsent(node->*Left)) action(node->*Left);
+        if (!absent.isAbsent(node->*Right)) action(node->*Right);
+    }
+
+    bool isVisited(Node) const { return false; }
+    bool markVisited(Node) { return true; }
+};
+
+// Breadth- and depth-first search written once for every policy.
+// The policy and the actions are template parameters, so each walk is
+// compiled for its node type with the accessors and the visit inlined -
+// no virtual call per node. visit(node) runs as a node is reached;
+// discover(node) as it joins the queue or stack; revisit(node) as depth-
+// first search pops a graph vertex that was visited since it was pushed.
+class PolicyTraversal
+{
+public:
+    struct NoAction {
+        template <typename Node>
+        void operator()(Node) const {}
+    };
+
+    template <typename Policy, typename Visit, typename Discover = NoAction>
+    static void breadthFirst(Policy &policy, typename Policy::Node start, Visit &&visit,
+                             Discover &&discover = Discover())
+    {
+        using Node = typename Policy::Node;
+        if (policy.isAbsent(start)) return;
+
+        policy.markVisited(start);
+        std::deque<Node> queue{start};
+        while (!queue.empty()) {
+            const Node node = queue.front();
+            queue.pop_front();
+            visit(node);
+            policy.forEachChild(node, [&](Node child) {
+                if (policy.markVisited(child)) {
+                    discover(child);
+                    queue.push_back(child);
+                }
+            });
+        }
+    }
+
+    // Preorder on trees. A graph vertex counts as visited when popped, so
+    // it may sit on the stack more than once.
+    template <typename Policy, typename Visit, typename Discover = NoAction, typename Revisit = NoAction>
+    static void depthFirst(Policy &policy, typename Policy::Node start, Visit &&visit,
+                           Discover &&discover = Discover(), Revisit &&revisit = Revisit())
+    {
+        using Node = typename Policy::Node;
+        if (policy.isAbsent(start)) return;
+
+        std::vector<Node> stack{start};
+        while (!stack.empty()) {
+            const Node node = stack.back();
+            stack.pop_back();
+            if (!policy.markVisited(node)) {
+                revisit(node);
+                continue;
+            }
+            visit(node);
+
+            const std::size_t firstChild = stack.size();
+            policy.forEachChild(node, [&](Node child) {
+                if (!policy.isVisited(child)) {
+                    discover(child);
+                    stack.push_back(child);
+                }
+            });
+            // First child on top, so it is visited next
+            std::reverse(stack.begin() + static_cast<std::ptrdiff_t>(firstChild), stack.end());
+        }
+    }
+};
+
+#endif // TRAVERSALPOLICY_H
@@ -2,15 +2,21 @@
 
 TreeInsertion::TreeInsertion(QWidget *parent)
     : QWidget(parent)
-    , root(nullptr)
-    , currentTraversalStep(0)
     , isAnimating(false)
     , currentOperation("")
     , traversalType(TraversalType::None)
     , traversalIndex(0)
 {
+    // Operations queue their steps here; every frame refreshes the trace and canvas
+    timeline = new AnimationTimeline(this);
+    connect(timeline, &AnimationTimeline::frameChanged, this, [this]() {
+        updateStepTrace();
+        update();
+    });
+
     setupUI();
     setMinimumSize(1200, 800);
+    engine.addObserver(this);
 
     animationTimer = new QTimer(this);
     connect(animationTimer, &QTimer::timeout, this, [this]() {
@@ -27,8 +33,8 @@ TreeInsertion::~TreeInsertion()
     if (traversalAnimTimer) {
         traversalAnimTimer->stop();
     }
-    
-    clearTree(root);
+
+    engine.removeObserver(this);
 }
 
 void TreeInsertion::setupUI()
@@ -41,6 +47,8 @@ void TreeInsertion::setupUI()
     setupVisualizationArea();
     setupRightPanel();
     setupTraversalControls();
+    setupTimelineControls();
+    setupSessionControls();
     
     // Set splitter proportions (65% visualization, 35% controls+trace)
     mainSplitter->addWidget(leftPanel);
@@ -116,12 +124,38 @@ void TreeInsertion::setupVisualizationArea()
     randomizeButton->setFixedSize(80, 40);
     StyleManager::instance().applyOperationButtonStyle(randomizeButton, "#28a745");
 
+    // Balancing strategy behind the same insert/search/delete buttons
+    balanceBox = new QComboBox();
+    balanceBox->addItem("Plain BST", "none");
+    balanceBox->addItem("AVL", "avl");
+    balanceBox->addItem("Treap", "treap");
+    balanceBox->setFixedHeight(40);
+    balanceBox->setToolTip("How the tree keeps its height down");
+    balanceBox->setStyleSheet(R"(
+        QComboBox {
+            border: 2px solid #d0c5e8;
+            border-radius: 6px;
+            padding: 6px 10px;
+            background: white;
+            color: #2d1b69;
+            min-width: 90px;
+        }
+        QComboBox:focus { border-color: #7b4fff; }
+    )");
+
+    rebalanceButton = new QPushButton("Rebalance");
+    rebalanceButton->setFixedSize(90, 40);
+    rebalanceButton->setToolTip("Fold a plain BST into a complete tree in place (Day-Stout-Warren)");
+    StyleManager::instance().applyOperationButtonStyle(rebalanceButton, "#e67e22");
+
     controlLayout->addWidget(inputField);
     controlLayout->addWidget(insertButton);
     controlLayout->addWidget(searchButton);
     controlLayout->addWidget(deleteButton);
     controlLayout->addWidget(clearButton);
     controlLayout->addWidget(randomizeButton);
+    controlLayout->addWidget(balanceBox);
+    controlLayout->addWidget(rebalanceButton);
     controlLayout->addStretch();
 
     leftLayout->addLayout(controlLayout);
@@ -144,6 +178,8 @@ void TreeInsertion::setupVisualizationArea()
     connect(deleteButton, &QPushButton::clicked, this, &TreeInsertion::onDeleteClicked);
     connect(clearButton, &QPushButton::clicked, this, &TreeInsertion::onClearClicked);
     connect(randomizeButton, &QPushButton::clicked, this, &TreeInsertion::onRandomizeClicked);
+    connect(balanceBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TreeInsertion::onBalanceModeChanged);
+    connect(rebalanceButton, &QPushButton::clicked, this, &TreeInsertion::onRebalanceClicked);
     connect(inputField, &QLineEdit::returnPressed, this, &TreeInsertion::onInsertClicked);
 }
 
@@ -304,6 +340,77 @@ void TreeInsertion::setupTraversalControls()
     connect(dfsButton, &QPushButton::clicked, this, &TreeInsertion::onStartDFS);
 }
 
+void TreeInsertion::setupTimelineControls()
+{
+    timelineControls = new TimelineControls(timeline);
+    rightLayout->addWidget(timelineControls, 0);
+}
+
+void TreeInsertion::setupSessionControls()
+{
+    sessionControls = new SessionControls(this);
+    rightLayout->addWidget(sessionControls, 0);
+}
+
+bool TreeInsertion::isReplayBusy() const
+{
+    return isAnimating || traversalAnimTimer->isActive();
+}
+
+void TreeInsertion::onEngineEvent(const EngineEvent &event)
+{
+    // Inserts, deletes and clears all change the shape, and the shape drives
+    // the layout: spacing follows the tree's height, so any of them can move
+    // every node. Highlight-only repaints reuse the cached positions and
+    // the cached static layer.
+    staticLayer.invalidate();
+    if (event.type == EngineEvent::NodeRemoved) {
+        visuals.remove(event.first);
+        visuals.invalidateLayout();
+    } else if (event.type == EngineEvent::Cleared) {
+        visuals.clear();
+    } else if (event.type == EngineEvent::NodeInserted || event.type == EngineEvent::BulkLoaded) {
+        visuals.invalidateLayout();
+    } else if (event.type == EngineEvent::Rotated) {
+        // AVL and treap rebalancing, narrated one rotation at a time
+        visuals.invalidateLayout();
+        risenValue = event.second;
+        if (!narrateRotations) return;
+        addStepToHistory(QString("🔄 %1 rotation at %2: %3 moves up")
+                             .arg(event.second > event.first ? "Left" : "Right")
+                             .arg(event.first)
+                             .arg(event.second));
+    }
+    update();
+}
+
+bool TreeInsertion::replayOperation(const LoggedOperation &operation)
+{
+    const QString &op = operation.op;
+    if (op == "clear") {
+        onClearClicked();
+    } else if (op == "bfs") {
+        onStartBFS();
+    } else if (op == "dfs") {
+        onStartDFS();
+    } else if (op == "rebalance") {
+        onRebalanceClicked();
+    } else if (op == "balance" && !operation.args.isEmpty()) {
+        const int index = balanceBox->findData(operation.args.first());
+        if (index < 0) return false;
+        balanceBox->setCurrentIndex(index);
+    } else if (!operation.args.isEmpty() && (op == "insert" || op == "search" || op == "delete")) {
+        // Go through the input field exactly like a click would
+        inputField->setText(operation.args.first());
+        if (op == "insert") onInsertClicked();
+        else if (op == "search") onSearchClicked();
+        else onDeleteClicked();
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void TreeInsertion::onBackClicked()
 {
     emit backToOperations();
@@ -331,6 +438,7 @@ void TreeInsertion::onInsertClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::BST, "insert", {QString::number(value)});
     currentOperation = "Insert";
     addStepToHistory("➕ INSERT OPERATION");
     addStepToHistory(QString("🔢 Adding value: %1").arg(value));
@@ -362,6 +470,7 @@ void TreeInsertion::onSearchClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::BST, "search", {QString::number(value)});
     currentOperation = "Search";
     addStepToHistory("🔍 SEARCH OPERATION");
     showAlgorithm("Search");
@@ -392,6 +501,7 @@ void TreeInsertion::onDeleteClicked()
         return;
     }
 
+    OperationRecorder::instance().record(LoggedOperation::BST, "delete", {QString::number(value)});
     currentOperation = "Delete";
     addStepToHistory("🗑️ DELETE OPERATION");
     showAlgorithm("Delete");
@@ -408,13 +518,15 @@ void TreeInsertion::onClearClicked()
         return;
     }
 
-    clearTree(root);
-    root = nullptr;
+    OperationRecorder::instance().record(LoggedOperation::BST, "clear");
+    engine.clear();
     stepHistory.clear();
+    stepsList->clear();
     
     // Clear traversal results
     traversalResultList->clear();
-    traversalOrder.clear();
+    traversalCursor = {};
+    traversalCurrent = nullptr;
     traversalType = TraversalType::None;
     traversalIndex = 0;
     
@@ -437,6 +549,8 @@ void TreeInsertion::onRandomizeClicked()
     // Generate a single random value between 1 and 100
     int randomValue = QRandomGenerator::global()->bounded(1, 101);
     
+    OperationRecorder::instance().record(LoggedOperation::BST, "insert", {QString::number(randomValue)});
+
     // Display the value being inserted in the status label and step history
     statusLabel->setText(QString("Inserting value: %1...").arg(randomValue));
     currentOperation = "Insert";
@@ -457,490 +571,350 @@ void TreeInsertion::onRandomizeClicked()
     inputField->setFocus();
 }
 
-void TreeInsertion::insertNode(int value)
+void TreeInsertion::onBalanceModeChanged(int index)
 {
-    TreeNode *newNode = new TreeNode(value);
-    newNode->isNewNode = true;
+    const QString name = balanceBox->itemData(index).toString();
+    const BalanceMode mode = name == "avl"   ? BalanceMode::AVL
+                           : name == "treap" ? BalanceMode::Treap
+                                             : BalanceMode::None;
+    if (mode == engine.balanceMode()) return;
+
+    OperationRecorder::instance().record(LoggedOperation::BST, "balance", {name});
+    const int before = engine.height();
+    engine.setBalanceMode(mode);
+
+    addStepToHistory(QString("⚖️ BALANCING: %1").arg(balanceBox->itemText(index)));
+    if (mode == BalanceMode::None) {
+        addStepToHistory("📍 Inserts and deletes no longer rebalance; the shape stays as it is");
+        statusLabel->setText("Plain BST: no rebalancing");
+    } else {
+        showAlgorithm(balanceBox->itemText(index));
+        if (engine.size() > 0) {
+            addStepToHistory(QString("🔄 Relinked %1 nodes in place: height %2 → %3")
+                                 .arg(engine.size()).arg(before).arg(engine.height()));
+        }
+        statusLabel->setText(QString("%1: every insert and delete rebalances").arg(balanceBox->itemText(index)));
+    }
+    addOperationSeparator();
+    updateStepTrace();
+    update();
+}
 
-    if (!root) {
-        root = newNode;
-        statusLabel->setText(QString("Inserted %1 as root node").arg(value));
-        addStepToHistory(QString("✅ Inserted %1 as root node").arg(value));
+void TreeInsertion::onRebalanceClicked()
+{
+    if (isAnimating) {
+        QMessageBox::warning(this, "Animation in Progress",
+                             "Please wait for the current animation to complete.");
+        return;
+    }
+    if (!engine.root()) {
+        statusLabel->setText("Tree is empty - nothing to rebalance!");
+        addStepToHistory("❌ Tree is empty: Please insert nodes first");
+        updateStepTrace();
+        return;
+    }
+    if (engine.balanceMode() != BalanceMode::None) {
+        statusLabel->setText(QString("%1 keeps the tree balanced already").arg(balanceBox->currentText()));
+        addStepToHistory(QString("📍 %1 rebalances on every insert and delete - nothing to do").arg(balanceBox->currentText()));
+        updateStepTrace();
         return;
     }
 
-    TreeNode *current = root;
-    TreeNode *parent = nullptr;
+    OperationRecorder::instance().record(LoggedOperation::BST, "rebalance");
+    showAlgorithm("Rebalance");
+    setAnimating(true);
 
-    while (current) {
-        parent = current;
-        if (value < current->value) {
-            current = current->left;
-        } else if (value > current->value) {
-            current = current->right;
-        } else {
-            delete newNode;
-            statusLabel->setText(QString("Value %1 already exists in tree!").arg(value));
-            addStepToHistory(QString("❌ Value %1 already exists in tree!").arg(value));
-            return;
-        }
+    const int before = engine.height();
+    addStepToHistory(QString("⚖️ REBALANCING %1 nodes in place (Day-Stout-Warren)").arg(engine.size()));
+    addStepToHistory(QString("📏 Height before: %1").arg(before));
+    addStepToHistory("1️⃣ Right rotations flatten the tree into a vine (a sorted right spine)");
+    addStepToHistory("2️⃣ Left rotations on every other spine node, in halving passes, fold it into a complete tree");
+
+    auto report = [this, before]() {
+        const int after = engine.height();
+        statusLabel->setText(QString("Rebalanced: height %1 → %2").arg(before).arg(after));
+        addStepToHistory(QString("✅ Rebalanced: height %1 → %2").arg(before).arg(after));
+        addOperationSeparator();
+        visuals.resetHighlights();
+        setAnimating(false);
+        updateStepTrace();
+        update();
+    };
+
+    if (engine.size() > REBALANCE_ANIMATION_LIMIT) {
+        // Up to 2n rotations are too many to watch - run them at once
+        narrateRotations = false;
+        engine.rebalanceInPlace();
+        narrateRotations = true;
+        risenValue.reset();
+        addStepToHistory("⚡ Large tree: rotations applied without animation");
+        report();
+        return;
+    }
+
+    // Same frames as an AVL or treap rebalance: one rotation each
+    engine.rebalanceInPlace(false);
+    queueRebalance(report);
+}
+
+void TreeInsertion::insertNode(int value)
+{
+    // The new node hangs from the last node its search compares against
+    const std::vector<TreeNode*> path = engine.searchPath(value);
+    TreeNode *newNode = nullptr;
+
+    // Rebalancing is left pending so queueRebalance() can show each rotation
+    if (!engine.insert(value, &newNode, false)) {
+        statusLabel->setText(QString("Value %1 already exists in tree!").arg(value));
+        addStepToHistory(QString("❌ Value %1 already exists in tree!").arg(value));
+        return;
     }
+    visuals[value].isNewNode = true;
 
-    if (value < parent->value) {
-        parent->left = newNode;
+    if (path.empty()) {
+        statusLabel->setText(QString("Inserted %1 as root node").arg(value));
+        addStepToHistory(QString("✅ Inserted %1 as root node").arg(value));
+        return;
+    }
+
+    TreeNode *parent = path.back();
+    if (parent->left == newNode) {
         statusLabel->setText(QString("Inserted %1 as left child of %2").arg(value).arg(parent->value));
         addStepToHistory(QString("✅ Inserted %1 as left child of %2").arg(value).arg(parent->value));
     } else {
-        parent->right = newNode;
         statusLabel->setText(QString("Inserted %1 as right child of %2").arg(value).arg(parent->value));
         addStepToHistory(QString("✅ Inserted %1 as right child of %2").arg(value).arg(parent->value));
     }
 }
 
-TreeNode* TreeInsertion::searchNode(int value)
+void TreeInsertion::setAnimating(bool animating)
 {
-    TreeNode *current = root;
-    
-    while (current) {
-        if (value == current->value) {
-            return current;
-        } else if (value < current->value) {
-            current = current->left;
-        } else {
-            current = current->right;
-        }
-    }
-    
-    return nullptr;
+    isAnimating = animating;
+    insertButton->setEnabled(!animating);
+    searchButton->setEnabled(!animating);
+    deleteButton->setEnabled(!animating);
+    clearButton->setEnabled(!animating);
+    balanceBox->setEnabled(!animating);
+    rebalanceButton->setEnabled(!animating);
 }
 
-TreeNode* TreeInsertion::deleteNode(TreeNode* node, int value)
+void TreeInsertion::queueRebalance(std::function<void()> done)
 {
-    if (!node) {
-        return nullptr;
+    if (!engine.isRebalancePending()) {
+        done();
+        return;
     }
 
-    if (value < node->value) {
-        node->left = deleteNode(node->left, value);
-    } else if (value > node->value) {
-        node->right = deleteNode(node->right, value);
-    } else {
-        // Node to be deleted found
-        if (!node->left) {
-            TreeNode* temp = node->right;
-            delete node;
-            return temp;
-        } else if (!node->right) {
-            TreeNode* temp = node->left;
-            delete node;
-            return temp;
+    // One frame per rotation; the count is only known as they happen, so
+    // each frame queues the next one
+    AnimationFrame rotation;
+    rotation.durationMs = 800;
+    rotation.changesEngine = true;
+    rotation.reach = [this, done]() {
+        risenValue.reset();
+        engine.rebalanceStep();
+        queueRebalance(done);
+    };
+    rotation.show = [this]() {
+        visuals.resetHighlights();
+        if (risenValue) {
+            visuals[*risenValue].isHighlighted = true;
+            statusLabel->setText(QString("Rebalancing: %1 moves up").arg(*risenValue));
+        } else {
+            statusLabel->setText("Rebalancing: node unlinked");
         }
-
-        // Node with two children
-        TreeNode* temp = findMin(node->right);
-        node->value = temp->value;
-        node->right = deleteNode(node->right, temp->value);
-    }
-    
-    return node;
+    };
+    timeline->extend({std::move(rotation)});
 }
 
-TreeNode* TreeInsertion::findMin(TreeNode* node)
+std::vector<AnimationFrame> TreeInsertion::comparisonFrames(const std::vector<TreeNode*> &path, int value,
+                                                            const QString &operation)
 {
-    while (node && node->left) {
-        node = node->left;
+    QString statusLead = "Comparing";
+    QString icon = "📊";
+    QString match = "🎯 Match found!";
+    QString verb = "go";
+    if (operation == "Search") {
+        statusLead = "Searching: comparing";
+        icon = "🔍";
+        verb = "search";
+    } else if (operation == "Delete") {
+        statusLead = "Deleting: comparing";
+        icon = "🗑️";
+        match = "🎯 Target found!";
+        verb = "search";
+    }
+
+    std::vector<AnimationFrame> frames;
+    frames.reserve(path.size() + 2);
+    for (std::size_t step = 0; step < path.size(); ++step) {
+        // Keys, not nodes: a frame can be shown again after the tree changed
+        const int key = path[step]->value;
+        const QString against = step == 0 ? QString("root %1").arg(key) : QString::number(key);
+
+        AnimationFrame frame;
+        frame.durationMs = 800;
+        frame.reach = [this, value, key, against, icon, match, verb]() {
+            addStepToHistory(QString("%1 Comparing %2 with %3").arg(icon).arg(value).arg(against));
+            if (value == key) {
+                addStepToHistory(QString("%1 %2 == %3").arg(match).arg(value).arg(key));
+            } else if (value < key) {
+                addStepToHistory(QString("⬅️ %1 < %2, %3 left").arg(value).arg(key).arg(verb));
+            } else {
+                addStepToHistory(QString("➡️ %1 > %2, %3 right").arg(value).arg(key).arg(verb));
+            }
+        };
+        frame.show = [this, value, key, against, statusLead]() {
+            visuals.resetHighlights();
+            visuals[key].isHighlighted = true;
+            statusLabel->setText(QString("%1 %2 with %3").arg(statusLead).arg(value).arg(against));
+        };
+        frames.push_back(std::move(frame));
     }
-    return node;
+    return frames;
 }
 
 void TreeInsertion::animateInsertion(int value)
 {
-    isAnimating = true;
-    insertButton->setEnabled(false);
-    searchButton->setEnabled(false);
-    deleteButton->setEnabled(false);
-    clearButton->setEnabled(false);
-
+    setAnimating(true);
     addStepToHistory(QString("➕ Starting insertion of value: %1").arg(value));
 
-    // Build traversal path
-    traversalPath.clear();
-
-    if (!root) {
+    if (!engine.root()) {
         insertNode(value);
         addOperationSeparator();
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        clearButton->setEnabled(true);
+        setAnimating(false);
         updateStepTrace();
         update();
         return;
     }
 
-    TreeNode *current = root;
-    while (current) {
-        traversalPath.append(current);
-        if (value < current->value) {
-            if (!current->left) {
-                break;
-            }
-            current = current->left;
-        } else if (value > current->value) {
-            if (!current->right) {
-                break;
-            }
-            current = current->right;
-        } else {
-            // Duplicate value
-            QMessageBox::warning(this, "Duplicate Value",
-                                 QString("Value %1 already exists in tree!").arg(value));
-            addStepToHistory(QString("❌ Value %1 already exists in tree!").arg(value));
-            addOperationSeparator();
-            isAnimating = false;
-            insertButton->setEnabled(true);
-            searchButton->setEnabled(true);
-            deleteButton->setEnabled(true);
-            clearButton->setEnabled(true);
-            updateStepTrace();
-            return;
-        }
+    const std::vector<TreeNode*> path = engine.searchPath(value);
+    if (path.back()->value == value) {
+        // Duplicate value
+        QMessageBox::warning(this, "Duplicate Value",
+                             QString("Value %1 already exists in tree!").arg(value));
+        addStepToHistory(QString("❌ Value %1 already exists in tree!").arg(value));
+        addOperationSeparator();
+        setAnimating(false);
+        updateStepTrace();
+        return;
     }
 
-    currentTraversalStep = 0;
-
-    QTimer::singleShot(0, this, [this, value]() {
-        animateTraversal(root, value, 0);
-    });
+    // One frame per comparison on the way down, then the insert itself
+    std::vector<AnimationFrame> frames = comparisonFrames(path, value, "Insert");
+    AnimationFrame insert;
+    insert.changesEngine = true;
+    insert.reach = [this, value]() {
+        insertNode(value);
+        queueRebalance([this]() {
+            addOperationSeparator();
+            visuals.resetHighlights();
+            setAnimating(false);
+        });
+    };
+    frames.push_back(std::move(insert));
+    timeline->play(std::move(frames));
 }
 
 void TreeInsertion::animateSearch(int value)
 {
-    isAnimating = true;
-    insertButton->setEnabled(false);
-    searchButton->setEnabled(false);
-    deleteButton->setEnabled(false);
-    clearButton->setEnabled(false);
-
+    setAnimating(true);
     addStepToHistory(QString("🔍 Starting search for value: %1").arg(value));
 
-    if (!root) {
+    if (!engine.root()) {
         statusLabel->setText("Tree is empty - value not found!");
         addStepToHistory("❌ Tree is empty - value not found!");
         addOperationSeparator();
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        clearButton->setEnabled(true);
+        setAnimating(false);
         updateStepTrace();
         return;
     }
 
-    // Build traversal path for search
-    traversalPath.clear();
-    TreeNode *current = root;
-    bool found = false;
-
-    while (current) {
-        traversalPath.append(current);
-        if (value == current->value) {
-            found = true;
-            break;
-        } else if (value < current->value) {
-            current = current->left;
+    std::vector<AnimationFrame> frames = comparisonFrames(engine.searchPath(value), value, "Search");
+
+    // The result stays highlighted for a while, but the lab is free again
+    AnimationFrame result;
+    result.durationMs = 2000;
+    result.reach = [this, value]() {
+        if (engine.search(value)) {
+            addStepToHistory(QString("✅ Found value %1 in the tree!").arg(value));
         } else {
-            current = current->right;
+            addStepToHistory(QString("❌ Value %1 not found in tree!").arg(value));
         }
-    }
-
-    currentTraversalStep = 0;
+        addOperationSeparator();
+        setAnimating(false);
+    };
+    result.show = [this, value]() {
+        visuals.resetHighlights();
+        if (engine.search(value)) {
+            visuals[value].isSearchHighlighted = true;
+            statusLabel->setText(QString("Found value %1 in the tree!").arg(value));
+        } else {
+            statusLabel->setText(QString("Value %1 not found in tree!").arg(value));
+        }
+    };
+    frames.push_back(std::move(result));
 
-    QTimer::singleShot(0, this, [this, value, found]() {
-        animateSearchTraversal(root, value, 0);
-    });
+    AnimationFrame fade;
+    fade.show = [this]() { visuals.resetHighlights(); };
+    frames.push_back(std::move(fade));
+    timeline->play(std::move(frames));
 }
 
 void TreeInsertion::animateDelete(int value)
 {
-    isAnimating = true;
-    insertButton->setEnabled(false);
-    searchButton->setEnabled(false);
-    deleteButton->setEnabled(false);
-    clearButton->setEnabled(false);
-
+    setAnimating(true);
     addStepToHistory(QString("🗑️ Starting deletion of value: %1").arg(value));
 
-    if (!root) {
+    if (!engine.root()) {
         statusLabel->setText("Tree is empty - nothing to delete!");
         addStepToHistory("❌ Tree is empty - nothing to delete!");
         addOperationSeparator();
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        clearButton->setEnabled(true);
+        setAnimating(false);
         updateStepTrace();
         return;
     }
 
     // First, search for the node to see if it exists
-    TreeNode *nodeToDelete = searchNode(value);
-    if (!nodeToDelete) {
+    if (!engine.search(value)) {
         statusLabel->setText(QString("Value %1 not found in tree!").arg(value));
         addStepToHistory(QString("❌ Value %1 not found in tree!").arg(value));
         addOperationSeparator();
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        clearButton->setEnabled(true);
-        updateStepTrace();
-        return;
-    }
-
-    // Build traversal path to the node
-    traversalPath.clear();
-    TreeNode *current = root;
-
-    while (current) {
-        traversalPath.append(current);
-        if (value == current->value) {
-            break;
-        } else if (value < current->value) {
-            current = current->left;
-        } else {
-            current = current->right;
-        }
-    }
-
-    currentTraversalStep = 0;
-
-    QTimer::singleShot(0, this, [this, value]() {
-        animateDeleteTraversal(root, value, 0);
-    });
-}
-
-void TreeInsertion::animateTraversal(TreeNode *node, int value, int step)
-{
-    if (step >= traversalPath.size()) {
-        // Animation complete, insert the node
-        insertNode(value);
-        addOperationSeparator();
-        resetHighlights(root);
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        clearButton->setEnabled(true);
+        setAnimating(false);
         updateStepTrace();
-        update();
         return;
     }
 
-    resetHighlights(root);
-    traversalPath[step]->isHighlighted = true;
-
-    if (step == 0) {
-        statusLabel->setText(QString("Comparing %1 with root %2").arg(value).arg(traversalPath[step]->value));
-        addStepToHistory(QString("📊 Comparing %1 with root %2").arg(value).arg(traversalPath[step]->value));
-    } else {
-        statusLabel->setText(QString("Comparing %1 with %2").arg(value).arg(traversalPath[step]->value));
-        addStepToHistory(QString("📊 Comparing %1 with %2").arg(value).arg(traversalPath[step]->value));
-    }
-
-    if (value < traversalPath[step]->value) {
-        addStepToHistory(QString("⬅️ %1 < %2, go left").arg(value).arg(traversalPath[step]->value));
-    } else if (value > traversalPath[step]->value) {
-        addStepToHistory(QString("➡️ %1 > %2, go right").arg(value).arg(traversalPath[step]->value));
-    }
-
-    updateStepTrace();
-    update();
-
-    QTimer::singleShot(800, this, [this, node, value, step]() {
-        animateTraversal(node, value, step + 1);
-    });
-}
-
-void TreeInsertion::animateSearchTraversal(TreeNode *node, int value, int step)
-{
-    if (step >= traversalPath.size()) {
-        // Animation complete
-        resetHighlights(root);
-        
-        TreeNode *found = searchNode(value);
-        if (found) {
-            found->isSearchHighlighted = true;
-            statusLabel->setText(QString("Found value %1 in the tree!").arg(value));
-            addStepToHistory(QString("✅ Found value %1 in the tree!").arg(value));
-        } else {
-            statusLabel->setText(QString("Value %1 not found in tree!").arg(value));
-            addStepToHistory(QString("❌ Value %1 not found in tree!").arg(value));
-        }
-        
-        addOperationSeparator();
-        isAnimating = false;
-        insertButton->setEnabled(true);
-        searchButton->setEnabled(true);
-        deleteButton->setEnabled(true);
-        clearButton->setEnabled(true);
-        updateStepTrace();
-        update();
-        
-        // Clear search highlight after a delay
-        QTimer::singleShot(2000, this, [this]() {
-            resetHighlights(root);
-            update();
+    std::vector<AnimationFrame> frames = comparisonFrames(engine.searchPath(value), value, "Delete");
+
+    // Hold the doomed node on screen a moment, then delete it
+    AnimationFrame target;
+    target.durationMs = 1000;
+    target.reach = [this, value]() {
+        addStepToHistory(QString("🎯 Found node %1 to delete").arg(value));
+    };
+    target.show = [this, value]() {
+        visuals.resetHighlights();
+        visuals[value].isDeleteHighlighted = true;
+    };
+    frames.push_back(std::move(target));
+
+    AnimationFrame remove;
+    remove.changesEngine = true;
+    remove.reach = [this, value]() {
+        engine.remove(value, false);
+        queueRebalance([this, value]() {
+            addStepToHistory(QString("✅ Deleted value %1 from tree").arg(value));
+            addOperationSeparator();
+            visuals.resetHighlights();
+            setAnimating(false);
         });
-        return;
-    }
-
-    resetHighlights(root);
-    traversalPath[step]->isHighlighted = true;
-
-    if (step == 0) {
-        statusLabel->setText(QString("Searching: comparing %1 with root %2").arg(value).arg(traversalPath[step]->value));
-        addStepToHistory(QString("🔍 Comparing %1 with root %2").arg(value).arg(traversalPath[step]->value));
-    } else {
-        statusLabel->setText(QString("Searching: comparing %1 with %2").arg(value).arg(traversalPath[step]->value));
-        addStepToHistory(QString("🔍 Comparing %1 with %2").arg(value).arg(traversalPath[step]->value));
-    }
-
-    if (value == traversalPath[step]->value) {
-        addStepToHistory(QString("🎯 Match found! %1 == %2").arg(value).arg(traversalPath[step]->value));
-    } else if (value < traversalPath[step]->value) {
-        addStepToHistory(QString("⬅️ %1 < %2, search left").arg(value).arg(traversalPath[step]->value));
-    } else {
-        addStepToHistory(QString("➡️ %1 > %2, search right").arg(value).arg(traversalPath[step]->value));
-    }
-
-    updateStepTrace();
-    update();
-
-    QTimer::singleShot(800, this, [this, node, value, step]() {
-        animateSearchTraversal(node, value, step + 1);
-    });
-}
-
-void TreeInsertion::animateDeleteTraversal(TreeNode *node, int value, int step)
-{
-    if (step >= traversalPath.size()) {
-        // Animation complete, now delete the node
-        resetHighlights(root);
-        
-        // Highlight the node to be deleted
-        TreeNode *nodeToDelete = searchNode(value);
-        if (nodeToDelete) {
-            nodeToDelete->isDeleteHighlighted = true;
-            addStepToHistory(QString("🎯 Found node %1 to delete").arg(value));
-            updateStepTrace();
-            update();
-            
-            // Wait a moment, then perform the deletion
-            QTimer::singleShot(1000, this, [this, value]() {
-                root = deleteNode(root, value);
-                statusLabel->setText(QString("Deleted value %1 from tree").arg(value));
-                addStepToHistory(QString("✅ Deleted value %1 from tree").arg(value));
-                addOperationSeparator();
-                
-                isAnimating = false;
-                insertButton->setEnabled(true);
-                searchButton->setEnabled(true);
-                deleteButton->setEnabled(true);
-                clearButton->setEnabled(true);
-                updateStepTrace();
-                update();
-            });
-        }
-        return;
-    }
-
-    resetHighlights(root);
-    traversalPath[step]->isHighlighted = true;
-
-    if (step == 0) {
-        statusLabel->setText(QString("Deleting: comparing %1 with root %2").arg(value).arg(traversalPath[step]->value));
-        addStepToHistory(QString("🗑️ Comparing %1 with root %2").arg(value).arg(traversalPath[step]->value));
-    } else {
-        statusLabel->setText(QString("Deleting: comparing %1 with %2").arg(value).arg(traversalPath[step]->value));
-        addStepToHistory(QString("🗑️ Comparing %1 with %2").arg(value).arg(traversalPath[step]->value));
-    }
-
-    if (value == traversalPath[step]->value) {
-        addStepToHistory(QString("🎯 Target found! %1 == %2").arg(value).arg(traversalPath[step]->value));
-    } else if (value < traversalPath[step]->value) {
-        addStepToHistory(QString("⬅️ %1 < %2, search left").arg(value).arg(traversalPath[step]->value));
-    } else {
-        addStepToHistory(QString("➡️ %1 > %2, search right").arg(value).arg(traversalPath[step]->value));
-    }
-
-    updateStepTrace();
-    update();
-
-    QTimer::singleShot(800, this, [this, node, value, step]() {
-        animateDeleteTraversal(node, value, step + 1);
-    });
-}
-
-void TreeInsertion::calculateNodePositions(TreeNode *node, int x, int y, int horizontalSpacing)
-{
-    if (!node) return;
-
-    node->x = x;
-    node->y = y;
-
-    int nextSpacing = horizontalSpacing / 2;
-
-    if (node->left) {
-        calculateNodePositions(node->left, x - horizontalSpacing, y + LEVEL_HEIGHT, nextSpacing);
-    }
-    if (node->right) {
-        calculateNodePositions(node->right, x + horizontalSpacing, y + LEVEL_HEIGHT, nextSpacing);
-    }
-}
-
-void TreeInsertion::calculateNodePositionsWithSpacing(TreeNode *node, int x, int y, int horizontalSpacing, int verticalSpacing)
-{
-    if (!node) return;
-
-    node->x = x;
-    node->y = y;
-
-    int nextSpacing = horizontalSpacing / 2;
-
-    if (node->left) {
-        calculateNodePositionsWithSpacing(node->left, x - horizontalSpacing, y + verticalSpacing, nextSpacing, verticalSpacing);
-    }
-    if (node->right) {
-        calculateNodePositionsWithSpacing(node->right, x + horizontalSpacing, y + verticalSpacing, nextSpacing, verticalSpacing);
-    }
-}
-
-void TreeInsertion::resetHighlights(TreeNode *node)
-{
-    if (!node) return;
-    node->isHighlighted = false;
-    node->isNewNode = false;
-    node->isSearchHighlighted = false;
-    node->isDeleteHighlighted = false;
-    resetHighlights(node->left);
-    resetHighlights(node->right);
-}
-
-void TreeInsertion::clearTree(TreeNode *node)
-{
-    if (!node) return;
-    clearTree(node->left);
-    clearTree(node->right);
-    delete node;
-}
-
-int TreeInsertion::getTreeHeight(TreeNode *node)
-{
-    if (!node) return 0;
-    return 1 + std::max(getTreeHeight(node->left), getTreeHeight(node->right));
+    };
+    remove.show = [this, value]() {
+        statusLabel->setText(QString("Deleted value %1 from tree").arg(value));
+    };
+    frames.push_back(std::move(remove));
+    timeline->play(std::move(frames));
 }
 
 void TreeInsertion::addStepToHistory(const QString &step)
@@ -956,9 +930,10 @@ void TreeInsertion::addOperationSeparator()
 
 void TreeInsertion::updateStepTrace()
 {
-    stepsList->clear();
-    
-    for (int i = 0; i < stepHistory.size(); ++i) {
+    // Only append steps added since the last refresh; clearing the history clears the list
+    if (stepHistory.size() < stepsList->count()) stepsList->clear();
+
+    for (int i = stepsList->count(); i < stepHistory.size(); ++i) {
         const QString &step = stepHistory[i];
         
         // Handle separator lines like hashmap
@@ -1005,6 +980,16 @@ void TreeInsertion::updateStepTrace()
 
 void TreeInsertion::showAlgorithm(const QString &operation)
 {
+    // Card lines for the balancing operations
+    auto addLine = [this](const QString &text, const QColor &color, int boldSize = 0) {
+        QListWidgetItem *item = new QListWidgetItem(text);
+        item->setForeground(color);
+        if (boldSize > 0) item->setFont(QFont("Segoe UI", boldSize, QFont::Bold));
+        algorithmList->addItem(item);
+    };
+    const QColor step(52, 73, 94);
+    const QColor detail(127, 140, 141);
+
     // Add separator between operations if there are already items (like hashmap)
     if (algorithmList->count() > 0) {
         QListWidgetItem *separator = new QListWidgetItem("────────────────────");
@@ -1164,6 +1149,39 @@ void TreeInsertion::showAlgorithm(const QString &operation)
         worst->setForeground(QColor(231, 76, 60));
         algorithmList->addItem(worst);
     }
+    else if (operation == "Rebalance") {
+        addLine("⚖️ Day-Stout-Warren Rebalance", QColor(123, 79, 255), 12);
+        addLine("1️⃣ Walk down the right spine from the root", step);
+        addLine("   🔄 Left child present → rotate right, stay put", detail);
+        addLine("   ➡️ No left child → move to the right child", detail);
+        addLine("2️⃣ The tree is now a vine: a sorted list", step);
+        addLine("3️⃣ Fold the nodes beyond 2ᵏ - 1 with left rotations", step);
+        addLine("4️⃣ Halve the spine with left rotations until it is 1", step);
+        addLine("⏰ Time Complexity", QColor(155, 89, 182), 11);
+        addLine("   📊 O(n) time, O(1) space - under 2n rotations", QColor(39, 174, 96));
+        addLine("   📏 Result: a complete tree, height ⌊log₂ n⌋ + 1", QColor(39, 174, 96));
+    }
+    else if (operation == "AVL" || operation == "Treap") {
+        if (operation == "AVL") {
+            addLine("⚖️ AVL Tree Balancing", QColor(123, 79, 255), 12);
+            addLine("1️⃣ Insert or delete as in a plain BST", step);
+            addLine("2️⃣ Walk back up, refreshing each node's height", step);
+            addLine("3️⃣ Subtree heights differ by 2 → rotate", step);
+            addLine("   ↪️ Leaning one way: one rotation", detail);
+            addLine("   ↩️ Zig-zag: rotate the child, then the node", detail);
+            addLine("⏰ Time Complexity", QColor(155, 89, 182), 11);
+            addLine("   📊 Always O(log n) - height ≤ 1.44 log₂ n", QColor(39, 174, 96));
+        } else {
+            addLine("🎲 Treap Balancing", QColor(123, 79, 255), 12);
+            addLine("1️⃣ Each key gets a priority hashed from it", step);
+            addLine("2️⃣ Keys keep BST order, priorities heap order", step);
+            addLine("3️⃣ Insert: add a leaf, rotate it above lower priorities", step);
+            addLine("4️⃣ Delete: rotate the node below its higher-priority child", detail);
+            addLine("   → unlink it once it has at most one child", detail);
+            addLine("⏰ Time Complexity", QColor(155, 89, 182), 11);
+            addLine("   📊 Expected O(log n) - shaped like a random BST", QColor(39, 174, 96));
+        }
+    }
     else if (operation == "BFS") {
         // Title
         QListWidgetItem *title = new QListWidgetItem("🌊 Breadth-First Search (BFS) - Binary Search Tree");
@@ -1295,7 +1313,34 @@ void TreeInsertion::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
 
+    // Draw canvas area for tree (matching hashmap style)
+    QRect leftRect = leftPanel->geometry();
+    int canvasY = 200; // Position like hashmap
+    int canvasHeight = leftRect.height() - canvasY + leftRect.y() - 40;
+    QRect canvasRect(leftRect.x() + 30, canvasY, leftRect.width() - 60, canvasHeight);
+
+    if (engine.root()) {
+        // Positions are only recomputed when the shape or canvas changed
+        updateLayout(canvasRect);
+        viewport.setCanvas(canvasRect);
+    }
+
     QPainter painter(this);
+    staticLayer.draw(painter, this, [&](QPainter &layer) { paintStaticLayer(layer, canvasRect); });
+    if (!engine.root()) return;
+
+    // Only the highlighted nodes are drawn each frame, over the cached rest
+    painter.setClipRect(canvasRect);
+    painter.setTransform(viewport.transform());
+    painter.setRenderHint(QPainter::Antialiasing, viewport.zoom() >= 0.5);
+    painter.setFont(QFont("Segoe UI", 14, QFont::Bold));
+    visuals.forEachDecorated([&](int value, const NodeVisual &visual) {
+        drawNode(painter, value, visual);
+    });
+}
+
+void TreeInsertion::paintStaticLayer(QPainter &painter, const QRect &canvasRect)
+{
     painter.setRenderHint(QPainter::Antialiasing);
 
     // Background gradient for left panel only
@@ -1305,14 +1350,8 @@ void TreeInsertion::paintEvent(QPaintEvent *event)
     gradient.setColorAt(1.0, QColor(237, 228, 255));
     painter.fillRect(leftRect, gradient);
 
-    // Draw canvas area for tree (matching hashmap style)
-    int canvasY = 200; // Position like hashmap
-    int canvasHeight = leftRect.height() - canvasY + leftRect.y() - 40;
-    QRect canvasRect(leftRect.x() + 30, canvasY, leftRect.width() - 60, canvasHeight);
-
     // Draw canvas background (like hashmap)
     painter.setPen(QPen(QColor(74, 144, 226, 51), 2)); // rgba(74, 144, 226, 0.2)
-    painter.setBrush(QBrush(QLinearGradient(canvasRect.topLeft(), canvasRect.bottomRight())));
     QLinearGradient canvasGradient(canvasRect.topLeft(), canvasRect.bottomRight());
     canvasGradient.setColorAt(0.0, QColor(248, 251, 255, 250)); // rgba(248, 251, 255, 0.98)
     canvasGradient.setColorAt(1.0, QColor(240, 247, 255, 250)); // rgba(240, 247, 255, 0.98)
@@ -1320,74 +1359,156 @@ void TreeInsertion::paintEvent(QPaintEvent *event)
     painter.drawRoundedRect(canvasRect, 20, 20);
 
     // Draw tree if exists
-    if (root) {
-        // Calculate tree dimensions for auto-zoom
-        int treeHeight = getTreeHeight(root);
-        int canvasWidth = canvasRect.width();
-        int canvasHeight_available = canvasRect.height() - 100; // Leave some margin
-        
-        // Auto-zoom: adjust horizontal spacing based on tree size and canvas width
-        int baseSpacing = canvasWidth / 4;
-        if (treeHeight > 3) {
-            // Reduce spacing for larger trees
-            baseSpacing = std::max(80, canvasWidth / (treeHeight + 1));
-        }
-        
-        // Adjust vertical spacing if tree is too tall
-        int verticalSpacing = LEVEL_HEIGHT;
-        if (treeHeight * LEVEL_HEIGHT > canvasHeight_available) {
-            verticalSpacing = std::max(60, canvasHeight_available / (treeHeight + 1));
-        }
+    if (!engine.root()) return;
+
+    painter.save();
+    painter.setClipRect(canvasRect);
+    painter.setTransform(viewport.transform());
+    // Antialiasing thousands of tiny shapes costs more than it shows
+    painter.setRenderHint(QPainter::Antialiasing, viewport.zoom() >= 0.5);
+    painter.setFont(QFont("Segoe UI", 14, QFont::Bold));
+    drawTree(painter);
+    painter.restore();
+
+    painter.setPen(QColor(120, 120, 140));
+    painter.setFont(QFont("Segoe UI", 9));
+    painter.drawText(canvasRect.adjusted(16, 0, -16, -10), Qt::AlignLeft | Qt::AlignBottom,
+                     QString("📐 Tidy layout: %1 nodes in %2 ms")
+                         .arg(engine.size())
+                         .arg(layoutNanoseconds / 1e6, 0, 'f', 2));
+    painter.drawText(canvasRect.adjusted(16, 0, -16, -10), Qt::AlignRight | Qt::AlignBottom,
+                     QString("🔍 %1% · drag to pan, wheel to zoom, double-click to reset")
+                         .arg(viewport.zoom() * 100, 0, 'f', viewport.zoom() < 0.1 ? 2 : 0));
+}
+
+void TreeInsertion::updateLayout(const QRect &canvasRect)
+{
+    if (canvasRect != layoutCanvas) {
+        layoutCanvas = canvasRect;
+        visuals.invalidateLayout();
+    }
+    if (visuals.isLayoutValid()) return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto placements = TidyTreeLayout::layout(engine.root(), static_cast<TreeNode*>(nullptr),
+                                                   2 * NODE_RADIUS + NODE_GAP);
+    int minX = 0, maxX = 0, treeHeight = 0;
+    for (const auto &placement : placements) {
+        minX = std::min(minX, placement.x);
+        maxX = std::max(maxX, placement.x);
+        treeHeight = std::max(treeHeight, placement.depth + 1);
+    }
+
+    // Spread small trees out to fill the canvas; a tree wider than the
+    // canvas keeps the minimum gap and stays centred on its root
+    const int available = canvasRect.width() - 2 * NODE_RADIUS - 2 * NODE_GAP;
+    const int width = maxX - minX;
+    const bool fits = width <= available;
+    const double spread = fits && width > 0 ? std::min(MAX_LAYOUT_SPREAD, static_cast<double>(available) / width) : 1.0;
+    const double anchor = fits ? (minX + maxX) / 2.0 : 0.0;
+
+    // Adjust vertical spacing if tree is too tall
+    int canvasHeight_available = canvasRect.height() - 100; // Leave some margin
+    int verticalSpacing = LEVEL_HEIGHT;
+    if (treeHeight * LEVEL_HEIGHT > canvasHeight_available) {
+        verticalSpacing = std::max(60, canvasHeight_available / (treeHeight + 1));
+    }
 
-        // Draw tree - position relative to canvas
-        int canvasCenterX = canvasRect.x() + canvasWidth / 2;
-        int treeStartY = canvasRect.y() + 50;
+    // Position relative to canvas
+    int canvasCenterX = canvasRect.x() + canvasRect.width() / 2;
+    int treeStartY = canvasRect.y() + 50;
 
-        // Use adjusted spacing for positioning
-        calculateNodePositionsWithSpacing(root, canvasCenterX, treeStartY, baseSpacing, verticalSpacing);
-        drawTree(painter, root);
+    for (const auto &placement : placements) {
+        NodeVisual &visual = visuals.place(placement.node->value);
+        visual.x = canvasCenterX + static_cast<int>(std::lround((placement.x - anchor) * spread));
+        visual.y = treeStartY + placement.depth * verticalSpacing;
     }
+    visuals.updateSubtreeBounds(placements, static_cast<TreeNode*>(nullptr));
+    visuals.setLayoutValid();
+    staticLayer.invalidate();
+    layoutNanoseconds = timer.nsecsElapsed();
 }
 
-void TreeInsertion::drawTree(QPainter &painter, TreeNode *node)
+void TreeInsertion::wheelEvent(QWheelEvent *event)
 {
-    if (!node) return;
-
-    // Draw edges first
-    if (node->left) {
-        drawEdge(painter, node->x, node->y, node->left->x, node->left->y);
-        drawTree(painter, node->left);
+    if (viewport.wheel(event)) {
+        staticLayer.invalidate();
+        update();
+    } else {
+        QWidget::wheelEvent(event);
     }
-    if (node->right) {
-        drawEdge(painter, node->x, node->y, node->right->x, node->right->y);
-        drawTree(painter, node->right);
+}
+
+void TreeInsertion::mousePressEvent(QMouseEvent *event)
+{
+    if (viewport.press(event)) setCursor(Qt::ClosedHandCursor);
+    else QWidget::mousePressEvent(event);
+}
+
+void TreeInsertion::mouseMoveEvent(QMouseEvent *event)
+{
+    if (viewport.move(event)) {
+        staticLayer.invalidate();
+        update();
+    } else {
+        QWidget::mouseMoveEvent(event);
     }
+}
 
-    // Draw node on top
-    drawNode(painter, node);
+void TreeInsertion::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (viewport.release(event)) unsetCursor();
+    else QWidget::mouseReleaseEvent(event);
 }
 
-void TreeInsertion::drawNode(QPainter &painter, TreeNode *node)
+void TreeInsertion::mouseDoubleClickEvent(QMouseEvent *event)
 {
-    if (!node) return;
+    if (viewport.doubleClick(event)) {
+        staticLayer.invalidate();
+        update();
+    } else {
+        QWidget::mouseDoubleClickEvent(event);
+    }
+}
+
+void TreeInsertion::drawTree(QPainter &painter)
+{
+    viewport.walk(engine.root(), static_cast<TreeNode*>(nullptr), visuals, NODE_RADIUS,
+        [&](TreeNode *node, const NodeVisual &visual) {
+            // Draw edges first, node on top
+            for (TreeNode *child : {node->left, node->right}) {
+                if (!child) continue;
+                const NodeVisual below = visuals.at(child->value);
+                drawEdge(painter, visual.x, visual.y, below.x, below.y);
+            }
+            drawNode(painter, node->value, visual.undecorated());
+        },
+        [&](TreeNode *, const NodeVisual &visual) {
+            viewport.drawSummary(painter, visual, QColor(123, 79, 255));
+        });
+}
 
+void TreeInsertion::drawNode(QPainter &painter, int value, const NodeVisual &visual)
+{
     // Node circle with different colors based on state
-    if (node->isTraversalHighlighted) {
+    if (visual.isTraversalHighlighted) {
         painter.setPen(QPen(QColor(255, 140, 0), 4));  // Orange border for currently visiting
         painter.setBrush(QColor(255, 165, 0));         // Orange fill
-    } else if (node->isVisited && traversalType != TraversalType::None) {
+    } else if (visual.isVisited && traversalType != TraversalType::None) {
         painter.setPen(QPen(QColor(34, 139, 34), 4));  // Green border for visited (only during traversal)
         painter.setBrush(QColor(50, 205, 50));         // Green fill
-    } else if (node->isSearchHighlighted) {
+    } else if (visual.isSearchHighlighted) {
         painter.setPen(QPen(QColor(52, 152, 219), 4)); // Blue for found
         painter.setBrush(QColor(174, 214, 241));
-    } else if (node->isDeleteHighlighted) {
+    } else if (visual.isDeleteHighlighted) {
         painter.setPen(QPen(QColor(231, 76, 60), 4)); // Red for delete
         painter.setBrush(QColor(248, 148, 148));
-    } else if (node->isHighlighted) {
+    } else if (visual.isHighlighted) {
         painter.setPen(QPen(QColor(255, 165, 0), 4)); // Orange for traversal
         painter.setBrush(QColor(255, 200, 100));
-    } else if (node->isNewNode) {
+    } else if (visual.isNewNode) {
         painter.setPen(QPen(QColor(50, 205, 50), 4)); // Green for new
         painter.setBrush(QColor(144, 238, 144));
     } else {
@@ -1395,15 +1516,14 @@ void TreeInsertion::drawNode(QPainter &painter, TreeNode *node)
         painter.setBrush(QColor(200, 180, 255));
     }
 
-    painter.drawEllipse(QPoint(node->x, node->y), NODE_RADIUS, NODE_RADIUS);
+    painter.drawEllipse(QPoint(visual.x, visual.y), NODE_RADIUS, NODE_RADIUS);
 
-    // Node value
+    // Node value, in the font paintEvent set; unreadable when zoomed far out
+    if (!viewport.showsLabels(NODE_RADIUS)) return;
     painter.setPen(Qt::black);
-    QFont font("Segoe UI", 14, QFont::Bold);
-    painter.setFont(font);
-    painter.drawText(QRect(node->x - NODE_RADIUS, node->y - NODE_RADIUS,
+    painter.drawText(QRect(visual.x - NODE_RADIUS, visual.y - NODE_RADIUS,
                            NODE_RADIUS * 2, NODE_RADIUS * 2),
-                     Qt::AlignCenter, QString::number(node->value));
+                     Qt::AlignCenter, QString::number(value));
 }
 
 void TreeInsertion::drawEdge(QPainter &painter, int x1, int y1, int x2, int y2)
@@ -1412,15 +1532,6 @@ void TreeInsertion::drawEdge(QPainter &painter, int x1, int y1, int x2, int y2)
     painter.drawLine(x1, y1 + NODE_RADIUS, x2, y2 - NODE_RADIUS);
 }
 
-void TreeInsertion::resetTraversalHighlights(TreeNode *node)
-{
-    if (!node) return;
-    node->isTraversalHighlighted = false;
-    node->isVisited = false;
-    resetTraversalHighlights(node->left);
-    resetTraversalHighlights(node->right);
-}
-
 void TreeInsertion::setControlsEnabled(bool enabled)
 {
     // Back button should NEVER be disabled - user must always be able to go back!
@@ -1430,6 +1541,8 @@ void TreeInsertion::setControlsEnabled(bool enabled)
     deleteButton->setEnabled(enabled);
     searchButton->setEnabled(enabled);
     clearButton->setEnabled(enabled);
+    balanceBox->setEnabled(enabled);
+    rebalanceButton->setEnabled(enabled);
     bfsButton->setEnabled(enabled);
     dfsButton->setEnabled(enabled);
 }
@@ -1437,168 +1550,142 @@ void TreeInsertion::setControlsEnabled(bool enabled)
 void TreeInsertion::onStartBFS()
 {
     showAlgorithm("BFS");
-    
-    if (!root) {
+
+    if (!engine.root()) {
         addStepToHistory("❌ Tree is empty: Please insert nodes first");
         QMessageBox::warning(this, "Empty Tree", "Please insert nodes to the tree first.");
         return;
     }
-    
+
+    OperationRecorder::instance().record(LoggedOperation::BST, "bfs");
     addStepToHistory("🌊 Starting BFS traversal from root");
-    resetTraversalHighlights(root);
+    visuals.resetTraversal();
     traversalType = TraversalType::BFS;
-    traversalOrder.clear();
+    traversalCursor = engine.cursor(TraversalOrder::LevelOrder);
+    traversalCurrent = nullptr;
     traversalIndex = 0;
-    
-    performBFS();
-    
-    QString result = "🌊 BFS Order: ";
-    for (int i = 0; i < traversalOrder.size(); ++i) {
-        result += QString::number(traversalOrder[i]->value);
-        if (i < traversalOrder.size() - 1) result += " → ";
-    }
-    
-    traversalResultList->clear();
-    if (traversalOrder.isEmpty()) {
-        traversalResultList->addItem("❌ No traversal result");
-    } else {
-        traversalResultList->addItem(result);
-    }
-    
+
+    showTraversalResult("🌊 BFS Order: ", TraversalOrder::LevelOrder);
+    addStepToHistory("🔄 Initializing BFS queue");
+    addStepToHistory(QString("➕ Added root node %1 to queue").arg(engine.root()->value));
+
     setControlsEnabled(false);
-    traversalAnimTimer->start(800);
+    traversalAnimTimer->start(AnimationTimeline::scaled(800));
     statusLabel->setText("Running BFS...");
-    addStepToHistory("✅ BFS traversal order computed, starting animation");
+    addStepToHistory("✅ BFS ready, visiting one node per step");
     addOperationSeparator();
 }
 
 void TreeInsertion::onStartDFS()
 {
     showAlgorithm("DFS");
-    
-    if (!root) {
+
+    if (!engine.root()) {
         addStepToHistory("❌ Tree is empty: Please insert nodes first");
         QMessageBox::warning(this, "Empty Tree", "Please insert nodes to the tree first.");
         return;
     }
-    
+
+    OperationRecorder::instance().record(LoggedOperation::BST, "dfs");
     addStepToHistory("🏔️ Starting DFS traversal from root");
-    resetTraversalHighlights(root);
+    visuals.resetTraversal();
     traversalType = TraversalType::DFS;
-    traversalOrder.clear();
+    traversalCursor = engine.cursor(TraversalOrder::PreOrder);
+    traversalCurrent = nullptr;
     traversalIndex = 0;
-    
-    performDFS();
-    
-    QString result = "🏔️ DFS Order: ";
-    for (int i = 0; i < traversalOrder.size(); ++i) {
-        result += QString::number(traversalOrder[i]->value);
-        if (i < traversalOrder.size() - 1) result += " → ";
-    }
-    
-    traversalResultList->clear();
-    if (traversalOrder.isEmpty()) {
-        traversalResultList->addItem("❌ No traversal result");
-    } else {
-        traversalResultList->addItem(result);
-    }
-    
+
+    showTraversalResult("🏔️ DFS Order: ", TraversalOrder::PreOrder);
+    addStepToHistory("🔄 Starting DFS traversal (preorder: Root → Left → Right)");
+    addStepToHistory("📍 Following child and parent links - no recursion, no stack");
+
     setControlsEnabled(false);
-    traversalAnimTimer->start(800);
+    traversalAnimTimer->start(AnimationTimeline::scaled(800));
     statusLabel->setText("Running DFS...");
-    addStepToHistory("✅ DFS traversal order computed, starting animation");
+    addStepToHistory("✅ DFS ready, visiting one node per step");
     addOperationSeparator();
 }
 
-void TreeInsertion::performBFS()
+void TreeInsertion::showTraversalResult(const QString &title, TraversalOrder order)
 {
-    if (!root) return;
-    
-    addStepToHistory("🔄 Initializing BFS queue");
-    QList<TreeNode*> queue;
-    queue.append(root);
-    addStepToHistory(QString("➕ Added root node %1 to queue").arg(root->value));
-    
-    while (!queue.isEmpty()) {
-        TreeNode* current = queue.front();
-        queue.pop_front();
-        traversalOrder.append(current);
-        
-        addStepToHistory(QString("🎯 Processing node %1").arg(current->value));
-        
-        if (current->left) {
-            queue.append(current->left);
-            addStepToHistory(QString("⬅️ Added left child %1 to queue").arg(current->left->value));
-        }
-        if (current->right) {
-            queue.append(current->right);
-            addStepToHistory(QString("➡️ Added right child %1 to queue").arg(current->right->value));
+    // A walk of its own: the order is listed without collecting it, and
+    // big trees show only its head and the node count
+    TreeCursor<TreeNode> walk = engine.cursor(order);
+    QString result = title;
+    int count = 0;
+    while (TreeNode *node = walk.next()) {
+        if (count < TRAVERSAL_PREVIEW_LIMIT) {
+            if (count > 0) result += " → ";
+            result += QString::number(node->value);
         }
+        ++count;
     }
-}
+    if (count > TRAVERSAL_PREVIEW_LIMIT) result += QString(" → … (%1 nodes)").arg(count);
 
-void TreeInsertion::performDFS()
-{
-    if (!root) return;
-    
-    addStepToHistory("🔄 Starting DFS traversal (preorder: Root → Left → Right)");
-    addStepToHistory("📍 Using recursive depth-first approach");
-    
-    // Use recursive DFS for correct preorder traversal
-    performDFSRecursive(root);
+    traversalResultList->clear();
+    if (count == 0) {
+        traversalResultList->addItem("❌ No traversal result");
+    } else {
+        traversalResultList->addItem(result);
+    }
 }
 
-void TreeInsertion::performDFSRecursive(TreeNode* node)
+void TreeInsertion::narrateTraversalStep(TreeNode *node)
 {
-    if (!node) return;
-    
-    // Preorder: Process current node first
-    traversalOrder.append(node);
-    addStepToHistory(QString("🎯 Visiting node %1 (preorder)").arg(node->value));
-    
-    // Then recursively visit left subtree
-    if (node->left) {
-        addStepToHistory(QString("⬅️ Going to left subtree of %1").arg(node->value));
-        performDFSRecursive(node->left);
+    if (traversalType == TraversalType::BFS) {
+        addStepToHistory(QString("🎯 Processing node %1").arg(node->value));
+        if (node->left) {
+            addStepToHistory(QString("⬅️ Added left child %1 to queue").arg(node->left->value));
+        }
+        if (node->right) {
+            addStepToHistory(QString("➡️ Added right child %1 to queue").arg(node->right->value));
+        }
+        return;
     }
-    
-    // Finally recursively visit right subtree
-    if (node->right) {
-        addStepToHistory(QString("➡️ Going to right subtree of %1").arg(node->value));
-        performDFSRecursive(node->right);
+
+    // Preorder reaches each node from its parent
+    if (TreeNode *parent = node->parent()) {
+        if (node == parent->left) {
+            addStepToHistory(QString("⬅️ Going to left subtree of %1").arg(parent->value));
+        } else {
+            addStepToHistory(QString("➡️ Going to right subtree of %1").arg(parent->value));
+        }
     }
+    addStepToHistory(QString("🎯 Visiting node %1 (preorder)").arg(node->value));
 }
 
 void TreeInsertion::onTraversalAnimationStep()
 {
-    if (traversalIndex > 0 && traversalIndex <= traversalOrder.size()) {
-        TreeNode* prev = traversalOrder[traversalIndex - 1];
+    if (traversalCurrent) {
         // Mark previous as visited (persist green), remove highlight
-        prev->isVisited = true;
-        prev->isTraversalHighlighted = false;
+        NodeVisual &visual = visuals[traversalCurrent->value];
+        visual.isVisited = true;
+        visual.isTraversalHighlighted = false;
     }
-    
-    if (traversalIndex >= traversalOrder.size()) {
+
+    TreeNode* current = traversalCursor.next();
+    if (!current) {
         QString algo = (traversalType == TraversalType::BFS) ? "BFS" : "DFS";
         traversalAnimTimer->stop();
         traversalType = TraversalType::None;
-        
+        traversalCurrent = nullptr;
+
         // Reset traversal highlights to restore original colors
-        resetTraversalHighlights(root);
-        
+        visuals.resetTraversal();
+
         setControlsEnabled(true);
         statusLabel->setText("Traversal complete.");
-        addStepToHistory(QString("🎯 %1 traversal completed. Visited %2 nodes").arg(algo).arg(traversalOrder.size()));
+        addStepToHistory(QString("🎯 %1 traversal completed. Visited %2 nodes").arg(algo).arg(traversalIndex));
         update();
         return;
     }
-    
-    TreeNode* current = traversalOrder[traversalIndex];
-    current->isTraversalHighlighted = true;
-    
+
+    traversalCurrent = current;
+    narrateTraversalStep(current);
+    visuals[current->value].isTraversalHighlighted = true;
+
     QString algo = (traversalType == TraversalType::BFS) ? "BFS" : "DFS";
     addStepToHistory(QString("👁️ %1: Currently visiting node %2").arg(algo).arg(current->value));
-    
+
     traversalIndex++;
     update();
 }
\ No newline at end of file
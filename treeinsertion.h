@@ -23,32 +23,24 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QComboBox>
 #include <cmath>
+#include <functional>
+#include <optional>
 #include "uiutils.h"
 #include "backbutton.h"
 #include "stylemanager.h"
 #include "widgetmanager.h"
+#include "bstengine.h"
+#include "nodevisual.h"
+#include "treelayout.h"
+#include "treeviewport.h"
+#include "staticlayer.h"
+#include "sessioncontrols.h"
+#include "animationtimeline.h"
 
-// Tree Node structure
-struct TreeNode {
-    int value;
-    TreeNode *left;
-    TreeNode *right;
-    int x, y;  // Position for drawing
-    bool isHighlighted;
-    bool isNewNode;
-    bool isSearchHighlighted;
-    bool isDeleteHighlighted;
-    bool isTraversalHighlighted;
-    bool isVisited;
-
-    TreeNode(int val) : value(val), left(nullptr), right(nullptr),
-        x(0), y(0), isHighlighted(false), isNewNode(false), 
-        isSearchHighlighted(false), isDeleteHighlighted(false),
-        isTraversalHighlighted(false), isVisited(false) {}
-};
-
-class TreeInsertion : public QWidget
+class TreeInsertion : public QWidget, public ReplayTarget, public EngineObserver
 {
     Q_OBJECT
 
@@ -56,11 +48,25 @@ public:
     explicit TreeInsertion(QWidget *parent = nullptr);
     ~TreeInsertion();
 
+    // ReplayTarget
+    LoggedOperation::Lab replayLab() const override { return LoggedOperation::BST; }
+    bool isReplayBusy() const override;
+    bool replayOperation(const LoggedOperation &operation) override;
+
+    // EngineObserver
+    void onEngineEvent(const EngineEvent &event) override;
+
 signals:
     void backToOperations();
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    // Pan and zoom on the canvas
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
 
 private slots:
     void onBackClicked();
@@ -69,6 +75,8 @@ private slots:
     void onDeleteClicked();
     void onClearClicked();
     void onRandomizeClicked();
+    void onBalanceModeChanged(int index);
+    void onRebalanceClicked();
     void onStartBFS();
     void onStartDFS();
     void onTraversalAnimationStep();
@@ -79,34 +87,29 @@ private:
     void setupRightPanel();
     void setupStepTrace();
     void setupTraversalControls();
+    void setupTimelineControls();
+    void setupSessionControls();
     void insertNode(int value);
+    void setAnimating(bool animating);
+    void queueRebalance(std::function<void()> done);
+    std::vector<AnimationFrame> comparisonFrames(const std::vector<TreeNode*> &path, int value,
+                                                 const QString &operation);
     void animateInsertion(int value);
     void animateSearch(int value);
     void animateDelete(int value);
-    TreeNode* searchNode(int value);
-    TreeNode* deleteNode(TreeNode* node, int value);
-    TreeNode* findMin(TreeNode* node);
-    void calculateNodePositions(TreeNode *node, int x, int y, int horizontalSpacing);
-    void calculateNodePositionsWithSpacing(TreeNode *node, int x, int y, int horizontalSpacing, int verticalSpacing);
-    void drawTree(QPainter &painter, TreeNode *node);
-    void drawNode(QPainter &painter, TreeNode *node);
+    void updateLayout(const QRect &canvasRect);
+    void paintStaticLayer(QPainter &painter, const QRect &canvasRect);
+    void drawTree(QPainter &painter);
+    void drawNode(QPainter &painter, int value, const NodeVisual &visual);
     void drawEdge(QPainter &painter, int x1, int y1, int x2, int y2);
-    void clearTree(TreeNode *node);
-    int getTreeHeight(TreeNode *node);
-    void resetHighlights(TreeNode *node);
-    void resetTraversalHighlights(TreeNode *node);
-    void animateTraversal(TreeNode *node, int value, int step);
-    void animateSearchTraversal(TreeNode *node, int value, int step);
-    void animateDeleteTraversal(TreeNode *node, int value, int step);
     void addStepToHistory(const QString &step);
     void addOperationSeparator();
     void updateStepTrace();
     void showAlgorithm(const QString &operation);
     
     // Traversal methods
-    void performBFS();
-    void performDFS();
-    void performDFSRecursive(TreeNode* node);
+    void showTraversalResult(const QString &title, TraversalOrder order);
+    void narrateTraversalStep(TreeNode *node);
     void setControlsEnabled(bool enabled);
 
     // UI Components - using UIUtils for reduced repetition
@@ -122,6 +125,8 @@ private:
     QPushButton *deleteButton;
     QPushButton *clearButton;
     QPushButton *randomizeButton;
+    QComboBox *balanceBox;  // Plain BST, AVL or Treap
+    QPushButton *rebalanceButton;
     QPushButton *bfsButton;
     QPushButton *dfsButton;
     QLineEdit *inputField;
@@ -139,28 +144,43 @@ private:
     QGroupBox *traversalGroup;
     QListWidget *traversalResultList;
 
-    // Tree data
-    TreeNode *root;
+    // Animation speed / scrubbing, session record / replay
+    TimelineControls *timelineControls;
+    SessionControls *sessionControls;
+
+    // Tree data - the engine owns the nodes, the widget only draws them
+    BSTEngine engine;
+    NodeVisualTable visuals;  // Positions and highlights, keyed by value
+    QRect layoutCanvas;       // Canvas the cached positions were laid out for
+    qint64 layoutNanoseconds = 0;
+    TreeViewport viewport;
+    StaticLayer staticLayer;  // Background, edges and plain nodes between shape changes
 
     // Animation and operation tracking
     QTimer *animationTimer;
-    QVector<TreeNode*> traversalPath;
+    AnimationTimeline *timeline;  // Plays insert/search/delete one comparison per frame
     QVector<QString> stepHistory;
-    int currentTraversalStep;
     bool isAnimating;
+    std::optional<int> risenValue;  // Node the last rebalancing rotation moved up
+    bool narrateRotations = true;   // Off while a big rebalance runs at once
+    static constexpr int REBALANCE_ANIMATION_LIMIT = 63;  // Larger trees rebalance in one step
     QString currentOperation;
     
     // Traversal animation
     enum class TraversalType { None, BFS, DFS };
     TraversalType traversalType;
-    QList<TreeNode*> traversalOrder;
+    TreeCursor<TreeNode> traversalCursor;  // Yields one node per animation step
+    TreeNode *traversalCurrent = nullptr;   // Node highlighted by the last step
     int traversalIndex;
     QTimer *traversalAnimTimer;
+    static constexpr int TRAVERSAL_PREVIEW_LIMIT = 32;  // Values listed before "…"
 
     // Drawing constants
     const int NODE_RADIUS = 25;
     const int LEVEL_HEIGHT = 80;
     const int CANVAS_TOP_MARGIN = 60;
+    const int NODE_GAP = 10;  // Least space between two nodes on a level
+    static constexpr double MAX_LAYOUT_SPREAD = 3.0;  // Small trees: gaps up to 3x wider
 };
 
 #endif // TREEINSERTION_H
@@ -0,0 +1,120 @@
+#include "treelayout.h"
+
+#include <cstdlib>
+
+namespace {
+
+// Outermost node on a subtree's deepest level, x relative to the subtree's root
+struct Extreme {
+    int node = -1;
+    int offset = 0;
+    int level = -1;  // -1 for an empty subtree
+};
+
+} // namespace
+
+std::vector<int> TidyTreeLayout::place(const std::vector<int> &left, const std::vector<int> &right, int minSeparation)
+{
+    const int n = static_cast<int>(left.size());
+    std::vector<int> x(static_cast<std::size_t>(n), 0);
+    if (n == 0) return x;
+
+    std::vector<int> level(static_cast<std::size_t>(n), 0);
+    for (int i = 0; i < n; ++i) {
+        if (left[i] >= 0) level[left[i]] = level[i] + 1;
+        if (right[i] >= 0) level[right[i]] = level[i] + 1;
+    }
+
+    // Contour links are the children, plus threads: when one subtree is
+    // shallower than its sibling, its deepest outer leaf is linked to the
+    // next node down the sibling's contour, so contours are walked level by
+    // level in O(1) per step. offset is the distance to a node's children,
+    // or to its thread's target; the side of the link gives the sign.
+    std::vector<int> contourLeft(left), contourRight(right);
+    std::vector<int> offset(static_cast<std::size_t>(n), 0);
+    std::vector<Extreme> leftmost(static_cast<std::size_t>(n)), rightmost(static_cast<std::size_t>(n));
+
+    // Reverse preorder visits children before their parent
+    for (int t = n - 1; t >= 0; --t) {
+        if (left[t] < 0 && right[t] < 0) {
+            leftmost[t] = rightmost[t] = {t, 0, level[t]};
+            continue;
+        }
+
+        const Extreme none;
+        const Extreme leftLeft = left[t] >= 0 ? leftmost[left[t]] : none;
+        const Extreme leftRight = left[t] >= 0 ? rightmost[left[t]] : none;
+        const Extreme rightLeft = right[t] >= 0 ? leftmost[right[t]] : none;
+        const Extreme rightRight = right[t] >= 0 ? rightmost[right[t]] : none;
+
+        // Walk the left subtree's right contour and the right subtree's left
+        // contour together, widening the gap at the root wherever they come
+        // closer than minSeparation
+        int l = left[t], r = right[t];
+        int currentSeparation = minSeparation, rootSeparation = minSeparation;
+        int leftSum = 0, rightSum = 0;  // x of l and r relative to their subtree roots
+        while (l >= 0 && r >= 0) {
+            if (currentSeparation < minSeparation) {
+                rootSeparation += minSeparation - currentSeparation;
+                currentSeparation = minSeparation;
+            }
+            if (contourRight[l] >= 0) {
+                leftSum += offset[l];
+                currentSeparation -= offset[l];
+                l = contourRight[l];
+            } else {
+                leftSum -= offset[l];
+                currentSeparation += offset[l];
+                l = contourLeft[l];
+            }
+            if (contourLeft[r] >= 0) {
+                rightSum -= offset[r];
+                currentSeparation -= offset[r];
+                r = contourLeft[r];
+            } else {
+                rightSum += offset[r];
+                currentSeparation += offset[r];
+                r = contourRight[r];
+            }
+        }
+
+        offset[t] = (rootSeparation + 1) / 2;
+        leftSum -= offset[t];   // Now relative to t
+        rightSum += offset[t];
+
+        // The outermost deepest nodes come from the deeper side
+        if (rightLeft.level > leftLeft.level || left[t] < 0) {
+            leftmost[t] = rightLeft;
+            leftmost[t].offset += offset[t];
+        } else {
+            leftmost[t] = leftLeft;
+            leftmost[t].offset -= offset[t];
+        }
+        if (leftRight.level > rightRight.level || right[t] < 0) {
+            rightmost[t] = leftRight;
+            rightmost[t].offset -= offset[t];
+        } else {
+            rightmost[t] = rightRight;
+            rightmost[t].offset += offset[t];
+        }
+
+        // Thread the shallower side's contour on to the deeper side's
+        if (l >= 0 && l != left[t]) {
+            const int distance = leftSum - (rightRight.offset + offset[t]);
+            offset[rightRight.node] = std::abs(distance);
+            (distance <= 0 ? contourLeft : contourRight)[rightRight.node] = l;
+        } else if (r >= 0 && r != right[t]) {
+            const int distance = rightSum - (leftLeft.offset - offset[t]);
+            offset[leftLeft.node] = std::abs(distance);
+            (distance >= 0 ? contourRight : contourLeft)[leftLeft.node] = r;
+        }
+    }
+
+    // Threads only ever start at leaves, so the real children still sit at
+    // -offset and +offset from their parent
+    for (int i = 0; i < n; ++i) {
+        if (left[i] >= 0) x[left[i]] = x[i] - offset[i];
+        if (right[i] >= 0) x[right[i]] = x[i] + offset[i];
+    }
+    return x;
+}
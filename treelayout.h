@@ -0,0 +1,61 @@
+#ifndef TREELAYOUT_H
+#define TREELAYOUT_H
+
+#include <utility>
+#include <vector>
+
+// Reingold-Tilford tidy drawing of a binary tree, in O(n) time and without
+// recursion, so degenerate trees of any depth are fine. Each subtree is
+// drawn on its own, then the two subtrees under a node are pushed apart
+// just far enough that no two nodes on a level are closer than
+// minSeparation, following their facing contours; the node sits midway
+// above them. Mirror-image subtrees get mirror-image drawings.
+class TidyTreeLayout
+{
+public:
+    template <typename Node>
+    struct Placement {
+        Node *node;
+        int x;      // Relative to the root, in the units of minSeparation
+        int depth;  // 0 for the root
+    };
+
+    // Every node of the tree under root, in preorder. nil is what the tree
+    // uses for a missing child (nullptr, or a sentinel).
+    template <typename Node>
+    static std::vector<Placement<Node>> layout(Node *root, Node *nil, int minSeparation)
+    {
+        std::vector<Placement<Node>> placements;
+        std::vector<int> left, right;
+        if (root == nil) return placements;
+
+        // Flatten to preorder index arrays: (node, parent index, is left child)
+        std::vector<std::pair<Node*, std::pair<int, bool>>> stack{{root, {-1, false}}};
+        while (!stack.empty()) {
+            auto [node, link] = stack.back();
+            stack.pop_back();
+            const int index = static_cast<int>(placements.size());
+            const int parent = link.first;
+            placements.push_back({node, 0, parent < 0 ? 0 : placements[static_cast<std::size_t>(parent)].depth + 1});
+            left.push_back(-1);
+            right.push_back(-1);
+            if (parent >= 0) {
+                (link.second ? left : right)[static_cast<std::size_t>(parent)] = index;
+            }
+            if (node->right != nil) stack.push_back({node->right, {index, false}});
+            if (node->left != nil) stack.push_back({node->left, {index, true}});
+        }
+
+        const std::vector<int> x = place(left, right, minSeparation);
+        for (std::size_t i = 0; i < placements.size(); ++i) {
+            placements[i].x = x[i];
+        }
+        return placements;
+    }
+
+    // Core of layout(): nodes in preorder, node 0 the root, left/right hold
+    // child indices or -1. Returns each node's x relative to the root.
+    static std::vector<int> place(const std::vector<int> &left, const std::vector<int> &right, int minSeparation);
+};
+
+#endif // TREELAYOUT_H
@@ -0,0 +1,155 @@
+#ifndef TREETRAVERSAL_H
+#define TREETRAVERSAL_H
+
+#include <cstddef>
+#include <vector>
+
+enum class TraversalOrder {
+    PreOrder,    // Root, left, right - the labs' DFS
+    InOrder,     // Ascending keys
+    PostOrder,   // Children before their parent
+    LevelOrder   // Top to bottom, left to right - the labs' BFS
+};
+
+// Lazy walk over a binary tree whose nodes expose left, right and
+// parent(); children equal to nil are absent (nullptr for BSTEngine, the
+// NIL sentinel for RBTreeEngine). next() hands out one node per call.
+// Unlike Morris threading it never rewires the tree, so a walk can stay
+// open across animation frames while the tree is drawn.
+//
+// Pre-, in- and post-order climb parent links: a walk holds two pointers,
+// with no recursion, no stack and no heap allocation, at amortised O(1)
+// per node. Level order keeps a frontier of the level being handed out
+// and the one below it, so it is O(1) per node too and holds at most two
+// levels' worth of pointers - one pointer for each level of a degenerate
+// BST, about n for the bottom of a balanced tree.
+//
+// The tree must not change while a walk is open.
+template <typename Node>
+class TreeCursor
+{
+public:
+    TreeCursor() = default;  // Already exhausted
+    TreeCursor(Node *root, Node *nil, TraversalOrder order)
+        : root(present(root, nil) ? root : nullptr), nil(nil), order(order) {}
+
+    // The next node in order, nullptr once every node was returned
+    Node *next()
+    {
+        if (!root) return nullptr;
+        if (order == TraversalOrder::LevelOrder) return nextLevelOrder();
+        if (!started) {
+            started = true;
+            current = first();
+        } else if (current) {
+            current = following(current);
+        }
+        return current;
+    }
+
+    // Depth of the node next() returned last (level order only)
+    int depth() const { return level; }
+
+private:
+    bool has(Node *node) const { return present(node, nil); }
+    static bool present(Node *node, Node *nil) { return node && node != nil; }
+
+    Node *first()
+    {
+        switch (order) {
+        case TraversalOrder::InOrder:   return leftmost(root);
+        case TraversalOrder::PostOrder: return firstPostOrder(root);
+        default:                        return root;
+        }
+    }
+
+    Node *following(Node *node)
+    {
+        switch (order) {
+        case TraversalOrder::PreOrder:  return nextPreOrder(node);
+        case TraversalOrder::InOrder:   return nextInOrder(node);
+        case TraversalOrder::PostOrder: return nextPostOrder(node);
+        case TraversalOrder::LevelOrder: break;
+        }
+        return nullptr;
+    }
+
+    Node *leftmost(Node *node) const
+    {
+        while (has(node->left)) node = node->left;
+        return node;
+    }
+
+    // Deepest node reached by going left when possible, else right
+    Node *firstPostOrder(Node *node) const
+    {
+        for (;;) {
+            if (has(node->left)) node = node->left;
+            else if (has(node->right)) node = node->right;
+            else return node;
+        }
+    }
+
+    Node *nextPreOrder(Node *node) const
+    {
+        if (has(node->left)) return node->left;
+        if (has(node->right)) return node->right;
+        // Climb to the nearest ancestor whose right subtree is still ahead
+        for (Node *parent = up(node); parent; node = parent, parent = up(node)) {
+            if (node == parent->left && has(parent->right)) return parent->right;
+        }
+        return nullptr;
+    }
+
+    Node *nextInOrder(Node *node) const
+    {
+        if (has(node->right)) return leftmost(node->right);
+        Node *parent = up(node);
+        while (parent && node == parent->right) {
+            node = parent;
+            parent = up(node);
+        }
+        return parent;
+    }
+
+    Node *nextPostOrder(Node *node) const
+    {
+        Node *parent = up(node);
+        if (!parent) return nullptr;
+        if (node == parent->left && has(parent->right)) return firstPostOrder(parent->right);
+        return parent;
+    }
+
+    Node *nextLevelOrder()
+    {
+        if (!started) {
+            started = true;
+            frontier.push_back(root);
+        } else if (at == frontier.size()) {
+            // Level finished: the children gathered from it open the next one
+            if (below.empty()) return nullptr;
+            frontier.swap(below);
+            below.clear();
+            at = 0;
+            ++level;
+        }
+        Node *node = frontier[at++];
+        if (has(node->left)) below.push_back(node->left);
+        if (has(node->right)) below.push_back(node->right);
+        return node;
+    }
+
+    Node *up(Node *node) const { return node == root ? nullptr : node->parent(); }
+
+    Node *root = nullptr;
+    Node *nil = nullptr;
+    TraversalOrder order = TraversalOrder::PreOrder;
+    Node *current = nullptr;
+    std::vector<Node*> frontier;  // Level order: the level being handed out
+    std::vector<Node*> below;     // Level order: its children, the next level
+    std::size_t at = 0;           // Level order: next index into frontier
+    int level = 0;
+    bool started = false;
+};
+
+#endif // TREETRAVERSAL_H
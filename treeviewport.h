@@ -0,0 +1,164 @@
+#ifndef TREEVIEWPORT_H
+#define TREEVIEWPORT_H
+
+#include "nodevisual.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPolygonF>
+#include <QTransform>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Pan and zoom over a tree lab's canvas. Nodes keep their cached layout
+// positions; only the painter's transform changes, so panning and zooming
+// never lay the tree out again. walk() visits just the part of the tree
+// that can be seen: subtrees outside the canvas are skipped whole, and
+// subtrees too narrow on screen to tell their nodes apart are handed over
+// as one summary instead of node by node. A frame then costs about as much
+// as what is on screen, however big the tree is.
+class TreeViewport
+{
+public:
+    static constexpr double MIN_ZOOM = 0.0001;
+    static constexpr double MAX_ZOOM = 4.0;
+    static constexpr double COLLAPSE_PIXELS = 24.0;  // Narrower subtrees are drawn as a summary
+    static constexpr double LABEL_PIXELS = 8.0;      // Smaller node radii are drawn without their value
+
+    void setCanvas(const QRect &canvas) { canvasRect = canvas; }
+    const QRect &canvas() const { return canvasRect; }
+
+    double zoom() const { return scale; }
+    bool showsLabels(int nodeRadius) const { return nodeRadius * scale >= LABEL_PIXELS; }
+
+    // Layout positions to widget coordinates, zooming about the canvas centre
+    QTransform transform() const
+    {
+        const QPointF center = QRectF(canvasRect).center();
+        QTransform transform;
+        transform.translate(center.x() + pan.x(), center.y() + pan.y());
+        transform.scale(scale, scale);
+        transform.translate(-center.x(), -center.y());
+        return transform;
+    }
+
+    // The canvas in layout positions
+    QRectF visibleArea() const { return transform().inverted().mapRect(QRectF(canvasRect)); }
+
+    void reset()
+    {
+        scale = 1.0;
+        pan = QPointF();
+        panning = false;
+    }
+
+    // Mouse handling. Each returns true when it used the event.
+    bool wheel(QWheelEvent *event)
+    {
+        const QPointF at = event->position();
+        if (!canvasRect.contains(at.toPoint())) return false;
+        const QPointF layoutPoint = transform().inverted().map(at);
+        scale = std::clamp(scale * std::pow(1.0015, event->angleDelta().y()), MIN_ZOOM, MAX_ZOOM);
+        // Keep the point under the cursor where it was
+        const QPointF center = QRectF(canvasRect).center();
+        pan = at - center - (layoutPoint - center) * scale;
+        event->accept();
+        return true;
+    }
+
+    bool press(QMouseEvent *event)
+    {
+        if (event->button() != Qt::LeftButton || !canvasRect.contains(event->position().toPoint())) return false;
+        panning = true;
+        lastMouse = event->position();
+        return true;
+    }
+
+    bool move(QMouseEvent *event)
+    {
+        if (!panning) return false;
+        pan += event->position() - lastMouse;
+        lastMouse = event->position();
+        return true;
+    }
+
+    bool release(QMouseEvent *event)
+    {
+        if (!panning || event->button() != Qt::LeftButton) return false;
+        panning = false;
+        return true;
+    }
+
+    bool doubleClick(QMouseEvent *event)
+    {
+        if (!canvasRect.contains(event->position().toPoint())) return false;
+        reset();
+        return true;
+    }
+
+    bool isPanning() const { return panning; }
+
+    // Preorder over the visible part of the tree: drawNode(node, visual) for
+    // nodes drawn one by one, drawSummary(node, visual) for the root of each
+    // subtree drawn as a summary. Parents come before their children.
+    template <typename Node, typename DrawNode, typename DrawSummary>
+    void walk(Node *root, Node *nil, const NodeVisualTable &visuals, int nodeRadius,
+              DrawNode drawNode, DrawSummary drawSummary) const
+    {
+        if (root == nil) return;
+        const QRectF visible = visibleArea();
+        std::vector<Node*> stack{root};
+        while (!stack.empty()) {
+            Node *node = stack.back();
+            stack.pop_back();
+            const NodeVisual visual = visuals.at(node->value);
+            const QRectF extent(visual.subtreeLeft - nodeRadius, visual.y - nodeRadius,
+                                visual.subtreeRight - visual.subtreeLeft + 2 * nodeRadius,
+                                visual.subtreeBottom - visual.y + 2 * nodeRadius);
+            if (!extent.intersects(visible)) continue;
+            if (visual.subtreeNodes > 1 && extent.width() * scale < COLLAPSE_PIXELS) {
+                drawSummary(node, visual);
+                continue;
+            }
+            drawNode(node, visual);
+            if (node->right != nil) stack.push_back(node->right);
+            if (node->left != nil) stack.push_back(node->left);
+        }
+    }
+
+    // A collapsed subtree: a triangle from its root down to its extent,
+    // with its node count when there is room for it
+    void drawSummary(QPainter &painter, const NodeVisual &visual, const QColor &color) const
+    {
+        QPolygonF triangle;
+        triangle << QPointF(visual.x, visual.y)
+                 << QPointF(visual.subtreeLeft, visual.subtreeBottom)
+                 << QPointF(visual.subtreeRight, visual.subtreeBottom);
+        painter.setPen(QPen(color, 0));  // Cosmetic: one pixel at any zoom
+        QColor fill = color;
+        fill.setAlpha(90);
+        painter.setBrush(fill);
+        painter.drawPolygon(triangle);
+
+        const QRectF onScreen = transform().mapRect(triangle.boundingRect());
+        if (onScreen.width() < 18 || onScreen.height() < 14) return;
+        painter.save();
+        painter.resetTransform();
+        painter.setPen(color.darker(160));
+        painter.setFont(QFont("Segoe UI", 8, QFont::Bold));
+        painter.drawText(onScreen, Qt::AlignHCenter | Qt::AlignBottom, QString::number(visual.subtreeNodes));
+        painter.restore();
+    }
+
+private:
+    QRect canvasRect;
+    double scale = 1.0;
+    QPointF pan;
+    bool panning = false;
+    QPointF lastMouse;
+};
+
+#endif // TREEVIEWPORT_H